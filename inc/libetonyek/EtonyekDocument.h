@@ -64,6 +64,66 @@ public:
     TYPE_PAGES //< Pages
   };
 
+  /** Optional parser features.
+    *
+    * The values can be or-ed together and passed to parse().
+    */
+  enum Option
+  {
+    OPTION_NONE = 0, //< the default behavior
+    OPTION_PARALLEL_FRAGMENTS = 1 << 0, //< uncompress and index all fragments of a binary (Keynote 6, Numbers 3, Pages 5) document in parallel
+    OPTION_STREAMING_TABLES = 1 << 1, //< send the rows of a Numbers 3 table to the spreadsheet interface while they are parsed; the shapes of such a sheet are sent in a separate sheet
+    OPTION_PARALLEL_INFLATE = 1 << 2, //< uncompress a gzipped XML (Keynote 2-5, Numbers 1-2, Pages 1-4) document in a separate thread while it is parsed
+    OPTION_SHARED_TEXT_STYLES = 1 << 3, //< define each distinct paragraph and character style once (with librevenge:paragraph-id or librevenge:span-id) and open paragraphs and spans with just the ID
+    OPTION_PARALLEL_SLIDES = 1 << 4, //< parse the slides of a Keynote 6 document in parallel; they are still sent in their order
+    OPTION_PARALLEL_TABLES = 1 << 5, //< read the cells of the tiles (blocks of rows) of a table of a binary (Keynote 6, Numbers 3, Pages 5) document in parallel; they are still inserted in their order
+    OPTION_MEDIA_REFERENCES = 1 << 6 //< do not read the images and movies of a document; refer to them by their path in the package (xlink:href) instead of sending their content (office:binary-data or draw:fill-image)
+  };
+
+  /** A document that has already been detected.
+    *
+    * It keeps everything found during detection (the uncompressed main
+    * file, the package, the object index of a binary document), so
+    * parsing it through the handle does not have to do that work again.
+    *
+    * A handle is created by open() and must be deleted by the caller.
+    * The input stream passed to open() must outlive the handle.
+    *
+    * A handle can be parsed only once, because parsing consumes the
+    * kept streams and object index. It must not be used by several
+    * threads at once.
+    */
+  class Handle
+  {
+    // disable copying
+    Handle(const Handle &);
+    Handle &operator=(const Handle &);
+
+  public:
+    ETONYEKAPI ~Handle();
+
+    /** Get the likelihood that the document is supported.
+      *
+      * @returns the same value as isSupported() for the input stream
+      */
+    ETONYEKAPI Confidence getConfidence() const;
+
+    /** Get the type of the document.
+      *
+      * @returns the same type as isSupported() for the input stream
+      */
+    ETONYEKAPI Type getType() const;
+
+  private:
+    struct Impl;
+
+    explicit Handle(Impl *impl);
+
+    Impl *const m_impl;
+
+    friend class EtonyekDocument;
+  };
+
 public:
   /** Detect if the stream contains a valid iWorks document.
     *
@@ -85,6 +145,18 @@ public:
     */
   static ETONYEKAPI Confidence isSupported(librevenge::RVNGInputStream *input, Type *Type = nullptr);
 
+  /** Detect the document in the stream and keep the result for parsing.
+    *
+    * This is like isSupported(), but the returned handle can be passed
+    * to parse() instead of the stream, which avoids detecting the
+    * document again.
+    *
+    * @arg[in] input the stream
+    * @returns a new handle, or @c nullptr if the stream does not
+    *  contain a supported document
+    */
+  static ETONYEKAPI Handle *open(librevenge::RVNGInputStream *input);
+
   /** Parse the input stream content.
    *
    * It will make callbacks to the functions provided by a
@@ -97,6 +169,15 @@ public:
    */
   static ETONYEKAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGPresentationInterface *generator);
 
+  /** Parse the input stream content, using optional features.
+   *
+   * @arg[in] input the input stream
+   * @arg[in] generator a librevenge::RVNGPresentationInterface implementation
+   * @arg[in] options a combination of Option values
+   * @returns a value that indicates whether the parsing was successful
+   */
+  static ETONYEKAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGPresentationInterface *generator, unsigned options);
+
   /** Parse the input stream content.
    *
    * It will make callbacks to the functions provided by a
@@ -109,6 +190,15 @@ public:
    */
   static ETONYEKAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGSpreadsheetInterface *document);
 
+  /** Parse the input stream content, using optional features.
+   *
+   * @arg[in] input the input stream
+   * @arg[in] generator a librevenge::RVNGSpreadsheetInterface implementation
+   * @arg[in] options a combination of Option values
+   * @returns a value that indicates whether the parsing was successful
+   */
+  static ETONYEKAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGSpreadsheetInterface *document, unsigned options);
+
   /** Parse the input stream content.
    *
    * It will make callbacks to the functions provided by a
@@ -120,6 +210,48 @@ public:
    * @returns a value that indicates whether the parsing was successful
    */
   static ETONYEKAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGTextInterface *document);
+
+  /** Parse the input stream content, using optional features.
+   *
+   * @arg[in] input the input stream
+   * @arg[in] generator a librevenge::RVNGTextInterface implementation
+   * @arg[in] options a combination of Option values
+   * @returns a value that indicates whether the parsing was successful
+   */
+  static ETONYEKAPI bool parse(librevenge::RVNGInputStream *input, librevenge::RVNGTextInterface *document, unsigned options);
+
+  /** Parse an opened Keynote document.
+   *
+   * The handle is used up: parsing it again fails.
+   *
+   * @arg[in] handle the document, as returned by open()
+   * @arg[in] generator a librevenge::RVNGPresentationInterface implementation
+   * @arg[in] options a combination of Option values
+   * @returns a value that indicates whether the parsing was successful
+   */
+  static ETONYEKAPI bool parse(Handle *handle, librevenge::RVNGPresentationInterface *generator, unsigned options = OPTION_NONE);
+
+  /** Parse an opened Numbers document.
+   *
+   * The handle is used up: parsing it again fails.
+   *
+   * @arg[in] handle the document, as returned by open()
+   * @arg[in] generator a librevenge::RVNGSpreadsheetInterface implementation
+   * @arg[in] options a combination of Option values
+   * @returns a value that indicates whether the parsing was successful
+   */
+  static ETONYEKAPI bool parse(Handle *handle, librevenge::RVNGSpreadsheetInterface *document, unsigned options = OPTION_NONE);
+
+  /** Parse an opened Pages document.
+   *
+   * The handle is used up: parsing it again fails.
+   *
+   * @arg[in] handle the document, as returned by open()
+   * @arg[in] generator a librevenge::RVNGTextInterface implementation
+   * @arg[in] options a combination of Option values
+   * @returns a value that indicates whether the parsing was successful
+   */
+  static ETONYEKAPI bool parse(Handle *handle, librevenge::RVNGTextInterface *document, unsigned options = OPTION_NONE);
 };
 
 } // namespace libetonyek
@@ -0,0 +1,479 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+
+#include <librevenge-generators/librevenge-generators.h>
+#include <librevenge-stream/librevenge-stream.h>
+#include <librevenge/librevenge.h>
+#include <libetonyek/libetonyek.h>
+
+#include "IWORKProfiler.h"
+
+#ifndef VERSION
+#define VERSION "UNKNOWN VERSION"
+#endif
+
+#define TOOL "etonyek-bench"
+
+using libetonyek::EtonyekDocument;
+using libetonyek::IWORKProfiler;
+
+namespace
+{
+
+std::atomic<uint64_t> allocationCounts[IWORKProfiler::PHASE_COUNT];
+std::atomic<uint64_t> allocatedBytes[IWORKProfiler::PHASE_COUNT];
+
+void *allocate(const std::size_t size)
+{
+  const IWORKProfiler::Phase phase = IWORKProfiler::getCurrentPhase();
+  allocationCounts[phase].fetch_add(1, std::memory_order_relaxed);
+  allocatedBytes[phase].fetch_add(size, std::memory_order_relaxed);
+  return std::malloc(size ? size : 1);
+}
+
+}
+
+// count all allocations, by phase
+
+void *operator new(const std::size_t size)
+{
+  void *const ptr = allocate(size);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new[](const std::size_t size)
+{
+  void *const ptr = allocate(size);
+  if (!ptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void *operator new(const std::size_t size, const std::nothrow_t &) noexcept
+{
+  return allocate(size);
+}
+
+void *operator new[](const std::size_t size, const std::nothrow_t &) noexcept
+{
+  return allocate(size);
+}
+
+void operator delete(void *const ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void *const ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete(void *const ptr, const std::nothrow_t &) noexcept
+{
+  std::free(ptr);
+}
+
+void operator delete[](void *const ptr, const std::nothrow_t &) noexcept
+{
+  std::free(ptr);
+}
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock_t;
+
+struct PhaseResult
+{
+  PhaseResult();
+
+  double m_time;
+  uint64_t m_allocations;
+  uint64_t m_allocatedBytes;
+};
+
+PhaseResult::PhaseResult()
+  : m_time(0)
+  , m_allocations(0)
+  , m_allocatedBytes(0)
+{
+}
+
+struct FileResult
+{
+  explicit FileResult(const std::string &path);
+
+  std::string m_path;
+  EtonyekDocument::Type m_type;
+  bool m_supported;
+  bool m_parsed;
+  double m_wallTime;
+  long m_peakRSS; // in kB, or -1 if unknown
+  PhaseResult m_phases[IWORKProfiler::PHASE_COUNT];
+};
+
+FileResult::FileResult(const std::string &path)
+  : m_path(path)
+  , m_type(EtonyekDocument::TYPE_UNKNOWN)
+  , m_supported(false)
+  , m_parsed(false)
+  , m_wallTime(0)
+  , m_peakRSS(-1)
+  , m_phases()
+{
+}
+
+int printUsage()
+{
+  printf("`" TOOL "' measures the import of Apple Keynote, Numbers and Pages documents.\n");
+  printf("\n");
+  printf("Usage: " TOOL " [OPTION] PATH...\n");
+  printf("\n");
+  printf("Each PATH is a document or a directory, which is searched recursively.\n");
+  printf("The documents are parsed into a generator that discards everything.\n");
+  printf("\n");
+  printf("Options:\n");
+  printf("\t--json                print the results as JSON\n");
+  printf("\t--parallel            uncompress and index fragments, parse Keynote 6 slides and read table tiles in parallel, inflate gzipped XML in a separate thread\n");
+  printf("\t--streaming           stream the rows of Numbers tables\n");
+  printf("\t--shared-styles       define each distinct paragraph and character style once\n");
+  printf("\t--media-references    refer to images and movies by their path instead of reading them\n");
+  printf("\t--help                show this help message\n");
+  printf("\t--version             show version information\n");
+  printf("\n");
+  printf("Report bugs to <https://bugs.documentfoundation.org/>.\n");
+  return -1;
+}
+
+int printVersion()
+{
+  printf(TOOL " " VERSION "\n");
+  return 0;
+}
+
+bool isDirectory(const std::string &path)
+{
+  struct stat info;
+  return (0 == stat(path.c_str(), &info)) && S_ISDIR(info.st_mode);
+}
+
+bool isPackage(const std::string &path)
+{
+  for (const char *const ext : { ".key", ".numbers", ".pages" })
+  {
+    const std::size_t len = std::strlen(ext);
+    if ((path.size() > len) && (0 == path.compare(path.size() - len, len, ext)))
+      return true;
+  }
+  return false;
+}
+
+void findDocuments(const std::string &path, std::vector<std::string> &documents)
+{
+  if (!isDirectory(path) || isPackage(path))
+  {
+    documents.push_back(path);
+    return;
+  }
+
+  DIR *const dir = opendir(path.c_str());
+  if (!dir)
+    return;
+  std::vector<std::string> entries;
+  while (const dirent *const entry = readdir(dir))
+  {
+    if ((0 != std::strcmp(entry->d_name, ".")) && (0 != std::strcmp(entry->d_name, "..")))
+      entries.push_back(path + "/" + entry->d_name);
+  }
+  closedir(dir);
+
+  std::sort(entries.begin(), entries.end());
+  for (const auto &entry : entries)
+    findDocuments(entry, documents);
+}
+
+void resetPeakRSS()
+{
+  // supported by Linux since 4.0; ignored elsewhere
+  std::ofstream clearRefs("/proc/self/clear_refs");
+  if (clearRefs)
+    clearRefs << "5";
+}
+
+long getPeakRSS()
+{
+  std::ifstream status("/proc/self/status");
+  std::string line;
+  while (std::getline(status, line))
+  {
+    if (0 == line.compare(0, 6, "VmHWM:"))
+      return std::atol(line.c_str() + 6);
+  }
+
+  // the peak of the whole process
+  struct rusage usage;
+  if (0 == getrusage(RUSAGE_SELF, &usage))
+    return usage.ru_maxrss;
+  return -1;
+}
+
+void resetCounters()
+{
+  IWORKProfiler::reset();
+  for (unsigned i = 0; i != IWORKProfiler::PHASE_COUNT; ++i)
+  {
+    allocationCounts[i].store(0);
+    allocatedBytes[i].store(0);
+  }
+}
+
+bool parse(EtonyekDocument::Handle *const document, const unsigned options)
+{
+  switch (document->getType())
+  {
+  case EtonyekDocument::TYPE_KEYNOTE :
+  {
+    librevenge::RVNGDummyPresentationGenerator generator;
+    return EtonyekDocument::parse(document, &generator, options);
+  }
+  case EtonyekDocument::TYPE_NUMBERS :
+  {
+    librevenge::RVNGDummySpreadsheetGenerator generator;
+    return EtonyekDocument::parse(document, &generator, options);
+  }
+  case EtonyekDocument::TYPE_PAGES :
+  {
+    librevenge::RVNGDummyTextGenerator generator;
+    return EtonyekDocument::parse(document, &generator, options);
+  }
+  case EtonyekDocument::TYPE_UNKNOWN :
+  default :
+    break;
+  }
+  return false;
+}
+
+FileResult measure(const std::string &path, const unsigned options)
+{
+  FileResult result(path);
+
+  resetPeakRSS();
+  resetCounters();
+  const Clock_t::time_point start = Clock_t::now();
+
+  std::shared_ptr<librevenge::RVNGInputStream> input;
+  if (librevenge::RVNGDirectoryStream::isDirectory(path.c_str()))
+    input.reset(new librevenge::RVNGDirectoryStream(path.c_str()));
+  else
+    input.reset(new librevenge::RVNGFileStream(path.c_str()));
+
+  std::unique_ptr<EtonyekDocument::Handle> document(EtonyekDocument::open(input.get()));
+  if (document)
+  {
+    result.m_type = document->getType();
+    result.m_supported = true;
+    if (EtonyekDocument::CONFIDENCE_SUPPORTED_PART == document->getConfidence())
+    {
+      document.reset();
+      input.reset(librevenge::RVNGDirectoryStream::createForParent(path.c_str()));
+      document.reset(EtonyekDocument::open(input.get()));
+    }
+    if (document)
+      result.m_parsed = parse(document.get(), options);
+  }
+  document.reset();
+  input.reset();
+
+  result.m_wallTime = std::chrono::duration<double>(Clock_t::now() - start).count();
+  result.m_peakRSS = getPeakRSS();
+  for (unsigned i = 0; i != IWORKProfiler::PHASE_COUNT; ++i)
+  {
+    const auto phase = IWORKProfiler::Phase(i);
+    result.m_phases[i].m_time = IWORKProfiler::getTime(phase);
+    result.m_phases[i].m_allocations = allocationCounts[i].load();
+    result.m_phases[i].m_allocatedBytes = allocatedBytes[i].load();
+  }
+  return result;
+}
+
+const char *getTypeName(const EtonyekDocument::Type type)
+{
+  switch (type)
+  {
+  case EtonyekDocument::TYPE_KEYNOTE :
+    return "keynote";
+  case EtonyekDocument::TYPE_NUMBERS :
+    return "numbers";
+  case EtonyekDocument::TYPE_PAGES :
+    return "pages";
+  case EtonyekDocument::TYPE_UNKNOWN :
+  default :
+    break;
+  }
+  return "unknown";
+}
+
+const char *getPhaseName(const unsigned phase)
+{
+  // the time before and after the library calls goes to "other"
+  if (phase == IWORKProfiler::PHASE_NONE)
+    return "other";
+  return IWORKProfiler::getName(IWORKProfiler::Phase(phase));
+}
+
+std::string escapeJSON(const std::string &str)
+{
+  std::string escaped;
+  for (const char c : str)
+  {
+    switch (c)
+    {
+    case '"' :
+      escaped += "\\\"";
+      break;
+    case '\\' :
+      escaped += "\\\\";
+      break;
+    default :
+      if (static_cast<unsigned char>(c) < 0x20)
+      {
+        char buf[8];
+        std::snprintf(buf, sizeof(buf), "\\u%04x", unsigned(c));
+        escaped += buf;
+      }
+      else
+        escaped += c;
+    }
+  }
+  return escaped;
+}
+
+void printJSON(const std::vector<FileResult> &results)
+{
+  printf("{\n  \"files\": [");
+  for (std::size_t i = 0; i != results.size(); ++i)
+  {
+    const FileResult &result = results[i];
+    printf("%s\n    {\n", i ? "," : "");
+    printf("      \"path\": \"%s\",\n", escapeJSON(result.m_path).c_str());
+    printf("      \"type\": \"%s\",\n", getTypeName(result.m_type));
+    printf("      \"supported\": %s,\n", result.m_supported ? "true" : "false");
+    printf("      \"parsed\": %s,\n", result.m_parsed ? "true" : "false");
+    printf("      \"wall_time\": %.6f,\n", result.m_wallTime);
+    printf("      \"peak_rss_kb\": %ld,\n", result.m_peakRSS);
+    printf("      \"phases\": {");
+    for (unsigned phase = 0; phase != IWORKProfiler::PHASE_COUNT; ++phase)
+    {
+      const PhaseResult &phaseResult = result.m_phases[phase];
+      printf("%s\n        \"%s\": { \"time\": %.6f, \"allocations\": %llu, \"allocated_bytes\": %llu }",
+             phase ? "," : "", getPhaseName(phase), phaseResult.m_time,
+             static_cast<unsigned long long>(phaseResult.m_allocations),
+             static_cast<unsigned long long>(phaseResult.m_allocatedBytes));
+    }
+    printf("\n      }\n    }");
+  }
+  printf("\n  ]\n}\n");
+}
+
+void printText(const std::vector<FileResult> &results)
+{
+  for (const auto &result : results)
+  {
+    printf("%s: %s, %s\n", result.m_path.c_str(), getTypeName(result.m_type),
+           !result.m_supported ? "unsupported" : result.m_parsed ? "parsed" : "failed");
+    printf("\twall time: %.3f s, peak RSS: %ld kB\n", result.m_wallTime, result.m_peakRSS);
+    for (unsigned phase = 0; phase != IWORKProfiler::PHASE_COUNT; ++phase)
+    {
+      const PhaseResult &phaseResult = result.m_phases[phase];
+      printf("\t%-14s %9.3f s %12llu allocations %14llu bytes\n", getPhaseName(phase), phaseResult.m_time,
+             static_cast<unsigned long long>(phaseResult.m_allocations),
+             static_cast<unsigned long long>(phaseResult.m_allocatedBytes));
+    }
+  }
+}
+
+} // anonymous namespace
+
+int main(int argc, char *argv[]) try
+{
+  if (argc < 2)
+    return printUsage();
+
+  bool json = false;
+  unsigned options = EtonyekDocument::OPTION_NONE;
+  std::vector<std::string> documents;
+
+  for (int i = 1; i < argc; i++)
+  {
+    if (!strcmp(argv[i], "--json"))
+      json = true;
+    else if (!strcmp(argv[i], "--parallel"))
+      options |= EtonyekDocument::OPTION_PARALLEL_FRAGMENTS | EtonyekDocument::OPTION_PARALLEL_INFLATE
+                 | EtonyekDocument::OPTION_PARALLEL_SLIDES | EtonyekDocument::OPTION_PARALLEL_TABLES;
+    else if (!strcmp(argv[i], "--streaming"))
+      options |= EtonyekDocument::OPTION_STREAMING_TABLES;
+    else if (!strcmp(argv[i], "--shared-styles"))
+      options |= EtonyekDocument::OPTION_SHARED_TEXT_STYLES;
+    else if (!strcmp(argv[i], "--media-references"))
+      options |= EtonyekDocument::OPTION_MEDIA_REFERENCES;
+    else if (!strcmp(argv[i], "--version"))
+      return printVersion();
+    else if (strncmp(argv[i], "--", 2))
+      findDocuments(argv[i], documents);
+    else
+      return printUsage();
+  }
+
+  if (documents.empty())
+    return printUsage();
+
+  IWORKProfiler::enable(true);
+
+  std::vector<FileResult> results;
+  for (const auto &document : documents)
+    results.push_back(measure(document, options));
+
+  if (json)
+    printJSON(results);
+  else
+    printText(results);
+
+  return 0;
+}
+catch (...)
+{
+  fprintf(stderr, "ERROR: uncaught exception!\n");
+  return 1;
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
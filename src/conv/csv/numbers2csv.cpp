@@ -82,20 +82,23 @@ int main(int argc, char *argv[]) try
   else
     input.reset(new librevenge::RVNGFileStream(file));
 
-  EtonyekDocument::Type type = EtonyekDocument::TYPE_UNKNOWN;
-  const EtonyekDocument::Confidence confidence = EtonyekDocument::isSupported(input.get(), &type);
-  if ((EtonyekDocument::CONFIDENCE_NONE == confidence) || (EtonyekDocument::TYPE_NUMBERS != type))
+  std::unique_ptr<EtonyekDocument::Handle> document(EtonyekDocument::open(input.get()));
+  if (!document || (EtonyekDocument::TYPE_NUMBERS != document->getType()))
   {
     std::cerr << "ERROR: Unsupported file format!" << std::endl;
     return 1;
   }
 
-  if (EtonyekDocument::CONFIDENCE_SUPPORTED_PART == confidence)
+  if (EtonyekDocument::CONFIDENCE_SUPPORTED_PART == document->getConfidence())
+  {
+    document.reset();
     input.reset(librevenge::RVNGDirectoryStream::createForParent(file));
+    document.reset(EtonyekDocument::open(input.get()));
+  }
 
   librevenge::RVNGStringVector output;
   librevenge::RVNGCSVSpreadsheetGenerator generator(output);
-  if (!EtonyekDocument::parse(input.get(), &generator))
+  if (!EtonyekDocument::parse(document.get(), &generator))
   {
     std::cerr << "ERROR: CSV Generation failed!" << std::endl;
     return 1;
@@ -82,21 +82,24 @@ int main(int argc, char *argv[])
   else
     input.reset(new librevenge::RVNGFileStream(file));
 
-  EtonyekDocument::Type type = EtonyekDocument::TYPE_UNKNOWN;
-  const EtonyekDocument::Confidence confidence = EtonyekDocument::isSupported(input.get(), &type);
-  if ((EtonyekDocument::CONFIDENCE_NONE == confidence) || (EtonyekDocument::TYPE_PAGES != type))
+  std::unique_ptr<EtonyekDocument::Handle> document(EtonyekDocument::open(input.get()));
+  if (!document || (EtonyekDocument::TYPE_PAGES != document->getType()))
   {
     fprintf(stderr, "ERROR: Unsupported file format!\n");
     return 1;
   }
 
-  if (EtonyekDocument::CONFIDENCE_SUPPORTED_PART == confidence)
+  if (EtonyekDocument::CONFIDENCE_SUPPORTED_PART == document->getConfidence())
+  {
+    document.reset();
     input.reset(librevenge::RVNGDirectoryStream::createForParent(file));
+    document.reset(EtonyekDocument::open(input.get()));
+  }
 
   librevenge::RVNGString output;
   librevenge::RVNGHTMLTextGenerator documentGenerator(output);
 
-  if (!EtonyekDocument::parse(input.get(), &documentGenerator))
+  if (!EtonyekDocument::parse(document.get(), &documentGenerator))
   {
     fprintf(stderr, "ERROR: Parsing failed!\n");
     return 1;
@@ -87,19 +87,22 @@ int main(int argc, char *argv[]) try
   else
     input.reset(new librevenge::RVNGFileStream(file));
 
-  EtonyekDocument::Type type = EtonyekDocument::TYPE_UNKNOWN;
-  const EtonyekDocument::Confidence confidence = EtonyekDocument::isSupported(input.get(), &type);
-  if ((EtonyekDocument::CONFIDENCE_NONE == confidence) || (EtonyekDocument::TYPE_NUMBERS != type))
+  std::unique_ptr<EtonyekDocument::Handle> document(EtonyekDocument::open(input.get()));
+  if (!document || (EtonyekDocument::TYPE_NUMBERS != document->getType()))
   {
     fprintf(stderr, "ERROR: Unsupported file format!\n");
     return 1;
   }
 
-  if (EtonyekDocument::CONFIDENCE_SUPPORTED_PART == confidence)
+  if (EtonyekDocument::CONFIDENCE_SUPPORTED_PART == document->getConfidence())
+  {
+    document.reset();
     input.reset(librevenge::RVNGDirectoryStream::createForParent(file));
+    document.reset(EtonyekDocument::open(input.get()));
+  }
 
   librevenge::RVNGRawSpreadsheetGenerator painter(printCallgraph);
-  if (!EtonyekDocument::parse(input.get(), &painter))
+  if (!EtonyekDocument::parse(document.get(), &painter))
   {
     fprintf(stderr, "ERROR: Parsing failed!\n");
     return 1;
@@ -21,8 +21,12 @@
 #include "libetonyek_utils.h"
 #include "libetonyek_xml.h"
 #include "IWAMessage.h"
+#include "IWAObjectIndex.h"
 #include "IWASnappyStream.h"
+#include "IWORKMediaCache.h"
+#include "IWORKPipeStream.h"
 #include "IWORKPresentationRedirector.h"
+#include "IWORKProfiler.h"
 #include "IWORKSpreadsheetRedirector.h"
 #include "IWORKSubDirStream.h"
 #include "IWORKTextRedirector.h"
@@ -69,23 +73,27 @@ enum Format
 
 struct DetectionInfo
 {
-  explicit DetectionInfo(EtonyekDocument::Type type = EtonyekDocument::TYPE_UNKNOWN);
+  explicit DetectionInfo(EtonyekDocument::Type type = EtonyekDocument::TYPE_UNKNOWN, bool forParsing = false);
 
   RVNGInputStreamPtr_t m_input;
   RVNGInputStreamPtr_t m_package;
   RVNGInputStreamPtr_t m_fragments;
+  std::shared_ptr<IWAObjectIndex> m_objectIndex; //< the object index, if detection has needed it
   EtonyekDocument::Confidence m_confidence;
   EtonyekDocument::Type m_type;
   Format m_format;
+  bool m_forParsing; //< the document will be parsed, so work that parsing needs can be done now
 };
 
-DetectionInfo::DetectionInfo(const EtonyekDocument::Type type)
+DetectionInfo::DetectionInfo(const EtonyekDocument::Type type, const bool forParsing)
   : m_input()
   , m_package()
   , m_fragments()
+  , m_objectIndex()
   , m_confidence(EtonyekDocument::CONFIDENCE_NONE)
   , m_type(type)
   , m_format(FORMAT_UNKNOWN)
+  , m_forParsing(forParsing)
 {
 }
 
@@ -201,9 +209,18 @@ bool probeBinary(DetectionInfo &info)
           if (detected != EtonyekDocument::TYPE_UNKNOWN)
             break;
           // undecise, try to find the first ref
-          IWAObjectIndex objIndex(info.m_fragments, info.m_package);
-          objIndex.parse();
-          auto type = objIndex.getObjectType(potentialRef[0]);
+          boost::optional<unsigned> type;
+          if (info.m_forParsing)
+          {
+            // the index is kept for the parser
+            info.m_objectIndex = std::make_shared<IWAObjectIndex>(info.m_fragments, info.m_package);
+            info.m_objectIndex->parse();
+            type = info.m_objectIndex->getObjectType(potentialRef[0]);
+          }
+          else
+          {
+            type = IWAObjectIndex::probeObjectType(info.m_fragments, potentialRef[0]);
+          }
           detected = type && get(type)==2 ?
                      EtonyekDocument::TYPE_NUMBERS : EtonyekDocument::TYPE_KEYNOTE;
         }
@@ -236,8 +253,8 @@ RVNGInputStreamPtr_t getUncompressedSubStream(const RVNGInputStreamPtr_t &input,
   if (bool(compressed))
   {
     if (snappy)
-      return RVNGInputStreamPtr_t(new IWASnappyStream(compressed));
-    return RVNGInputStreamPtr_t(new IWORKZlibStream(compressed));
+      return RVNGInputStreamPtr_t(new IWASnappyStream(compressed, IWASnappyStream::MODE_ON_DEMAND));
+    return RVNGInputStreamPtr_t(new IWORKZlibStream(compressed, IWORKZlibStream::MODE_STREAMING));
   }
   return RVNGInputStreamPtr_t();
 }
@@ -266,6 +283,7 @@ bool detectBinary(RVNGInputStreamPtr_t input, DetectionInfo &info)
   {
     info.m_format = FORMAT_BINARY;
     info.m_fragments = input;
+    // only the beginning is needed for probing
     info.m_input = getUncompressedSubStream(input, "Index/Document.iwa", true);
   }
 
@@ -314,6 +332,8 @@ RVNGInputStreamPtr_t queryTopDirStream(const RVNGInputStreamPtr_t &input)
 
 bool detect(const RVNGInputStreamPtr_t &input, DetectionInfo &info)
 {
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_DETECTION);
+
   if (input->isStructured())
   {
     if ((info.m_format == FORMAT_BINARY) || (info.m_format == FORMAT_UNKNOWN))
@@ -383,7 +403,7 @@ bool detect(const RVNGInputStreamPtr_t &input, DetectionInfo &info)
   {
     try
     {
-      info.m_input = std::make_shared<IWORKZlibStream>(input);
+      info.m_input = std::make_shared<IWORKZlibStream>(input, IWORKZlibStream::MODE_STREAMING);
     }
     catch (...)
     {
@@ -419,6 +439,148 @@ bool detect(const RVNGInputStreamPtr_t &input, DetectionInfo &info)
   return info.m_confidence != EtonyekDocument::CONFIDENCE_NONE;
 }
 
+/** Get the stream to parse an XML document from.
+  *
+  * If requested, a gzipped document is uncompressed in a separate
+  * thread while the parser consumes it.
+  */
+RVNGInputStreamPtr_t getXMLInput(const DetectionInfo &info, const unsigned options)
+{
+#ifdef WITH_THREADS
+  if ((options & EtonyekDocument::OPTION_PARALLEL_INFLATE) && dynamic_cast<IWORKZlibStream *>(info.m_input.get()))
+    return std::make_shared<IWORKPipeStream>(info.m_input);
+#else
+  (void) options;
+#endif
+  return info.m_input;
+}
+
+bool parseKeynote(const DetectionInfo &info, librevenge::RVNGPresentationInterface *const generator, const unsigned options)
+{
+  info.m_input->seek(0, librevenge::RVNG_SEEK_SET);
+
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_PARSE);
+  IWORKPresentationRedirector redirector(generator);
+  redirector.setShareStyles(options & EtonyekDocument::OPTION_SHARED_TEXT_STYLES);
+  KEYCollector collector(&redirector);
+  collector.getMediaCache()->setReferences(options & EtonyekDocument::OPTION_MEDIA_REFERENCES);
+  if (info.m_format == FORMAT_XML1)
+  {
+    KEY1Dictionary dict;
+    shared_ptr<KEY1Parser> key1Parser(new KEY1Parser(getXMLInput(info, options), info.m_package, collector, dict));
+    return key1Parser->parse();
+  }
+  else if (info.m_format == FORMAT_XML2)
+  {
+    KEY2Dictionary dict;
+    shared_ptr<KEY2Parser> key2Parser(new KEY2Parser(getXMLInput(info, options), info.m_package, collector, dict));
+    return key2Parser->parse();
+  }
+  else if (info.m_format == FORMAT_BINARY)
+  {
+    KEY6Parser parser(info.m_fragments, info.m_package, collector);
+    parser.setOptions(options);
+    if (info.m_objectIndex)
+      parser.setObjectIndex(info.m_objectIndex);
+    return parser.parse();
+  }
+
+  ETONYEK_DEBUG_MSG(("parseKeynote: unhandled format %d\n", info.m_format));
+  return false;
+}
+
+bool parseNumbers(const DetectionInfo &info, librevenge::RVNGSpreadsheetInterface *const document, const unsigned options)
+{
+  info.m_input->seek(0, librevenge::RVNG_SEEK_SET);
+
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_PARSE);
+  IWORKSpreadsheetRedirector redirector(document);
+  redirector.setShareStyles(options & EtonyekDocument::OPTION_SHARED_TEXT_STYLES);
+  NUMCollector collector(&redirector);
+  collector.getMediaCache()->setReferences(options & EtonyekDocument::OPTION_MEDIA_REFERENCES);
+  if (info.m_format == FORMAT_XML2)
+  {
+    NUM1Dictionary dict;
+    NUM1Parser parser(getXMLInput(info, options), info.m_package, collector, &dict);
+    return parser.parse();
+  }
+  else if (info.m_format == FORMAT_BINARY)
+  {
+    NUM3Parser parser(info.m_fragments, info.m_package, collector);
+    parser.setOptions(options);
+    if (info.m_objectIndex)
+      parser.setObjectIndex(info.m_objectIndex);
+    collector.setStreamTables(options & EtonyekDocument::OPTION_STREAMING_TABLES);
+    return parser.parse();
+  }
+
+  ETONYEK_DEBUG_MSG(("parseNumbers: unhandled format %d\n", info.m_format));
+  return false;
+}
+
+bool parsePages(const DetectionInfo &info, librevenge::RVNGTextInterface *const document, const unsigned options)
+{
+  info.m_input->seek(0, librevenge::RVNG_SEEK_SET);
+
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_PARSE);
+  IWORKTextRedirector redirector(document);
+  redirector.setShareStyles(options & EtonyekDocument::OPTION_SHARED_TEXT_STYLES);
+  PAGCollector collector(&redirector);
+  collector.getMediaCache()->setReferences(options & EtonyekDocument::OPTION_MEDIA_REFERENCES);
+  if (info.m_format == FORMAT_XML2)
+  {
+    PAG1Dictionary dict;
+    PAG1Parser parser(getXMLInput(info, options), info.m_package, collector, &dict);
+    return parser.parse();
+  }
+  else if (info.m_format == FORMAT_BINARY)
+  {
+    PAG5Parser parser(info.m_fragments, info.m_package, collector);
+    parser.setOptions(options);
+    if (info.m_objectIndex)
+      parser.setObjectIndex(info.m_objectIndex);
+    return parser.parse();
+  }
+
+  ETONYEK_DEBUG_MSG(("parsePages: unhandled format %d\n", info.m_format));
+  return false;
+}
+
+}
+
+struct EtonyekDocument::Handle::Impl
+{
+  explicit Impl(librevenge::RVNGInputStream *input);
+
+  DetectionInfo m_info;
+  bool m_parsed; //!< the handle has been used up by parse()
+};
+
+EtonyekDocument::Handle::Impl::Impl(librevenge::RVNGInputStream *const input)
+  : m_info(EtonyekDocument::TYPE_UNKNOWN, true)
+  , m_parsed(false)
+{
+  detect(RVNGInputStreamPtr_t(input, EtonyekDummyDeleter()), m_info);
+}
+
+EtonyekDocument::Handle::Handle(Impl *const impl)
+  : m_impl(impl)
+{
+}
+
+ETONYEKAPI EtonyekDocument::Handle::~Handle()
+{
+  delete m_impl;
+}
+
+ETONYEKAPI EtonyekDocument::Confidence EtonyekDocument::Handle::getConfidence() const
+{
+  return m_impl->m_info.m_confidence;
+}
+
+ETONYEKAPI EtonyekDocument::Type EtonyekDocument::Handle::getType() const
+{
+  return m_impl->m_info.m_type;
 }
 
 ETONYEKAPI EtonyekDocument::Confidence EtonyekDocument::isSupported(librevenge::RVNGInputStream *const input, EtonyekDocument::Type *type) try
@@ -445,110 +607,121 @@ catch (...)
   return CONFIDENCE_NONE;
 }
 
-ETONYEKAPI bool EtonyekDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGPresentationInterface *const generator) try
+ETONYEKAPI EtonyekDocument::Handle *EtonyekDocument::open(librevenge::RVNGInputStream *const input) try
+{
+  if (!input)
+    return nullptr;
+
+  std::unique_ptr<Handle::Impl> impl(new Handle::Impl(input));
+  if (impl->m_info.m_confidence == CONFIDENCE_NONE)
+    return nullptr;
+  return new Handle(impl.release());
+}
+catch (...)
+{
+  return nullptr;
+}
+
+ETONYEKAPI bool EtonyekDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGPresentationInterface *const generator)
+{
+  return parse(input, generator, OPTION_NONE);
+}
+
+ETONYEKAPI bool EtonyekDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGPresentationInterface *const generator, const unsigned options) try
 {
   if (!input || !generator)
     return false;
 
-  DetectionInfo info(EtonyekDocument::TYPE_KEYNOTE);
+  DetectionInfo info(EtonyekDocument::TYPE_KEYNOTE, true);
 
   if (!detect(RVNGInputStreamPtr_t(input, EtonyekDummyDeleter()), info))
     return false;
 
-  info.m_input->seek(0, librevenge::RVNG_SEEK_SET);
-
-  IWORKPresentationRedirector redirector(generator);
-  KEYCollector collector(&redirector);
-  if (info.m_format == FORMAT_XML1)
-  {
-    KEY1Dictionary dict;
-    input->seek(0, librevenge::RVNG_SEEK_SET);
-    shared_ptr<KEY1Parser> key1Parser(new KEY1Parser(info.m_input, info.m_package, collector, dict));
-    return key1Parser->parse();
-  }
-  else if (info.m_format == FORMAT_XML2)
-  {
-    KEY2Dictionary dict;
-    shared_ptr<KEY2Parser> key2Parser(new KEY2Parser(info.m_input, info.m_package, collector, dict));
-    return key2Parser->parse();
-  }
-  else if (info.m_format == FORMAT_BINARY)
-  {
-    KEY6Parser parser(info.m_fragments, info.m_package, collector);
-    return parser.parse();
-  }
-
-  ETONYEK_DEBUG_MSG(("EtonyekDocument::parse: unhandled format %d\n", info.m_format));
-  return false;
+  return parseKeynote(info, generator, options);
 }
 catch (...)
 {
   return false;
 }
 
-ETONYEKAPI bool EtonyekDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGSpreadsheetInterface *const document) try
+ETONYEKAPI bool EtonyekDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGSpreadsheetInterface *const document)
+{
+  return parse(input, document, OPTION_NONE);
+}
+
+ETONYEKAPI bool EtonyekDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGSpreadsheetInterface *const document, const unsigned options) try
 {
   if (!input || !document)
     return false;
 
-  DetectionInfo info(EtonyekDocument::TYPE_NUMBERS);
+  DetectionInfo info(EtonyekDocument::TYPE_NUMBERS, true);
 
   if (!detect(RVNGInputStreamPtr_t(input, EtonyekDummyDeleter()), info))
     return false;
 
-  info.m_input->seek(0, librevenge::RVNG_SEEK_SET);
-
-  IWORKSpreadsheetRedirector redirector(document);
-  NUMCollector collector(&redirector);
-  if (info.m_format == FORMAT_XML2)
-  {
-    NUM1Dictionary dict;
-    NUM1Parser parser(info.m_input, info.m_package, collector, &dict);
-    return parser.parse();
-  }
-  else if (info.m_format == FORMAT_BINARY)
-  {
-    NUM3Parser parser(info.m_fragments, info.m_package, collector);
-    return parser.parse();
-  }
-
-  ETONYEK_DEBUG_MSG(("EtonyekDocument::parse: unhandled format %d\n", info.m_format));
-  return false;
+  return parseNumbers(info, document, options);
 }
 catch (...)
 {
   return false;
 }
 
-ETONYEKAPI bool EtonyekDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGTextInterface *const document) try
+ETONYEKAPI bool EtonyekDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGTextInterface *const document)
+{
+  return parse(input, document, OPTION_NONE);
+}
+
+ETONYEKAPI bool EtonyekDocument::parse(librevenge::RVNGInputStream *const input, librevenge::RVNGTextInterface *const document, const unsigned options) try
 {
   if (!input || !document)
     return false;
 
-  DetectionInfo info(EtonyekDocument::TYPE_PAGES);
+  DetectionInfo info(EtonyekDocument::TYPE_PAGES, true);
 
   if (!detect(RVNGInputStreamPtr_t(input, EtonyekDummyDeleter()), info))
     return false;
 
-  info.m_input->seek(0, librevenge::RVNG_SEEK_SET);
+  return parsePages(info, document, options);
+}
+catch (...)
+{
+  return false;
+}
 
-  IWORKTextRedirector redirector(document);
-  PAGCollector collector(&redirector);
-  if (info.m_format == FORMAT_XML2)
-  {
-    PAG1Dictionary dict;
-    PAG1Parser parser(info.m_input, info.m_package, collector, &dict);
-    return parser.parse();
-  }
-  else if (info.m_format == FORMAT_BINARY)
-  {
-    PAG5Parser parser(info.m_fragments, info.m_package, collector);
-    return parser.parse();
-  }
+ETONYEKAPI bool EtonyekDocument::parse(Handle *const handle, librevenge::RVNGPresentationInterface *const generator, const unsigned options) try
+{
+  if (!handle || !generator || (handle->getType() != TYPE_KEYNOTE) || handle->m_impl->m_parsed)
+    return false;
+
+  handle->m_impl->m_parsed = true;
+  return parseKeynote(handle->m_impl->m_info, generator, options);
+}
+catch (...)
+{
+  return false;
+}
 
-  ETONYEK_DEBUG_MSG(("EtonyekDocument::parse: unhandled format %d\n", info.m_format));
+ETONYEKAPI bool EtonyekDocument::parse(Handle *const handle, librevenge::RVNGSpreadsheetInterface *const document, const unsigned options) try
+{
+  if (!handle || !document || (handle->getType() != TYPE_NUMBERS) || handle->m_impl->m_parsed)
+    return false;
+
+  handle->m_impl->m_parsed = true;
+  return parseNumbers(handle->m_impl->m_info, document, options);
+}
+catch (...)
+{
   return false;
 }
+
+ETONYEKAPI bool EtonyekDocument::parse(Handle *const handle, librevenge::RVNGTextInterface *const document, const unsigned options) try
+{
+  if (!handle || !document || (handle->getType() != TYPE_PAGES) || handle->m_impl->m_parsed)
+    return false;
+
+  handle->m_impl->m_parsed = true;
+  return parsePages(handle->m_impl->m_info, document, options);
+}
 catch (...)
 {
   return false;
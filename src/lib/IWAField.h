@@ -10,11 +10,9 @@
 #ifndef IWAFIELD_H_INCLUDED
 #define IWAFIELD_H_INCLUDED
 
-#include <deque>
-#include <memory>
 #include <stdexcept>
 
-#include <boost/container/deque.hpp>
+#include <boost/container/small_vector.hpp>
 #include <boost/optional.hpp>
 
 #include "IWAReader.h"
@@ -61,20 +59,18 @@ public:
   operator bool() const;
   bool operator!() const;
 
-  virtual void parse(const RVNGInputStreamPtr_t &input, unsigned long length, bool allowEmpty) = 0;
+  virtual void parse(IWAReader::Input &input, unsigned long length, bool allowEmpty) = 0;
 };
 
-typedef std::shared_ptr<IWAField> IWAFieldPtr_t;
-
 namespace detail
 {
 
 template<IWAField::Tag TagV, typename ValueT, typename Reader>
 class IWAFieldImpl : public IWAField
 {
-  typedef boost::container::deque<ValueT> container_type;
-
 public:
+  /// Most fields have just one value, which is then stored in place.
+  typedef boost::container::small_vector<ValueT, 1> container_type;
   typedef ValueT value_type;
   typedef ValueT &reference_type;
   typedef const ValueT &const_reference_type;
@@ -149,11 +145,9 @@ public:
 
   // conversions
 
-  // TODO: remove this or replace direct use of std::deque by a typedef
-  const std::deque<value_type> repeated() const
+  const container_type &repeated() const
   {
-    const std::deque<value_type> values(m_values.begin(), m_values.end());
-    return values;
+    return m_values;
   }
 
   const boost::optional<value_type> optional() const
@@ -163,12 +157,12 @@ public:
 
   // initialization
 
-  void parse(const RVNGInputStreamPtr_t &input, const unsigned long length, const bool allowEmpty) override
+  void parse(IWAReader::Input &input, const unsigned long length, const bool allowEmpty) override
   {
     if (length != 0)
     {
-      const long start = input->tell();
-      while (!input->isEnd() && (length > static_cast<unsigned long>(input->tell() - start)))
+      const unsigned char *const start = input.m_pos;
+      while ((input.m_pos != input.m_end) && (length > static_cast<unsigned long>(input.m_pos - start)))
       {
         const value_type value(Reader::read(input, length));
         m_values.push_back(value);
@@ -219,25 +213,8 @@ typedef detail::IWAFieldImpl<IWAField::TAG_BYTES, RVNGInputStreamPtr_t, IWAReade
 typedef detail::IWAFieldImpl<IWAField::TAG_FIXED32, uint32_t, IWAReader::Fixed32> IWAFixed32Field;
 typedef detail::IWAFieldImpl<IWAField::TAG_FLOAT, float, IWAReader::Float> IWAFloatField;
 
-class IWAMessageField : public detail::IWAFieldImpl<IWAField::TAG_MESSAGE, IWAMessage, IWAReader::Message>
-{
-public:
-  const IWAUInt32Field &uint32(std::size_t field) const;
-  const IWAUInt64Field &uint64(std::size_t field) const;
-  const IWASInt32Field &sint32(std::size_t field) const;
-  const IWASInt64Field &sint64(std::size_t field) const;
-  const IWABoolField &bool_(std::size_t field) const;
-
-  const IWAFixed64Field &fixed64(std::size_t field) const;
-  const IWADoubleField &double_(std::size_t field) const;
-
-  const IWAStringField &string(std::size_t field) const;
-  const IWABytesField &bytes(std::size_t field) const;
-  const IWAMessageField &message(std::size_t field) const;
-
-  const IWAFixed32Field &fixed32(std::size_t field) const;
-  const IWAFloatField &float_(std::size_t field) const;
-};
+// defined in IWAMessage.h, as it stores the messages in place
+class IWAMessageField;
 
 }
 
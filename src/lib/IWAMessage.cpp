@@ -9,14 +9,13 @@
 
 #include "IWAMessage.h"
 
+#include <algorithm>
 #include <cassert>
 #include <memory>
 
 namespace libetonyek
 {
 
-using std::make_pair;
-
 namespace
 {
 
@@ -25,92 +24,170 @@ struct ParseError {};
 
 }
 
-IWAMessage::Field::Field(const IWAMessage::WireType wireType)
-  : m_wireType(wireType)
-  , m_pieces()
-  , m_realField()
+IWAMessage::Piece::Piece(const unsigned begin, const unsigned end)
+  : m_begin(begin)
+  , m_end(end)
+  , m_next(0)
+{
+}
+
+IWAMessage::Field::Field(const unsigned number, const IWAMessage::WireType wireType, const unsigned piece)
+  : m_number(number)
+  , m_wireType(wireType)
+  , m_first(piece)
+  , m_last(piece)
+  , m_realField(nullptr)
+{
+}
+
+IWAMessage::Field::Field(const Field &other)
+  : m_number(other.m_number)
+  , m_wireType(other.m_wireType)
+  , m_first(other.m_first)
+  , m_last(other.m_last)
+  , m_realField(nullptr)
+{
+}
+
+IWAMessage::Field::~Field()
 {
+  delete m_realField.load();
+}
+
+IWAMessage::Field &IWAMessage::Field::operator=(const Field &other)
+{
+  if (this != &other)
+  {
+    delete m_realField.exchange(nullptr);
+    m_number = other.m_number;
+    m_wireType = other.m_wireType;
+    m_first = other.m_first;
+    m_last = other.m_last;
+  }
+  return *this;
 }
 
 IWAMessage::IWAMessage()
-  : m_input()
+  : m_buffer()
   , m_fields()
+  , m_pieces()
 {
 }
 
 IWAMessage::IWAMessage(const RVNGInputStreamPtr_t &input, unsigned long length)
-  : m_input(input)
+  : m_buffer()
   , m_fields()
+  , m_pieces()
 {
   if (length == 0)
     return;
 
-  parse(length);
+  read(input, length);
 }
 
 IWAMessage::IWAMessage(const RVNGInputStreamPtr_t &input, const long start, const long end)
-  : m_input(input)
+  : m_buffer()
   , m_fields()
+  , m_pieces()
 {
   assert(end >= start);
 
   if (end==start) return; // rare, but ok
 
   if (input->seek(start, librevenge::RVNG_SEEK_SET) == 0)
-    parse(static_cast<unsigned long>(end - start));
+    read(input, static_cast<unsigned long>(end - start));
+}
+
+IWAMessage::IWAMessage(const IWABufferPtr_t &buffer, const std::size_t begin, const std::size_t end)
+  : m_buffer(buffer)
+  , m_fields()
+  , m_pieces()
+{
+  assert(bool(m_buffer));
+  assert(end >= begin);
+
+  parse(begin, end);
+}
+
+void IWAMessage::read(const RVNGInputStreamPtr_t &input, const unsigned long length)
+{
+  assert(bool(input));
+
+  // Copy the message data once; all nested messages are parsed from
+  // this buffer, without going through the stream again.
+  const std::shared_ptr<std::vector<unsigned char>> buffer = std::make_shared<std::vector<unsigned char>>();
+  buffer->reserve(length);
+  while (buffer->size() < length && !input->isEnd())
+  {
+    unsigned long readBytes = 0;
+    const unsigned char *const bytes = input->read(length - buffer->size(), readBytes);
+    if (!bytes || readBytes == 0)
+      break;
+    buffer->insert(buffer->end(), bytes, bytes + readBytes);
+  }
+  m_buffer = buffer;
+
+  parse(0, m_buffer->size());
 }
 
-void IWAMessage::parse(const unsigned long length) try
+void IWAMessage::parse(const std::size_t begin, const std::size_t end) try
 {
-  assert(bool(m_input));
+  IWAReader::Input input(m_buffer, begin, end);
+  const unsigned char *const data = m_buffer->data();
 
-  const long startPos = m_input->tell();
-  while (!m_input->isEnd() && (length > static_cast<unsigned long>(m_input->tell() - startPos)))
+  while (input.m_pos != input.m_end)
   {
-    const auto spec = unsigned(readUVar(m_input));
+    const auto spec = unsigned(IWAReader::UInt64::read(input, 0));
     const unsigned wireType = spec & 0x7;
 
-    long start = m_input->tell();
+    const unsigned char *start = input.m_pos;
 
     switch (wireType)
     {
     case 0:
-      readUVar(m_input);
+      IWAReader::UInt64::read(input, 0);
       break;
     case 1:
-      readU64(m_input);
+      IWAReader::Fixed64::read(input, 0);
       break;
     case 2:
     {
-      const uint64_t len = readUVar(m_input);
-      start = m_input->tell(); // the field parser expects just the actual data
-      if (m_input->seek((long) len, librevenge::RVNG_SEEK_CUR) != 0)
+      const uint64_t len = IWAReader::UInt64::read(input, 0);
+      start = input.m_pos; // the field parser expects just the actual data
+      if (static_cast<uint64_t>(input.m_end - input.m_pos) < len)
         throw ParseError();
+      input.m_pos += len;
       break;
     }
     case 5:
-      readU32(m_input);
+      IWAReader::Fixed32::read(input, 0);
       break;
     default:
       ETONYEK_DEBUG_MSG(("IWAMessage::IWAMessage: unexpected wire type %d\n", wireType));
       throw ParseError();
     }
 
-    const long end = m_input->tell();
-    if (length >= static_cast<unsigned long>(end - startPos))
+    const unsigned field = spec >> 3;
+    auto it = std::lower_bound(m_fields.begin(), m_fields.end(), field, [](const Field &f, const unsigned number)
     {
-      const unsigned field = spec >> 3;
-      auto it = m_fields.find(field);
-      if ((it != m_fields.end()) && (it->second.m_wireType != WireType(wireType)))
+      return f.m_number < number;
+    });
+    const auto piece = unsigned(m_pieces.size());
+    if ((it != m_fields.end()) && (it->m_number == field))
+    {
+      if (it->m_wireType != WireType(wireType))
       {
-        ETONYEK_DEBUG_MSG(("IWAMessage::IWAMessage: wire type %d of field %d does not match previously seen %d\n", wireType, field, it->second.m_wireType));
+        ETONYEK_DEBUG_MSG(("IWAMessage::IWAMessage: wire type %d of field %d does not match previously seen %d\n", wireType, field, it->m_wireType));
         continue;
       }
-      if (it == m_fields.end())
-        it = m_fields.insert(make_pair(field, Field(WireType(wireType)))).first;
-      assert(it != m_fields.end());
-      it->second.m_pieces.push_back(make_pair(start, end));
+      m_pieces[it->m_last].m_next = piece;
+      it->m_last = piece;
+    }
+    else
+    {
+      m_fields.insert(it, Field(field, WireType(wireType), piece));
     }
+    m_pieces.push_back(Piece(unsigned(start - data), unsigned(input.m_pos - data)));
   }
 }
 catch (...)
@@ -184,37 +261,42 @@ const IWAFloatField &IWAMessage::float_(const std::size_t field) const
 template<typename FieldT>
 const FieldT &IWAMessage::getField(const std::size_t field, const WireType wireType, const IWAField::Tag tag) const
 {
-  const FieldList_t::iterator fieldIt = m_fields.find((unsigned) field);
+  const FieldList_t::const_iterator fieldIt = std::lower_bound(m_fields.begin(), m_fields.end(), unsigned(field), [](const Field &f, const unsigned number)
+  {
+    return f.m_number < number;
+  });
 
-  if (fieldIt == m_fields.end())
+  if ((fieldIt == m_fields.end()) || (fieldIt->m_number != field))
   {
     static FieldT dummy;
     return dummy;
   }
 
-  if (fieldIt->second.m_wireType != wireType)
+  if (fieldIt->m_wireType != wireType)
   {
-    if (fieldIt->second.m_wireType != WIRE_TYPE_LENGTH_DELIMITED)
+    if (fieldIt->m_wireType != WIRE_TYPE_LENGTH_DELIMITED)
       throw AccessError();
   }
 
-  if (bool(fieldIt->second.m_realField))
-  {
-    if (fieldIt->second.m_realField->tag() != tag)
-      throw AccessError();
-  }
-  else
+  IWAField *realField = fieldIt->m_realField.load(std::memory_order_acquire);
+  if (!realField)
   {
-    fieldIt->second.m_realField = std::make_shared<FieldT>();
-    for (std::deque<InputRange_t>::const_iterator it = fieldIt->second.m_pieces.begin(); it != fieldIt->second.m_pieces.end(); ++it)
+    std::unique_ptr<FieldT> newField(new FieldT());
+    for (unsigned piece = fieldIt->m_first;; piece = m_pieces[piece].m_next)
     {
-      assert(bool(m_input));
-      m_input->seek(it->first, librevenge::RVNG_SEEK_SET);
-      fieldIt->second.m_realField->parse(m_input, static_cast<unsigned long>(it->second - m_input->tell()), wireType == WIRE_TYPE_LENGTH_DELIMITED);
+      IWAReader::Input input(m_buffer, m_pieces[piece].m_begin, m_pieces[piece].m_end);
+      newField->parse(input, m_pieces[piece].m_end - m_pieces[piece].m_begin, wireType == WIRE_TYPE_LENGTH_DELIMITED);
+      if (piece == fieldIt->m_last)
+        break;
     }
+    // another thread might have parsed the field in the meantime
+    if (fieldIt->m_realField.compare_exchange_strong(realField, newField.get(), std::memory_order_acq_rel, std::memory_order_acquire))
+      realField = newField.release();
   }
+  if (realField->tag() != tag)
+    throw AccessError();
 
-  return static_cast<FieldT &>(*fieldIt->second.m_realField);
+  return static_cast<const FieldT &>(*realField);
 }
 
 }
@@ -10,8 +10,9 @@
 #ifndef IWAMESSAGE_H_INCLUDED
 #define IWAMESSAGE_H_INCLUDED
 
-#include <map>
-#include <utility>
+#include <atomic>
+#include <cstddef>
+#include <vector>
 
 #include "IWAField.h"
 
@@ -25,6 +26,12 @@ public:
   IWAMessage(const RVNGInputStreamPtr_t &input, unsigned long length);
   IWAMessage(const RVNGInputStreamPtr_t &input, long start, long end);
 
+  /** Create a message from a part of a buffer.
+    *
+    * The buffer is not copied, only referenced.
+    */
+  IWAMessage(const IWABufferPtr_t &buffer, std::size_t begin, std::size_t end);
+
   const IWAUInt32Field &uint32(std::size_t field) const;
   const IWAUInt64Field &uint64(std::size_t field) const;
   const IWASInt32Field &sint32(std::size_t field) const;
@@ -50,28 +57,71 @@ private:
     WIRE_TYPE_32_BIT = 5
   };
 
-  typedef std::pair<long, long> InputRange_t;
+  /// A field value in the buffer; pieces of the same field are chained.
+  struct Piece
+  {
+    Piece(unsigned begin, unsigned end);
+
+    unsigned m_begin;
+    unsigned m_end;
+    unsigned m_next; //!< index of the next piece of the same field, or 0
+  };
 
+  /** A field of the message.
+    *
+    * The field value is parsed on the first access, into a field of
+    * the requested type. The parsed field is published atomically, so
+    * a message can be read from several threads at once. Copies of the
+    * field do not keep the parsed value.
+    */
   struct Field
   {
-    explicit Field(WireType wireType);
+    Field(unsigned number, WireType wireType, unsigned piece);
+    Field(const Field &other);
+    ~Field();
+
+    Field &operator=(const Field &other);
 
+    unsigned m_number;
     WireType m_wireType;
-    std::deque<InputRange_t> m_pieces;
-    IWAFieldPtr_t m_realField;
+    unsigned m_first; //!< index of the first piece
+    unsigned m_last; //!< index of the last piece
+    mutable std::atomic<IWAField *> m_realField; //!< the parsed field
   };
 
-  typedef std::map<unsigned, Field> FieldList_t;
+  typedef std::vector<Field> FieldList_t;
 
 private:
-  void parse(unsigned long length);
+  void read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  void parse(std::size_t begin, std::size_t end);
 
   template<typename FieldT>
   const FieldT &getField(std::size_t field, WireType wireType, IWAField::Tag tag) const;
 
 private:
-  RVNGInputStreamPtr_t m_input;
-  mutable FieldList_t m_fields;
+  IWABufferPtr_t m_buffer;
+  FieldList_t m_fields; //!< sorted by field number
+  std::vector<Piece> m_pieces;
+};
+
+class IWAMessageField : public detail::IWAFieldImpl<IWAField::TAG_MESSAGE, IWAMessage, IWAReader::Message>
+{
+public:
+  const IWAUInt32Field &uint32(std::size_t field) const;
+  const IWAUInt64Field &uint64(std::size_t field) const;
+  const IWASInt32Field &sint32(std::size_t field) const;
+  const IWASInt64Field &sint64(std::size_t field) const;
+  const IWABoolField &bool_(std::size_t field) const;
+
+  const IWAFixed64Field &fixed64(std::size_t field) const;
+  const IWADoubleField &double_(std::size_t field) const;
+
+  const IWAStringField &string(std::size_t field) const;
+  const IWABytesField &bytes(std::size_t field) const;
+  const IWAMessageField &message(std::size_t field) const;
+
+  const IWAFixed32Field &fixed32(std::size_t field) const;
+  const IWAFloatField &float_(std::size_t field) const;
 };
 
 }
@@ -9,10 +9,15 @@
 
 #include "IWAObjectIndex.h"
 
+#include <algorithm>
 #include <cassert>
+#include <unordered_map>
+#include <utility>
 
 #include "IWAMessage.h"
 #include "IWASnappyStream.h"
+#include "IWORKProfiler.h"
+#include "IWORKThreadPool.h"
 #include "IWORKTypes.h"
 
 #include "IWAParser.h"
@@ -23,69 +28,159 @@ namespace libetonyek
 using boost::optional;
 
 using std::deque;
-using std::make_pair;
 using std::make_shared;
 using std::string;
 
-IWAObjectIndex::ObjectRecord::ObjectRecord()
-  : m_stream()
+namespace
+{
+
+/// Compressed size above which fragments are uncompressed on demand.
+const unsigned long onDemandFragmentSize = 1 << 20;
+
+template<typename T>
+bool lessId(const T &left, const T &right)
+{
+  return left.m_id < right.m_id;
+}
+
+template<typename C>
+auto findRecord(C &records, const unsigned id) -> decltype(records.begin())
+{
+  const auto it = std::lower_bound(records.begin(), records.end(), id, [](const typename C::value_type &rec, const unsigned value)
+  {
+    return rec.m_id < value;
+  });
+  return (it != records.end() && it->m_id == id) ? it : records.end();
+}
+
+/// Sort the records by id, keeping only the last added record for each id.
+template<typename T>
+void sortRecords(std::vector<T> &records)
+{
+  std::stable_sort(records.begin(), records.end(), lessId<T>);
+  auto out = records.begin();
+  for (auto it = records.begin(); it != records.end(); ++it)
+  {
+    const auto next = it + 1;
+    if (next == records.end() || next->m_id != it->m_id)
+    {
+      if (out != it)
+        *out = std::move(*it);
+      ++out;
+    }
+  }
+  records.erase(out, records.end());
+}
+
+}
+
+IWAObjectIndex::Fragment::Fragment(const unsigned id, const std::string &path)
+  : m_id(id)
+  , m_path(path)
+  , m_stream()
+  , m_buffer()
+  , m_scanned(false)
+{
+}
+
+IWAObjectIndex::ObjectRecord::ObjectRecord(const unsigned id, const unsigned fragment)
+  : m_id(id)
+  , m_fragment(fragment)
   , m_type(0)
-  , m_headerRange(0, 0)
-  , m_dataRange(0, 0)
+  , m_known(false)
+  , m_dataBegin(0)
+  , m_dataEnd(0)
 {
 }
 
-IWAObjectIndex::ObjectRecord::ObjectRecord(const RVNGInputStreamPtr_t &stream, const unsigned type,
-                                           const long pos, const unsigned long headerLen, const unsigned long dataLen)
-  : m_stream(stream)
+IWAObjectIndex::ObjectRecord::ObjectRecord(const unsigned id, const unsigned fragment, const unsigned type,
+                                           const long dataBegin, const long dataEnd)
+  : m_id(id)
+  , m_fragment(fragment)
   , m_type(type)
-  , m_headerRange(pos, pos + long(headerLen))
-  , m_dataRange(m_headerRange.second, m_headerRange.second + long(dataLen))
+  , m_known(true)
+  , m_dataBegin(dataBegin)
+  , m_dataEnd(dataEnd)
+{
+}
+
+IWAObjectIndex::File::File(const unsigned id, const std::string &path)
+  : m_id(id)
+  , m_path(path)
+  , m_stream()
+{
+}
+
+IWAObjectIndex::FileColor::FileColor(const unsigned id, const IWORKColor &color)
+  : m_id(id)
+  , m_color(color)
 {
 }
 
 IWAObjectIndex::IWAObjectIndex(const RVNGInputStreamPtr_t &fragments, const RVNGInputStreamPtr_t &package)
   : m_fragments(fragments)
   , m_package(package)
-  , m_unparsedFragments()
-  , m_fragmentObjectMap()
-  , m_fileMap()
-  , m_fileColorMap()
+  , m_fragmentList()
+  , m_objectList()
+  , m_fileList()
+  , m_fileColorList()
+  , m_shared(false)
+#ifdef WITH_THREADS
+  , m_mutex()
+#endif
 {
 }
 
 void IWAObjectIndex::parse()
 {
-  m_unparsedFragments[2] = "Index/Metadata.iwa";
-  m_fragmentObjectMap[2] = make_pair(2, ObjectRecord());
-  scanFragment(2);
-  const auto indexIt = m_fragmentObjectMap.find(2);
-  if (indexIt == m_fragmentObjectMap.end() || !indexIt->second.second.m_stream)
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_OBJECT_INDEX);
+  m_fragmentList.assign(1, Fragment(2, "Index/Metadata.iwa"));
+  m_objectList.assign(1, ObjectRecord(2, 0));
+  const ObjectRecord *const indexRec = findObject(2);
+  if (!indexRec)
   {
     // TODO: scan all fragment files
     ETONYEK_DEBUG_MSG(("IWAObjectIndex::parse: object index is broken, nothing will be parsed\n"));
   }
   else
   {
-    const ObjectRecord &rec = indexIt->second.second;
-    const IWAMessage objectIndex(rec.m_stream, rec.m_dataRange.first, rec.m_dataRange.second);
-    const deque<IWAMessage> &fragments = objectIndex.message(3).repeated();
+    const IWAMessage objectIndex(readObject(*indexRec));
+
+    std::unordered_map<unsigned, unsigned> fragmentIndices;
+    fragmentIndices[2] = 0;
+    const auto fragmentIndex = [this, &fragmentIndices](const unsigned id)
+    {
+      const auto it = fragmentIndices.find(id);
+      if (it != fragmentIndices.end())
+        return it->second;
+      const unsigned index = unsigned(m_fragmentList.size());
+      m_fragmentList.push_back(Fragment(id, string()));
+      fragmentIndices[id] = index;
+      return index;
+    };
+
+    ObjectList_t objects;
+    const auto &fragments = objectIndex.message(3).repeated();
     for (const auto &fragment : fragments)
     {
       if (fragment.uint32(1) && (fragment.string(2) || fragment.string(3)))
       {
         const unsigned pathIdx = fragment.string(3) ? 3 : 2;
-        m_unparsedFragments[fragment.uint32(1).get()] = "Index/" + fragment.string(pathIdx).get() + ".iwa";
-        m_fragmentObjectMap[fragment.uint32(1).get()] = make_pair(fragment.uint32(1).get(), ObjectRecord());
+        const unsigned index = fragmentIndex(fragment.uint32(1).get());
+        if (!m_fragmentList[index].m_scanned)
+          m_fragmentList[index].m_path = "Index/" + fragment.string(pathIdx).get() + ".iwa";
+        objects.push_back(ObjectRecord(fragment.uint32(1).get(), index));
       }
-      const deque<IWAMessage> &refs = fragment.message(6).repeated();
+      const auto &refs = fragment.message(6).repeated();
       for (const auto &ref : refs)
       {
         if (ref.uint32(1) && ref.uint32(2))
-          m_fragmentObjectMap[ref.uint32(2).get()] = make_pair(ref.uint32(1).get(), ObjectRecord());
+          objects.push_back(ObjectRecord(ref.uint32(2).get(), fragmentIndex(ref.uint32(1).get())));
       }
     }
-    const deque<IWAMessage> &files = objectIndex.message(4).repeated();
+    addObjects(objects);
+
+    const auto &files = objectIndex.message(4).repeated();
     for (const auto &file : files)
     {
       if (file.uint32(1) && m_package)
@@ -98,9 +193,10 @@ void IWAObjectIndex::parse()
         else if (!virtualPath.empty() && m_package->existsSubStream(virtualPath.c_str()))
           path = virtualPath;
         if (!path.empty())
-          m_fileMap[file.uint32(1).get()] = make_pair(path, RVNGInputStreamPtr_t());
+          m_fileList.push_back(File(file.uint32(1).get(), path));
       }
     }
+    sortRecords(m_fileList);
 
     // search the color id map
     auto replaceId=objectIndex.uint32(1).optional();
@@ -122,75 +218,251 @@ void IWAObjectIndex::parse()
 
 void IWAObjectIndex::queryObject(const unsigned id, unsigned &type, boost::optional<IWAMessage> &msg) const
 {
-  const auto recIt = m_fragmentObjectMap.find(id);
-  if (recIt == m_fragmentObjectMap.end())
-  {
-    ETONYEK_DEBUG_MSG(("IWAObjectIndex::queryObject: object %u not found\n", id));
-    return;
-  }
-  if (!recIt->second.second.m_stream)
-    const_cast<IWAObjectIndex *>(this)->scanFragment(recIt->second.first);
-  if (recIt->second.second.m_stream)
+  const ObjectRecord *const rec = findObject(id);
+  if (rec)
   {
-    const ObjectRecord &objRecord = recIt->second.second;
-    msg = IWAMessage(objRecord.m_stream, objRecord.m_dataRange.first, objRecord.m_dataRange.second);
-    type = objRecord.m_type;
+    msg = readObject(*rec);
+    type = rec->m_type;
   }
 }
 
 boost::optional<unsigned> IWAObjectIndex::getObjectType(const unsigned id) const
 {
-  // improve me
-  boost::optional<IWAMessage> msg;
-  unsigned type=0; // for g++-7
-  queryObject(id, type, msg);
-  if (!msg)
+  const ObjectRecord *const rec = findObject(id);
+  if (!rec)
     return boost::none;
-  return type;
+  return rec->m_type;
 }
 
 const RVNGInputStreamPtr_t IWAObjectIndex::queryFile(const unsigned id) const
 {
-  const auto it = m_fileMap.find(id);
+#ifdef WITH_THREADS
+  // the package can be read by one thread at a time
+  std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+  if (m_shared)
+    lock.lock();
+#endif
+  const auto it = findRecord(m_fileList, id);
 
-  if (it == m_fileMap.end())
+  if (it == m_fileList.end())
   {
     ETONYEK_DEBUG_MSG(("IWAObjectIndex::queryFile: file %u not found\n", id));
     return RVNGInputStreamPtr_t();
   }
 
-  if (!it->second.second && m_package)
+  if (m_shared && m_package)
   {
-    assert(m_package->existsSubStream(it->second.first.c_str())); // we already checked for its presence
-    it->second.second.reset(m_package->getSubStreamByName(it->second.first.c_str()));
+    // another parser could be reading the cached stream
+    assert(m_package->existsSubStream(it->m_path.c_str()));
+    return RVNGInputStreamPtr_t(m_package->getSubStreamByName(it->m_path.c_str()));
   }
 
-  return it->second.second;
+  if (!it->m_stream && m_package)
+  {
+    assert(m_package->existsSubStream(it->m_path.c_str())); // we already checked for its presence
+    it->m_stream.reset(m_package->getSubStreamByName(it->m_path.c_str()));
+  }
+
+  return it->m_stream;
+}
+
+boost::optional<std::string> IWAObjectIndex::queryFilePath(const unsigned id) const
+{
+  const auto it = findRecord(m_fileList, id);
+
+  if (it == m_fileList.end())
+  {
+    ETONYEK_DEBUG_MSG(("IWAObjectIndex::queryFilePath: file %u not found\n", id));
+    return boost::none;
+  }
+  return it->m_path;
+}
+
+const IWAObjectIndex::ObjectRecord *IWAObjectIndex::findObject(const unsigned id) const
+{
+  auto recIt = findRecord(m_objectList, id);
+  if (recIt == m_objectList.end())
+  {
+    ETONYEK_DEBUG_MSG(("IWAObjectIndex::findObject: object %u not found\n", id));
+    return nullptr;
+  }
+  if (!recIt->m_known && !m_fragmentList[recIt->m_fragment].m_scanned)
+  {
+    assert(!m_shared);
+    const_cast<IWAObjectIndex *>(this)->scanFragment(recIt->m_fragment);
+    recIt = findRecord(m_objectList, id); // the scan could have added records
+  }
+  return recIt->m_known ? &*recIt : nullptr;
 }
 
-void IWAObjectIndex::scanFragment(const unsigned id)
+void IWAObjectIndex::addObjects(ObjectList_t &objects)
 {
+  sortRecords(objects);
+  // only the old records are sorted until the merge, so look only there
+  const auto oldEnd = m_objectList.size();
+  for (auto &object : objects)
+  {
+    const auto sortedEnd = m_objectList.begin() + long(oldEnd);
+    const auto it = std::lower_bound(m_objectList.begin(), sortedEnd, object, lessId<ObjectRecord>);
+    if (it == sortedEnd || it->m_id != object.m_id)
+      m_objectList.push_back(object);
+    else if (object.m_known || !it->m_known)
+      *it = object;
+  }
+  if (m_objectList.size() != oldEnd)
+    std::inplace_merge(m_objectList.begin(), m_objectList.begin() + long(oldEnd), m_objectList.end(), lessId<ObjectRecord>);
+}
+
+void IWAObjectIndex::scanFragment(const unsigned fragment)
+{
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_OBJECT_INDEX);
+  Fragment &frag = m_fragmentList[fragment];
+  if (frag.m_scanned)
+    return;
+  frag.m_scanned = true;
+  if (frag.m_path.empty())
+    return;
+
   // scan the fragment file
-  const auto fragmentIt = m_unparsedFragments.find(id);
-  if (fragmentIt != m_unparsedFragments.end())
+  const RVNGInputStreamPtr_t stream(m_fragments->getSubStreamByName(frag.m_path.c_str()));
+  if (stream)
   {
-    const RVNGInputStreamPtr_t stream(m_fragments->getSubStreamByName(fragmentIt->second.c_str()));
+    setStream(frag, openFragment(stream));
+    ObjectList_t objects;
+    scanFragment(fragment, frag.m_stream, objects);
+    addObjects(objects);
+  }
+  else
+  {
+    ETONYEK_DEBUG_MSG(("IWAObjectIndex::scanFragment: file %s does not exist\n", frag.m_path.c_str()));
+  }
+}
+
+void IWAObjectIndex::prefetch(const unsigned threads)
+{
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_OBJECT_INDEX);
+  struct Scan
+  {
+    unsigned m_fragment;
+    RVNGInputStreamPtr_t m_stream;
+    ObjectList_t m_objects;
+    bool m_done;
+  };
+
+  // The package is not thread-safe, so the fragment streams are opened
+  // here; only the uncompression and the scan are done in parallel.
+  std::vector<Scan> scans;
+  for (unsigned fragment = 0; fragment != m_fragmentList.size(); ++fragment)
+  {
+    Fragment &frag = m_fragmentList[fragment];
+    if (frag.m_scanned)
+      continue;
+    const RVNGInputStreamPtr_t stream(frag.m_path.empty() ? nullptr : m_fragments->getSubStreamByName(frag.m_path.c_str()));
     if (stream)
+      scans.push_back(Scan{fragment, stream, ObjectList_t(), false});
+    else
     {
-      const auto fragment = make_shared<IWASnappyStream>(stream);
-      scanFragment(fragmentIt->first, fragment);
+      frag.m_scanned = true;
+      if (!frag.m_path.empty())
+      {
+        ETONYEK_DEBUG_MSG(("IWAObjectIndex::prefetch: file %s does not exist\n", frag.m_path.c_str()));
+      }
     }
-    else
+  }
+
+  {
+    IWORKThreadPool pool(threads);
+    for (auto &scan : scans)
     {
-      ETONYEK_DEBUG_MSG(("IWAObjectIndex::scanFragment: file %s does not exist\n", fragmentIt->second.c_str()));
+      pool.post([&scan]()
+      {
+        scan.m_stream = openFragment(scan.m_stream);
+        scanFragment(scan.m_fragment, scan.m_stream, scan.m_objects);
+        scan.m_done = true;
+      });
+    }
+    pool.wait();
+  }
+
+  for (auto &scan : scans)
+  {
+    Fragment &frag = m_fragmentList[scan.m_fragment];
+    if (!scan.m_done)
+    {
+      // leave it to scanFragment(), which reports the failure
+      ETONYEK_DEBUG_MSG(("IWAObjectIndex::prefetch: file %s could not be scanned\n", frag.m_path.c_str()));
+      continue;
     }
-    m_unparsedFragments.erase(fragmentIt);
+    frag.m_scanned = true;
+    setStream(frag, scan.m_stream);
+    addObjects(scan.m_objects);
+  }
+}
+
+void IWAObjectIndex::setShared(const bool shared)
+{
+  if (shared)
+  {
+    for (unsigned fragment = 0; fragment != m_fragmentList.size(); ++fragment)
+      scanFragment(fragment);
+  }
+  m_shared = shared;
+}
+
+IWAObjectIndex::SharedScope::SharedScope(IWAObjectIndex &index)
+  : m_index(index)
+  , m_wasShared(index.m_shared)
+{
+  m_index.setShared(true);
+}
+
+IWAObjectIndex::SharedScope::~SharedScope()
+{
+  m_index.setShared(m_wasShared);
+}
+
+RVNGInputStreamPtr_t IWAObjectIndex::openFragment(const RVNGInputStreamPtr_t &stream)
+{
+  // big fragments, like table tiles, are usually only needed partially
+  const IWASnappyStream::Mode mode = getLength(stream) > onDemandFragmentSize ? IWASnappyStream::MODE_ON_DEMAND : IWASnappyStream::MODE_WHOLE;
+  return make_shared<IWASnappyStream>(stream, mode);
+}
+
+void IWAObjectIndex::setStream(Fragment &fragment, const RVNGInputStreamPtr_t &stream)
+{
+  fragment.m_stream = stream;
+  fragment.m_buffer = std::static_pointer_cast<IWASnappyStream>(stream)->getBuffer();
+}
+
+IWAMessage IWAObjectIndex::readObject(const ObjectRecord &record) const
+{
+  const Fragment &fragment = m_fragmentList[record.m_fragment];
+  // a view of the fragment data, if they are in memory; otherwise the
+  // part of the stream is copied
+  if (fragment.m_buffer)
+  {
+    // the last object of a broken fragment can be truncated
+    const std::size_t end = (std::min)(std::size_t(record.m_dataEnd), fragment.m_buffer->size());
+    const std::size_t begin = (std::min)(std::size_t(record.m_dataBegin), end);
+    return IWAMessage(fragment.m_buffer, begin, end);
   }
+#ifdef WITH_THREADS
+  // the position in the stream is shared by all readers
+  std::unique_lock<std::mutex> lock(m_mutex, std::defer_lock);
+  if (m_shared)
+    lock.lock();
+#endif
+  return IWAMessage(fragment.m_stream, record.m_dataBegin, record.m_dataEnd);
 }
 
-void IWAObjectIndex::scanFragment(const unsigned id, const RVNGInputStreamPtr_t &stream)
+/** Scan the objects of a fragment.
+  *
+  * If @c lastId is not 0, the scan stops after the object with that id.
+  */
+void IWAObjectIndex::scanFragment(const unsigned fragment, const RVNGInputStreamPtr_t &stream, ObjectList_t &objects, const unsigned lastId)
 try
 {
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_OBJECT_INDEX);
   while (!stream->isEnd())
   {
     // scan a single object
@@ -211,12 +483,15 @@ try
       if (!type) type=info.uint32(1).optional(); // normally, all data must define the same type
     }
     if (!ok) break;
+    const long dataBegin = start + long(headerLen);
+    const long dataEnd = dataBegin + long(dataLen);
     if (header.uint32(1))
     {
-      const ObjectRecord rec(stream, get_optional_value_or(type, 0), start, (unsigned long)(headerLen), (unsigned long)(dataLen));
-      m_fragmentObjectMap[header.uint32(1).get()] = make_pair(id, rec);
+      objects.push_back(ObjectRecord(header.uint32(1).get(), fragment, get_optional_value_or(type, 0), dataBegin, dataEnd));
+      if (lastId && (header.uint32(1).get() == lastId))
+        break;
     }
-    if (stream->seek(start + long(headerLen) + long(dataLen), librevenge::RVNG_SEEK_SET) != 0)
+    if (stream->seek(dataEnd, librevenge::RVNG_SEEK_SET) != 0)
       break;
   }
 }
@@ -225,29 +500,98 @@ catch (...)
   // just read as much as possible
 }
 
+const IWAObjectIndex::ObjectRecord *IWAObjectIndex::probeObject(const RVNGInputStreamPtr_t &fragments, const std::string &path, const unsigned id,
+                                                                RVNGInputStreamPtr_t &stream, ObjectList_t &objects)
+{
+  const RVNGInputStreamPtr_t compressed(fragments->getSubStreamByName(path.c_str()));
+  if (!compressed)
+  {
+    ETONYEK_DEBUG_MSG(("IWAObjectIndex::probeObject: file %s does not exist\n", path.c_str()));
+    return nullptr;
+  }
+  stream = make_shared<IWASnappyStream>(compressed, IWASnappyStream::MODE_ON_DEMAND);
+  objects.clear();
+  scanFragment(0, stream, objects, id);
+  if (objects.empty() || (objects.back().m_id != id))
+    return nullptr;
+  return &objects.back();
+}
+
+boost::optional<unsigned> IWAObjectIndex::probeObjectType(const RVNGInputStreamPtr_t &fragments, const unsigned id)
+try
+{
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_OBJECT_INDEX);
+
+  RVNGInputStreamPtr_t stream;
+  ObjectList_t objects;
+  const ObjectRecord *const indexRec = probeObject(fragments, "Index/Metadata.iwa", 2, stream, objects);
+  if (!indexRec)
+    return boost::none;
+
+  // find the fragment containing the object
+  const IWAMessage objectIndex(stream, indexRec->m_dataBegin, indexRec->m_dataEnd);
+  std::unordered_map<unsigned, string> paths;
+  optional<unsigned> fragmentId;
+  for (const auto &fragment : objectIndex.message(3).repeated())
+  {
+    if (!fragment.uint32(1))
+      continue;
+    const unsigned currentId = fragment.uint32(1).get();
+    if (fragment.string(2) || fragment.string(3))
+    {
+      paths[currentId] = "Index/" + fragment.string(fragment.string(3) ? 3 : 2).get() + ".iwa";
+      if (currentId == id)
+        fragmentId = currentId;
+    }
+    for (const auto &ref : fragment.message(6).repeated())
+    {
+      if (ref.uint32(1) && ref.uint32(2) && (ref.uint32(2).get() == id))
+        fragmentId = ref.uint32(1).get();
+    }
+  }
+  const auto it = fragmentId ? paths.find(get(fragmentId)) : paths.end();
+  if (it != paths.end())
+  {
+    const ObjectRecord *const rec = probeObject(fragments, it->second, id, stream, objects);
+    return rec ? rec->m_type : boost::optional<unsigned>();
+  }
+
+  // the objects that are not in the index are in the root fragments
+  for (const char *const path : { "Index/Document.iwa", "Index/Metadata.iwa" })
+  {
+    const ObjectRecord *const rec = probeObject(fragments, path, id, stream, objects);
+    if (rec)
+      return rec->m_type;
+  }
+  return boost::none;
+}
+catch (...)
+{
+  return boost::none;
+}
+
 boost::optional<IWORKColor> IWAObjectIndex::queryFileColor(unsigned id) const
 {
-  auto it=m_fileColorMap.find(id);
-  if (it==m_fileColorMap.end())
+  auto it=findRecord(m_fileColorList, id);
+  if (it==m_fileColorList.end())
   {
     ETONYEK_DEBUG_MSG(("IWAObjectIndex::queryFileColor: can not find color for %d\n", int(id)));
     return boost::none;
   }
-  return it->second;
+  return it->m_color;
 }
 
 void IWAObjectIndex::scanColorFileMap(unsigned id)
 try
 {
-  const auto indexIt = m_fragmentObjectMap.find(id);
-  if (indexIt == m_fragmentObjectMap.end() || !indexIt->second.second.m_stream)
+  const ObjectRecord *const rec = findObject(id);
+  if (!rec)
   {
     // TODO: scan all fragment files
     ETONYEK_DEBUG_MSG(("IWAObjectIndex::scanColorFileMap: can not find object %d\n", int(id)));
     return;
   }
-  const ObjectRecord &rec = indexIt->second.second;
-  const IWAMessage objectIndex(rec.m_stream, rec.m_dataRange.first, rec.m_dataRange.second);
+  const IWAMessage objectIndex(readObject(*rec));
   for (auto const &corr : objectIndex.message(1).repeated())
   {
     auto ref=IWAParser::readRef(corr, 2);
@@ -257,25 +601,26 @@ try
       continue;
     }
     auto color=scanColorFileCorrespondance(*ref);
-    if (color) m_fileColorMap[get(corr.uint32(1))]=get(color);
+    if (color) m_fileColorList.push_back(FileColor(get(corr.uint32(1)), get(color)));
   }
+  sortRecords(m_fileColorList);
 }
 catch (...)
 {
+  sortRecords(m_fileColorList);
 }
 
 boost::optional<IWORKColor> IWAObjectIndex::scanColorFileCorrespondance(unsigned id)
 try
 {
-  const auto indexIt = m_fragmentObjectMap.find(id);
-  if (indexIt == m_fragmentObjectMap.end() || !indexIt->second.second.m_stream)
+  const ObjectRecord *const rec = findObject(id);
+  if (!rec)
   {
     // TODO: scan all fragment files
     ETONYEK_DEBUG_MSG(("IWAObjectIndex::scanColorFileCorrespondance: can not find object %d\n", int(id)));
     return boost::none;
   }
-  const ObjectRecord &rec = indexIt->second.second;
-  const IWAMessage objectIndex(rec.m_stream, rec.m_dataRange.first, rec.m_dataRange.second);
+  const IWAMessage objectIndex(readObject(*rec));
   return IWAParser::readColor(objectIndex, 1);
 }
 catch (...)
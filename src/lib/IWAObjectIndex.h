@@ -10,14 +10,20 @@
 #ifndef IWAOBJECTINDEX_H_INCLUDED
 #define IWAOBJECTINDEX_H_INCLUDED
 
-#include <map>
 #include <string>
-#include <utility>
+#include <vector>
 
 #include <boost/optional.hpp>
 
+#include "IWAReader.h"
 #include "libetonyek_utils.h"
 
+#ifdef WITH_THREADS
+#include <mutex>
+#endif
+
+#include "IWORKTypes.h"
+
 namespace libetonyek
 {
 
@@ -25,31 +31,127 @@ class IWAMessage;
 
 class IWAObjectIndex
 {
-public:
-  struct ObjectRecord
-  {
-    ObjectRecord();
-    ObjectRecord(const RVNGInputStreamPtr_t &stream, unsigned type, long pos, unsigned long headerLen, unsigned long dataLen);
-
-    RVNGInputStreamPtr_t m_stream;
-    unsigned m_type;
-    std::pair<long, long> m_headerRange;
-    std::pair<long, long> m_dataRange;
-  };
-
 public:
   IWAObjectIndex(const RVNGInputStreamPtr_t &fragments, const RVNGInputStreamPtr_t &package);
 
   void parse();
 
+  /** Scan all not yet scanned fragments at once.
+    *
+    * The fragments are uncompressed and indexed in parallel. A fragment
+    * that fails is scanned again when one of its objects is needed.
+    *
+    * @arg[in] threads the number of threads to use (0 means one per processor).
+    */
+  void prefetch(unsigned threads = 0);
+
+  /** Let more parsers use the index at once.
+    *
+    * All fragments that are not scanned yet are scanned now, so the
+    * index does not change anymore and objects are looked up without
+    * locking. Only reading an object from a fragment that is not in
+    * memory and opening a file are serialized. Each query of a file
+    * opens a new stream, because the stream can be read after the
+    * query returns.
+    *
+    * An index that is not shared must be used by one thread only.
+    */
+  void setShared(bool shared);
+
+  /** Share an index for the lifetime of the object.
+    *
+    * The previous mode is restored at the end, even if an exception is
+    * thrown.
+    */
+  class SharedScope
+  {
+    // disable copying
+    SharedScope(const SharedScope &);
+    SharedScope &operator=(const SharedScope &);
+
+  public:
+    explicit SharedScope(IWAObjectIndex &index);
+    ~SharedScope();
+
+  private:
+    IWAObjectIndex &m_index;
+    const bool m_wasShared;
+  };
+
   void queryObject(const unsigned id, unsigned &type, boost::optional<IWAMessage> &msg) const;
   boost::optional<unsigned> getObjectType(const unsigned id) const;
   const RVNGInputStreamPtr_t queryFile(unsigned id) const;
+  /// Get the path of a file in the package, without opening it.
+  boost::optional<std::string> queryFilePath(unsigned id) const;
   boost::optional<IWORKColor> queryFileColor(unsigned id) const;
 
+  /** Find the type of an object, reading as little as possible.
+    *
+    * This is meant for detection. The object index is read without
+    * building it and the fragments are uncompressed on demand and only
+    * scanned up to the object being looked for.
+    */
+  static boost::optional<unsigned> probeObjectType(const RVNGInputStreamPtr_t &fragments, unsigned id);
+
 private:
-  void scanFragment(unsigned id);
-  void scanFragment(unsigned id, const RVNGInputStreamPtr_t &stream);
+  struct Fragment
+  {
+    Fragment(unsigned id, const std::string &path);
+
+    unsigned m_id;
+    std::string m_path; //!< path of the fragment file, empty if unknown
+    RVNGInputStreamPtr_t m_stream; //!< the uncompressed fragment, once it has been scanned
+    IWABufferPtr_t m_buffer; //!< the data of m_stream, if they are all in memory
+    bool m_scanned;
+  };
+
+  /** An entry of the object index.
+    *
+    * The records are kept in a single array sorted by object id, so
+    * they should stay small: the stream is held by the fragment.
+    */
+  struct ObjectRecord
+  {
+    ObjectRecord(unsigned id, unsigned fragment);
+    ObjectRecord(unsigned id, unsigned fragment, unsigned type, long dataBegin, long dataEnd);
+
+    unsigned m_id;
+    unsigned m_fragment; //!< index of the fragment in m_fragments
+    unsigned m_type;
+    bool m_known; //!< the object has been found in the fragment
+    long m_dataBegin;
+    long m_dataEnd;
+  };
+
+  struct File
+  {
+    File(unsigned id, const std::string &path);
+
+    unsigned m_id;
+    std::string m_path;
+    RVNGInputStreamPtr_t m_stream;
+  };
+
+  struct FileColor
+  {
+    FileColor(unsigned id, const IWORKColor &color);
+
+    unsigned m_id;
+    IWORKColor m_color;
+  };
+
+  typedef std::vector<ObjectRecord> ObjectList_t;
+
+  const ObjectRecord *findObject(unsigned id) const;
+  void addObjects(ObjectList_t &objects);
+
+  void scanFragment(unsigned fragment);
+  static void scanFragment(unsigned fragment, const RVNGInputStreamPtr_t &stream, ObjectList_t &objects, unsigned lastId = 0);
+  static const ObjectRecord *probeObject(const RVNGInputStreamPtr_t &fragments, const std::string &path, unsigned id,
+                                         RVNGInputStreamPtr_t &stream, ObjectList_t &objects);
+  static RVNGInputStreamPtr_t openFragment(const RVNGInputStreamPtr_t &stream);
+  void setStream(Fragment &fragment, const RVNGInputStreamPtr_t &stream);
+  IWAMessage readObject(const ObjectRecord &record) const;
 
   void scanColorFileMap(unsigned id);
   boost::optional<IWORKColor> scanColorFileCorrespondance(unsigned id);
@@ -57,10 +159,15 @@ private:
   const RVNGInputStreamPtr_t m_fragments;
   const RVNGInputStreamPtr_t m_package;
 
-  mutable std::map<unsigned, std::string> m_unparsedFragments;
-  mutable std::map<unsigned, std::pair<unsigned, ObjectRecord>> m_fragmentObjectMap;
-  mutable std::map<unsigned, std::pair<std::string, RVNGInputStreamPtr_t>> m_fileMap;
-  mutable std::map<unsigned, IWORKColor> m_fileColorMap;
+  mutable std::vector<Fragment> m_fragmentList;
+  mutable ObjectList_t m_objectList; //!< sorted by id
+  mutable std::vector<File> m_fileList; //!< sorted by id
+  std::vector<FileColor> m_fileColorList; //!< sorted by id
+
+  bool m_shared;
+#ifdef WITH_THREADS
+  mutable std::mutex m_mutex; //!< guards reading of fragment streams and opening of files in shared mode
+#endif
 };
 
 }
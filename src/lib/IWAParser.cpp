@@ -11,15 +11,20 @@
 
 #include <algorithm>
 #include <cassert>
+#include <exception>
 #include <functional>
 #include <iomanip>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <sstream>
 #include <utility>
+#include <vector>
 
 #include <boost/optional.hpp>
 
+#include <libetonyek/EtonyekDocument.h>
+
 #include "libetonyek_xml.h"
 #include "IWAObjectType.h"
 #include "IWAText.h"
@@ -30,6 +35,7 @@
 #include "IWORKProperties.h"
 #include "IWORKTable.h"
 #include "IWORKText.h"
+#include "IWORKThreadPool.h"
 #include "IWORKTransformation.h"
 #include "IWORKTypes.h"
 
@@ -53,6 +59,13 @@ using std::string;
 
 namespace
 {
+
+/** Number of objects kept in the cache of IWAParser.
+  *
+  * The styles are kept separately, so this only has to cover the
+  * objects used again while a part of the document is parsed.
+  */
+const std::size_t objectCacheSize = 1024;
 bool samePoint(const optional<IWORKPosition> &point1, const optional<IWORKPosition> &point2)
 {
   if (point1 && point2)
@@ -163,13 +176,36 @@ IWAParser::TableInfo::TableInfo(const shared_ptr<IWORKTable> &table, const unsig
 {
 }
 
+IWAParser::TileCell::TileCell(const unsigned row, const unsigned column, const bool oldFormat)
+  : m_row(row)
+  , m_column(column)
+  , m_oldFormat(oldFormat)
+  , m_type(IWORK_CELL_TYPE_TEXT)
+  , m_text()
+  , m_numberSet(false)
+  , m_cellStyleId()
+  , m_formatId()
+  , m_paragraphStyleId()
+  , m_commentId()
+  , m_conditionId()
+  , m_formulaId()
+  , m_textId()
+  , m_textFormattedId()
+{
+}
+
 IWAParser::IWAParser(const RVNGInputStreamPtr_t &fragments, const RVNGInputStreamPtr_t &package, IWORKCollector &collector)
   : m_formatNameMap()
   , m_langManager()
   , m_tableNameMap(std::make_shared<IWORKTableNameMap_t>())
+  , m_tableNamesOnWrite(false)
   , m_currentText()
   , m_collector(collector)
-  , m_index(fragments, package)
+  , m_options(0)
+  , m_index(std::make_shared<IWAObjectIndex>(fragments, package))
+  , m_indexParsed(false)
+  , m_objectCache()
+  , m_objectLru()
   , m_visited()
   , m_charStyles()
   , m_dropCapStyles()
@@ -185,6 +221,41 @@ IWAParser::IWAParser(const RVNGInputStreamPtr_t &fragments, const RVNGInputStrea
 {
 }
 
+void IWAParser::setOptions(const unsigned options)
+{
+  m_options = options;
+}
+
+void IWAParser::setObjectIndex(const std::shared_ptr<IWAObjectIndex> &index)
+{
+  assert(bool(index));
+  m_index = index;
+  m_indexParsed = true;
+}
+
+void IWAParser::shareStyles(const IWAParser &other)
+{
+  m_charStyles = other.m_charStyles;
+  m_dropCapStyles = other.m_dropCapStyles;
+  m_paraStyles = other.m_paraStyles;
+  m_sectionStyles = other.m_sectionStyles;
+  m_graphicStyles = other.m_graphicStyles;
+  m_mediaStyles = other.m_mediaStyles;
+  m_cellStyles = other.m_cellStyles;
+  m_tableStyles = other.m_tableStyles;
+  m_listStyles = other.m_listStyles;
+}
+
+unsigned IWAParser::getOptions() const
+{
+  return m_options;
+}
+
+const std::shared_ptr<IWAObjectIndex> &IWAParser::getObjectIndex() const
+{
+  return m_index;
+}
+
 bool IWAParser::parse()
 {
   parseObjectIndex();
@@ -193,21 +264,20 @@ bool IWAParser::parse()
 
 IWAParser::ObjectMessage::ObjectMessage(IWAParser &parser, const unsigned id, const unsigned type)
   : m_parser(parser)
-  , m_message()
+  , m_message(nullptr)
   , m_id(id)
   , m_type(0)
 {
-  std::deque<unsigned>::const_iterator it = find(m_parser.m_visited.begin(), m_parser.m_visited.end(), m_id);
-  if (it == m_parser.m_visited.end())
+  if (m_parser.m_visited.find(m_id) == m_parser.m_visited.end())
   {
-    optional<IWAMessage> msg;
-    m_parser.queryObject(m_id, m_type, msg);
-    if (msg)
+    const ResolvedObject &obj = m_parser.resolveObject(m_id);
+    m_type = obj.m_type;
+    if (obj.m_message)
     {
       if ((m_type == type) || (type == 0))
       {
-        m_message = msg;
-        m_parser.m_visited.push_back(m_id);
+        m_message = obj.m_message.get_ptr();
+        m_parser.m_visited.insert(m_id);
       }
       else
       {
@@ -225,9 +295,9 @@ IWAParser::ObjectMessage::~ObjectMessage()
 {
   if (m_message)
   {
-    assert(!m_parser.m_visited.empty());
-    assert(m_parser.m_visited.back() == m_id);
-    m_parser.m_visited.pop_back();
+    const auto erased = m_parser.m_visited.erase(m_id);
+    assert(erased == 1);
+    (void) erased;
   }
 }
 
@@ -238,7 +308,8 @@ IWAParser::ObjectMessage::operator bool() const
 
 const IWAMessage &IWAParser::ObjectMessage::get() const
 {
-  return m_message.get();
+  assert(m_message);
+  return *m_message;
 }
 
 unsigned IWAParser::ObjectMessage::getType() const
@@ -246,19 +317,86 @@ unsigned IWAParser::ObjectMessage::getType() const
   return m_type;
 }
 
-void IWAParser::queryObject(const unsigned id, unsigned &type, boost::optional<IWAMessage> &msg) const
+IWAParser::ResolvedObject::ResolvedObject()
+  : m_type(0)
+  , m_message()
+  , m_lruPos()
+{
+}
+
+const IWAParser::ResolvedObject &IWAParser::resolveObject(const unsigned id) const
+{
+  auto it = m_objectCache.find(id);
+  if (it != m_objectCache.end())
+  {
+    m_objectLru.splice(m_objectLru.begin(), m_objectLru, it->second.m_lruPos);
+    return it->second;
+  }
+
+  it = m_objectCache.insert(make_pair(id, ResolvedObject())).first;
+  m_index->queryObject(id, it->second.m_type, it->second.m_message);
+  m_objectLru.push_front(id);
+  it->second.m_lruPos = m_objectLru.begin();
+
+  // drop the least recently used objects, except the new one and those
+  // being visited: their messages are still in use
+  const auto newest = m_objectLru.begin();
+  auto lruIt = m_objectLru.end();
+  while ((m_objectCache.size() > objectCacheSize) && (std::prev(lruIt) != newest))
+  {
+    --lruIt;
+    if (m_visited.find(*lruIt) == m_visited.end())
+    {
+      m_objectCache.erase(*lruIt);
+      lruIt = m_objectLru.erase(lruIt);
+    }
+  }
+  return it->second;
+}
+
+void IWAParser::releaseObject(const unsigned id)
 {
-  m_index.queryObject(id, type, msg);
+  if (m_visited.find(id) != m_visited.end())
+    return;
+  const auto it = m_objectCache.find(id);
+  if (it != m_objectCache.end())
+  {
+    m_objectLru.erase(it->second.m_lruPos);
+    m_objectCache.erase(it);
+  }
 }
 
 boost::optional<unsigned> IWAParser::getObjectType(const unsigned id) const
 {
-  return m_index.getObjectType(id);
+  // do not decode the object just to learn its type
+  const auto it = m_objectCache.find(id);
+  if ((it != m_objectCache.end()) && it->second.m_message)
+    return it->second.m_type;
+  return m_index->getObjectType(id);
 }
 
-const RVNGInputStreamPtr_t IWAParser::queryFile(const unsigned id) const
+IWORKDataPtr_t IWAParser::queryData(const unsigned id) const
 {
-  return m_index.queryFile(id);
+  IWORKDataPtr_t data;
+  if (m_options & EtonyekDocument::OPTION_MEDIA_REFERENCES)
+  {
+    const boost::optional<std::string> path = m_index->queryFilePath(id);
+    if (path)
+    {
+      data = std::make_shared<IWORKData>();
+      data->m_path = get(path);
+    }
+  }
+  else
+  {
+    const RVNGInputStreamPtr_t stream = m_index->queryFile(id);
+    if (stream)
+    {
+      data = std::make_shared<IWORKData>();
+      data->m_stream = stream;
+    }
+  }
+  return data;
 }
 
 boost::optional<unsigned> IWAParser::readRef(const IWAMessage &msg, const unsigned field)
@@ -273,7 +411,7 @@ std::deque<unsigned> IWAParser::readRefs(const IWAMessage &msg, const unsigned f
   std::deque<unsigned> refs;
   if (msg.message(field))
   {
-    const std::deque<IWAMessage> &objs = msg.message(field).repeated();
+    const auto &objs = msg.message(field).repeated();
     for (const auto &obj : objs)
     {
       if (obj.uint32(1))
@@ -328,7 +466,7 @@ boost::optional<uint64_t> IWAParser::readUID(const IWAMessage &msg, unsigned fie
 
 std::deque<uint64_t> IWAParser::readUIDs(const IWAMessage &msg, unsigned field)
 {
-  const std::deque<IWAMessage> &objs = msg.message(field).repeated();
+  const auto &objs = msg.message(field).repeated();
   std::deque<uint64_t> res;
   for (const auto &obj : objs)
   {
@@ -433,7 +571,7 @@ void IWAParser::readStroke(const IWAMessage &msg, IWORKStroke &stroke)
     unsigned remaining = 0;
     if (msg.message(6).uint32(3))
       remaining = get(msg.message(6).uint32(3));
-    const deque<float> &elements = msg.message(6).float_(4).repeated();
+    const auto &elements = msg.message(6).float_(4).repeated();
     for (auto it = elements.begin(); it != elements.end() && remaining != 0; ++it)
       stroke.m_pattern.m_values.push_back(*it);
   }
@@ -491,9 +629,8 @@ bool IWAParser::readFill(const IWAMessage &msg, IWORKFill &fill)
     if (fileRef)
     {
       // find also 16 with no file...
-      bitmap.m_data = std::make_shared<IWORKData>();
-      bitmap.m_data->m_stream = queryFile(get(fileRef));
-      if (!bitmap.m_data->m_stream && !bitmap.m_fillColor) bitmap.m_fillColor = m_index.queryFileColor(get(fileRef));
+      bitmap.m_data = queryData(get(fileRef));
+      if (!bitmap.m_data && !bitmap.m_fillColor) bitmap.m_fillColor = m_index->queryFileColor(get(fileRef));
     }
     fill = bitmap;
     return true;
@@ -1192,11 +1329,11 @@ bool IWAParser::parseArrowProperties(const IWAMessage &arrow, IWORKPropertyMap &
 
 bool IWAParser::parsePath(const IWAMessage &msg, IWORKPathPtr_t &path)
 {
-  const deque<IWAMessage> &elements = msg.message(1).repeated();
+  const auto &elements = msg.message(1).repeated();
   bool closed = false;
   bool closingMove = false;
   path.reset(new IWORKPath());
-  for (auto it : elements)
+  for (const auto &it : elements)
   {
     const auto &type = it.uint32(1).optional();
     if (!type)
@@ -1243,7 +1380,7 @@ bool IWAParser::parsePath(const IWAMessage &msg, IWORKPathPtr_t &path)
     {
       if (it.message(2))
       {
-        const std::deque<IWAMessage> &positions = it.message(2).repeated();
+        const auto &positions = it.message(2).repeated();
         if (positions.size() >= 3)
         {
           if (positions.size() > 3)
@@ -1344,13 +1481,13 @@ bool IWAParser::parseDrawableShape(const IWAMessage &msg, bool isConnectionLine)
     // look for arrow Keynote 6
     if (get(shape).message(4) || get(shape).message(5))
     {
-      if (!style)
-        style=std::make_shared<IWORKStyle>(IWORKPropertyMap(),boost::none, boost::none);
+      IWORKPropertyMap arrowProps;
       for (size_t st=0; st<2; ++st)
       {
         if (!get(shape).message(st+4)) continue;
-        parseArrowProperties(get(get(shape).message(st+4)),style->getPropertyMap(),st==0);
+        parseArrowProperties(get(get(shape).message(st+4)),arrowProps,st==0);
       }
+      style=std::make_shared<IWORKStyle>(arrowProps,boost::none,style);
     }
     if (style)
       m_collector.setGraphicStyle(style);
@@ -1450,9 +1587,9 @@ bool IWAParser::parseDrawableShape(const IWAMessage &msg, bool isConnectionLine)
           auto const &bezier = rootMsg.get().message(3).optional();
           if (bezier)
           {
-            const deque<IWAMessage> &elements = get(bezier).message(1).repeated();
+            const auto &elements = get(bezier).message(1).repeated();
             int pos=0;
-            for (auto it : elements)
+            for (const auto &it : elements)
             {
               // normally first point (type 1) followed by 2 points (type 2)
               // const auto &type = it.uint32(1).optional();
@@ -1634,7 +1771,13 @@ void IWAParser::parseMask(unsigned id, IWORKGeometryPtr_t &geometry, IWORKPathPt
 
 void IWAParser::parseObjectIndex()
 {
-  m_index.parse();
+  if (!m_indexParsed)
+  {
+    m_index->parse();
+    m_indexParsed = true;
+  }
+  if (m_options & EtonyekDocument::OPTION_PARALLEL_FRAGMENTS)
+    m_index->prefetch();
 }
 
 void IWAParser::parseCharacterStyle(const unsigned id, IWORKStylePtr_t &style)
@@ -2133,15 +2276,13 @@ void IWAParser::parseListStyle(const unsigned id, IWORKStylePtr_t &style)
         break;
       }
       const IWORKMediaContentPtr_t content = make_shared<IWORKMediaContent>();
-      auto stream = queryFile(get(ref));
-      if (!stream)
+      const IWORKDataPtr_t data = queryData(get(ref));
+      if (!data)
       {
         // the image is probably in the theme model
         levelProps[level].put<ListLabelTypeInfo>(std::string(defBullet));
         break;
       }
-      const IWORKDataPtr_t data = make_shared<IWORKData>();
-      data->m_stream = stream;
       content->m_data = data;
       levelProps[level].put<ListLabelTypeInfo>(content);
       break;
@@ -2221,7 +2362,10 @@ void IWAParser::parseListStyle(const unsigned id, IWORKStylePtr_t &style)
   {
     const IWORKListLevels_t &parentStyle = parent->get<ListLevelStyles>();
     for (const auto &it : parentStyle)
-      levelProps[it.first].setParent(&it.second->getPropertyMap());
+    {
+      const IWORKStyle &levelStyle = *it.second;
+      levelProps[it.first].setParent(&levelStyle.getPropertyMap());
+    }
   }
 
   IWORKListLevels_t listStyle;
@@ -2428,10 +2572,8 @@ bool IWAParser::parseImage(const IWAMessage &msg)
   {
     auto const &ref=readRef(msg, id);
     if (!ref) continue;
-    auto stream = queryFile(get(ref));
-    if (!stream) continue;
-    const IWORKDataPtr_t data = make_shared<IWORKData>();
-    data->m_stream = stream;
+    const IWORKDataPtr_t data = queryData(get(ref));
+    if (!data) continue;
     content->m_data = data;
     break;
   }
@@ -2638,24 +2780,10 @@ void IWAParser::parseTabularModel(const unsigned id)
     }
     else
       finalName=get(get(msg).string(8));
-    if (m_tableNameMap->find(finalName)!=m_tableNameMap->end())
-    {
-      ETONYEK_DEBUG_MSG(("IWAParser::parseTabularModel: a table with name %s already exists\n", finalName.c_str()));
-      // let create an unique name
-      int nId=0;
-      while (true)
-      {
-        std::stringstream s;
-        s << finalName << "_" << ++nId;
-        if (m_tableNameMap->find(s.str())!=m_tableNameMap->end()) continue;
-        finalName=s.str();
-        break;
-      }
-    }
-    (*m_tableNameMap)[finalName]=finalName;
-    if (get(msg).string(1))
-      (*m_tableNameMap)[std::string("SFTGlobalID_")+get(get(msg).string(1))] = finalName;
-    m_currentTable->m_table->setName(finalName);
+    if (m_tableNamesOnWrite)
+      m_currentTable->m_table->setNameOnWrite(finalName, get(msg).string(1).optional());
+    else
+      m_currentTable->m_table->setName(IWORKTable::registerName(*m_tableNameMap, finalName, get(msg).string(1).optional()));
   }
   m_currentTable->m_table->setHeaders(
     get_optional_value_or(get(msg).uint32(10).optional(), 0),
@@ -2706,17 +2834,28 @@ void IWAParser::parseTabularModel(const unsigned id)
   }
 
   // handle tables
+  std::vector<std::pair<unsigned, unsigned> > tiles; // first row, tile ref
   for (auto const &tileIt : idToTileRefMap)
   {
     auto const &decalIt=idToTileDecalRowMap.find(tileIt.first);
     if (decalIt==idToTileDecalRowMap.end())
     {
       ETONYEK_DEBUG_MSG(("IWAParser::parseTabularModel: oops, can not find some decal for id=%x, assume 0\n", tileIt.first));
-      parseTile(tileIt.second, 0);
+      tiles.push_back(std::make_pair(0, tileIt.second));
     }
     else
-      parseTile(tileIt.second, decalIt->second);
+      tiles.push_back(std::make_pair(decalIt->second, tileIt.second));
+  }
+  const bool streaming = (m_options & EtonyekDocument::OPTION_STREAMING_TABLES) && m_collector.streamTable(m_currentTable->m_table);
+  if (streaming)
+  {
+    // the rows before the first row of the next tile are complete, once the tiles are sorted
+    std::stable_sort(tiles.begin(), tiles.end(), [](const std::pair<unsigned, unsigned> &left, const std::pair<unsigned, unsigned> &right)
+    {
+      return left.first < right.first;
+    });
   }
+  parseTiles(tiles, streaming);
   m_collector.collectTable(m_currentTable->m_table);
   m_currentTable.reset();
 }
@@ -2814,19 +2953,13 @@ void IWAParser::parseDataList(const unsigned id, DataList_t &dataList)
   }
 }
 
-void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStreamPtr_t &input, unsigned endPos, bool oldFormat)
+bool IWAParser::readTileCell(const RVNGInputStreamPtr_t &input, const unsigned endPos, TileCell &cell)
 {
-  IWORKCellType cellType = IWORK_CELL_TYPE_TEXT;
-  optional<unsigned> cellStyleId, formatId, paragraphStyleId;
-  optional<unsigned> commentId, conditionId, formulaId, textId, textFormattedId;
-  optional<string> text;
-  bool numberSet=false;
-
   auto begPos=input->tell();
-  if (begPos+(oldFormat ? 10 : 12)>long(endPos))
+  if (begPos+(cell.m_oldFormat ? 10 : 12)>long(endPos))
   {
-    ETONYEK_DEBUG_MSG(("IWAParser::parseTileDefinition: the zone seems too short\n"));
-    return;
+    ETONYEK_DEBUG_MSG(("IWAParser::readTileCell: the zone seems too short\n"));
+    return false;
   }
   // 1. Read the cell record
   // NOTE: The structure of the record is still not completely understood,
@@ -2841,63 +2974,63 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     case 2:
     case 8: // nan
     case 10: // devise
-      cellType=IWORK_CELL_TYPE_NUMBER;
+      cell.m_type=IWORK_CELL_TYPE_NUMBER;
       break;
     case 7: // duration
-      cellType=IWORK_CELL_TYPE_DURATION;
+      cell.m_type=IWORK_CELL_TYPE_DURATION;
       break;
     case 0: // empty (ok)
     case 3: // text (ok)
     case 9: // text zone
       break;
     case 5:
-      cellType=IWORK_CELL_TYPE_DATE_TIME;
+      cell.m_type=IWORK_CELL_TYPE_DATE_TIME;
       break;
     case 6: // other: bool, button, menu
-      cellType=IWORK_CELL_TYPE_BOOL;
+      cell.m_type=IWORK_CELL_TYPE_BOOL;
       break;
     default:
-      ETONYEK_DEBUG_MSG(("IWAParser::parseTileDefinition: unknown type %d\n", int(type)));
+      ETONYEK_DEBUG_MSG(("IWAParser::readTileCell: unknown type %d\n", int(type)));
       break;
     }
-    if (oldFormat)
+    if (cell.m_oldFormat)
     {
       // 2,3: ?
       input->seek((long) begPos + 4, librevenge::RVNG_SEEK_SET);
       const unsigned flags = readU16(input);
       input->seek(6, librevenge::RVNG_SEEK_CUR);
       if (flags & 0x2) // cell style
-        cellStyleId = readU32(input);
+        cell.m_cellStyleId = readU32(input);
       if (flags & 0x80)
-        paragraphStyleId=readU32(input);
+        cell.m_paragraphStyleId=readU32(input);
       if (flags & 0x800) // condition
-        conditionId=readU32(input);
+        cell.m_conditionId=readU32(input);
       if (flags & 0x400) // condition 2
         readU32(input);
       if (flags & 0x4)   // format
-        formatId=readU32(input);
+        cell.m_formatId=readU32(input);
       if (flags & 0x8) // formula
-        formulaId = readU32(input);
+        cell.m_formulaId = readU32(input);
       if (flags & 0x1000) // comment
-        commentId=readU32(input);
+        cell.m_commentId=readU32(input);
       if (flags & 0x10) // simple text
-        textId = readU32(input);
+        cell.m_textId = readU32(input);
       if (flags & 0x20) // number or duration(in second)
       {
         std::stringstream s;
         s << std::setprecision(12) << readDouble(input);
-        text=s.str();
-        numberSet=true;
+        cell.m_text=s.str();
+        cell.m_numberSet=true;
       }
       if (flags & 0x40) // date
       {
         std::stringstream s;
         s << std::setprecision(12) << readDouble(input);
-        text=s.str();
-        numberSet=true;
+        cell.m_text=s.str();
+        cell.m_numberSet=true;
       }
       if (flags & 0x200) // formatted text
-        textFormattedId = readU32(input);
+        cell.m_textFormattedId = readU32(input);
     }
     else
     {
@@ -2927,37 +3060,37 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
         }
         std::stringstream s;
         s << std::setprecision(12) << mantissa *std::pow(10, (exponent-12352)/2); // 3040 mean 0
-        text=s.str();
-        numberSet=true;
+        cell.m_text=s.str();
+        cell.m_numberSet=true;
       }
       if (flags & 2)   // bool
       {
         std::stringstream s;
         s << readDouble(input);
-        text=s.str();
-        numberSet=true;
+        cell.m_text=s.str();
+        cell.m_numberSet=true;
       }
       if (flags & 4)   // date
       {
         std::stringstream s;
         s << std::setprecision(12) << readDouble(input);
-        text=s.str();
-        numberSet=true;
+        cell.m_text=s.str();
+        cell.m_numberSet=true;
       }
       if (flags & 8)
-        textId = readU32(input);
+        cell.m_textId = readU32(input);
       if (flags & 0x10)
-        textFormattedId=readU32(input);
+        cell.m_textFormattedId=readU32(input);
       if (flags & 0x20) // cell style
-        cellStyleId = readU32(input);
+        cell.m_cellStyleId = readU32(input);
       if (flags & 0x40) // cell paragraph style
-        paragraphStyleId=readU32(input);
+        cell.m_paragraphStyleId=readU32(input);
       if (flags & 0x80) // conditional
-        conditionId=readU32(input);
+        cell.m_conditionId=readU32(input);
       if (flags & 0x100) // conditional(unknown)
         input->seek(4, librevenge::RVNG_SEEK_CUR);
       if (flags & 0x200)
-        formulaId = readU32(input);
+        cell.m_formulaId = readU32(input);
       if (flags & 0x400) // button menu
         input->seek(4, librevenge::RVNG_SEEK_CUR);
       if (flags & 0x800) // unknown: check size
@@ -2969,24 +3102,24 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
         switch (resType)
         {
         case 1:
-          cellType=IWORK_CELL_TYPE_NUMBER;
+          cell.m_type=IWORK_CELL_TYPE_NUMBER;
           break;
         case 2: // devise(changeme)
-          cellType=IWORK_CELL_TYPE_NUMBER;
+          cell.m_type=IWORK_CELL_TYPE_NUMBER;
           break;
         case 3:
-          cellType=IWORK_CELL_TYPE_DATE_TIME;
+          cell.m_type=IWORK_CELL_TYPE_DATE_TIME;
           break;
         case 4:
-          cellType=IWORK_CELL_TYPE_DURATION;
+          cell.m_type=IWORK_CELL_TYPE_DURATION;
           break;
         case 5:
-          cellType=IWORK_CELL_TYPE_TEXT;
+          cell.m_type=IWORK_CELL_TYPE_TEXT;
           break;
         case 6: // other
           break;
         default:
-          ETONYEK_DEBUG_MSG(("IWAParser::parseTileDefinition[new]: unknown type %d\n", int(resType)));
+          ETONYEK_DEBUG_MSG(("IWAParser::readTileCell[new]: unknown type %d\n", int(resType)));
           break;
         }
       }
@@ -2998,10 +3131,10 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
         // checkme, unclear which format id we need to choose when resType=2 or 6
         if (w+1!=resType)
           continue;
-        formatId=id;
+        cell.m_formatId=id;
       }
       if (flags & 0x80000)
-        commentId=readU32(input);
+        cell.m_commentId=readU32(input);
     }
   }
   catch (...)
@@ -3009,10 +3142,20 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     // ignore failure to read the last record
   }
 
+  return true;
+}
+
+void IWAParser::insertTileCell(const TileCell &cell)
+{
+  const unsigned row=cell.m_row;
+  const unsigned column=cell.m_column;
+  IWORKCellType cellType=cell.m_type;
+  optional<string> text=cell.m_text;
+
   IWORKFormulaPtr_t formula;
-  if (bool(formulaId))
+  if (bool(cell.m_formulaId))
   {
-    auto const formulaIt = m_currentTable->m_formulaList.find(get(formulaId));
+    auto const formulaIt = m_currentTable->m_formulaList.find(get(cell.m_formulaId));
     if (formulaIt !=m_currentTable->m_formulaList.end())
     {
       if (auto ref = boost::get<IWORKFormulaPtr_t>(&formulaIt->second))
@@ -3020,15 +3163,15 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     }
     else
     {
-      ETONYEK_DEBUG_MSG(("IWAParser::parseTileDefinition: can not find formula %d\n", int(get(formulaId))));
+      ETONYEK_DEBUG_MSG(("IWAParser::insertTileCell: can not find formula %d\n", int(get(cell.m_formulaId))));
     }
   }
-  if (numberSet && cellType == IWORK_CELL_TYPE_TEXT)
+  if (cell.m_numberSet && cellType == IWORK_CELL_TYPE_TEXT)
     cellType = IWORK_CELL_TYPE_NUMBER;
   bool textSet=false;
-  if (bool(textId))
+  if (bool(cell.m_textId))
   {
-    const DataList_t::const_iterator listIt = m_currentTable->m_simpleTextList.find(get(textId));
+    const DataList_t::const_iterator listIt = m_currentTable->m_simpleTextList.find(get(cell.m_textId));
     if (listIt != m_currentTable->m_simpleTextList.end())
     {
       if (const string *const s = boost::get<string>(&listIt->second))
@@ -3040,13 +3183,13 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     }
     else
     {
-      ETONYEK_DEBUG_MSG(("IWAParser::parseTileDefinition[new]: can not find text %d\n", int(get(textId))));
+      ETONYEK_DEBUG_MSG(("IWAParser::insertTileCell[new]: can not find text %d\n", int(get(cell.m_textId))));
     }
   }
   optional<unsigned> textRef;
-  if (bool(textFormattedId))
+  if (bool(cell.m_textFormattedId))
   {
-    const DataList_t::const_iterator listIt = m_currentTable->m_formattedTextList.find(get(textFormattedId));
+    const DataList_t::const_iterator listIt = m_currentTable->m_formattedTextList.find(get(cell.m_textFormattedId));
     if (listIt != m_currentTable->m_formattedTextList.end())
     {
       if (const unsigned *const ref = boost::get<unsigned>(&listIt->second))
@@ -3058,14 +3201,14 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     }
     else
     {
-      ETONYEK_DEBUG_MSG(("IWAParser::parseTileDefinition[new]: can not find formatted text %d\n", int(get(textFormattedId))));
+      ETONYEK_DEBUG_MSG(("IWAParser::insertTileCell[new]: can not find formatted text %d\n", int(get(cell.m_textFormattedId))));
     }
   }
 
   IWORKStylePtr_t cellStyle;
-  if (bool(cellStyleId))
+  if (bool(cell.m_cellStyleId))
   {
-    const DataList_t::const_iterator listIt = m_currentTable->m_cellStyleList.find(get(cellStyleId));
+    const DataList_t::const_iterator listIt = m_currentTable->m_cellStyleList.find(get(cell.m_cellStyleId));
     if (listIt != m_currentTable->m_cellStyleList.end())
     {
       if (const unsigned *const ref = boost::get<unsigned>(&listIt->second))
@@ -3073,9 +3216,9 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     }
   }
   IWORKStylePtr_t paragraphStyle;
-  if (bool(paragraphStyleId))
+  if (bool(cell.m_paragraphStyleId))
   {
-    const DataList_t::const_iterator listIt = m_currentTable->m_cellStyleList.find(paragraphStyleId.get());
+    const DataList_t::const_iterator listIt = m_currentTable->m_cellStyleList.find(cell.m_paragraphStyleId.get());
     if (listIt != m_currentTable->m_cellStyleList.end())
     {
       if (const unsigned *const ref = boost::get<unsigned>(&listIt->second))
@@ -3083,10 +3226,10 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     }
   }
   optional<Format> format;
-  if (bool(formatId))
+  if (bool(cell.m_formatId))
   {
-    auto const &formatList=oldFormat ? m_currentTable->m_formatList : m_currentTable->m_newFormatList;
-    auto const formatIt=formatList.find(get(formatId));
+    auto const &formatList=cell.m_oldFormat ? m_currentTable->m_formatList : m_currentTable->m_newFormatList;
+    auto const formatIt=formatList.find(get(cell.m_formatId));
     if (formatIt != formatList.end())
     {
       if (auto ref = boost::get<Format>(&formatIt->second))
@@ -3098,7 +3241,7 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     }
     else
     {
-      ETONYEK_DEBUG_MSG(("IWAParser::parseTileDefinition: can not find format %d\n", int(get(formatId))));
+      ETONYEK_DEBUG_MSG(("IWAParser::insertTileCell: can not find format %d\n", int(get(cell.m_formatId))));
     }
   }
   IWORKPropertyMap props;
@@ -3108,7 +3251,7 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     if (get(format).m_type)
     {
       auto type=get(get(format).m_type);
-      if (!numberSet || (type!=IWORK_CELL_TYPE_TEXT && type!=IWORK_CELL_TYPE_NUMBER)) cellType=type;
+      if (!cell.m_numberSet || (type!=IWORK_CELL_TYPE_TEXT && type!=IWORK_CELL_TYPE_NUMBER)) cellType=type;
     }
     addPropsToCellStyle=true;
     if (cellType==IWORK_CELL_TYPE_DATE_TIME && boost::get<IWORKDateTimeFormat>(&get(format).m_format))
@@ -3146,14 +3289,14 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     addPropsToCellStyle=true;
     props.put<property::SFTCellStylePropertyParagraphStyle>(paragraphStyle);
   }
-  /* TODO: when librevenge will allow to define cell styles, check if conditionId is defined*/
+  /* TODO: when librevenge will allow to define cell styles, check if cell.m_conditionId is defined*/
   if (addPropsToCellStyle)
     cellStyle.reset(new IWORKStyle(props, none, cellStyle));
   optional<IWORKDateTimeData> dateTime;
   m_currentTable->m_table->insertCell(column, row, text, m_currentText, dateTime, 1, 1, formula, unsigned(row*256+column), cellStyle, cellType);
-  if (bool(commentId))
+  if (bool(cell.m_commentId))
   {
-    auto const commentIt = m_currentTable->m_commentList.find(get(commentId));
+    auto const commentIt = m_currentTable->m_commentList.find(get(cell.m_commentId));
     if (commentIt !=m_currentTable->m_commentList.end())
     {
       auto currentText=m_currentText;
@@ -3166,7 +3309,7 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
     }
     else
     {
-      ETONYEK_DEBUG_MSG(("IWAParser::parseTileDefinition[new]: can not find comment %d\n", get(commentId)));
+      ETONYEK_DEBUG_MSG(("IWAParser::insertTileCell[new]: can not find comment %d\n", get(cell.m_commentId)));
     }
   }
 
@@ -3174,25 +3317,102 @@ void IWAParser::parseTileDefinition(unsigned row, unsigned column, RVNGInputStre
 
 }
 
+/** Parse the tiles of the current table.
+  *
+  * @arg[in] tiles the first row and the reference of each tile
+  * @arg[in] streaming flush the rows of the table after each tile
+  */
+void IWAParser::parseTiles(const std::vector<std::pair<unsigned, unsigned> > &tiles, const bool streaming)
+{
+  if (!(m_options & EtonyekDocument::OPTION_PARALLEL_TABLES) || (tiles.size() < 2))
+  {
+    for (auto it = tiles.begin(); it != tiles.end(); ++it)
+    {
+      parseTile(it->second, it->first);
+      if (streaming)
+      {
+        releaseObject(it->second);
+        m_currentTable->m_table->flushRows(it + 1 != tiles.end() ? (it + 1)->first : m_currentTable->m_rows);
+      }
+    }
+    return;
+  }
+
+  // the cell records of a few tiles are read in parallel, then the
+  // cells are inserted in order by this thread
+  IWORKThreadPool pool;
+  const std::size_t roundSize = 2 * pool.size();
+  for (std::size_t begin = 0; begin < tiles.size(); begin += roundSize)
+  {
+    const std::size_t end = std::min(begin + roundSize, tiles.size());
+    std::vector<IWAMessage> messages(end - begin);
+    std::vector<std::vector<TileCell> > cells(end - begin);
+    std::vector<std::exception_ptr> errors(end - begin);
+    for (std::size_t i = 0; i != messages.size(); ++i)
+    {
+      const ObjectMessage msg(*this, tiles[begin + i].second, IWAObjectType::Tile);
+      if (!msg)
+        continue;
+      // a copy does not share the parsed fields, so it can be read by another thread
+      messages[i] = get(msg);
+      const unsigned decalY = tiles[begin + i].first;
+      const unsigned rowCount = m_currentTable->m_rows;
+      pool.post([&messages, &cells, &errors, i, decalY, rowCount]()
+      {
+        try
+        {
+          readTile(messages[i], decalY, rowCount, cells[i]);
+        }
+        catch (...)
+        {
+          errors[i] = std::current_exception();
+        }
+      });
+    }
+    pool.wait();
+
+    for (std::size_t i = 0; i != cells.size(); ++i)
+    {
+      if (errors[i])
+        std::rethrow_exception(errors[i]);
+      for (const auto &cell : cells[i])
+        insertTileCell(cell);
+      if (streaming)
+      {
+        releaseObject(tiles[begin + i].second);
+        m_currentTable->m_table->flushRows(begin + i + 1 != tiles.size() ? tiles[begin + i + 1].first : m_currentTable->m_rows);
+      }
+    }
+  }
+}
+
 void IWAParser::parseTile(const unsigned id, const unsigned decalY)
 {
   const ObjectMessage msg(*this, id, IWAObjectType::Tile);
   if (!msg)
     return;
 
+  std::vector<TileCell> cells;
+  readTile(get(msg), decalY, m_currentTable->m_rows, cells);
+  for (const auto &cell : cells)
+    insertTileCell(cell);
+}
+
+void IWAParser::readTile(const IWAMessage &msg, const unsigned decalY, const unsigned rowCount, std::vector<TileCell> &cells)
+{
   // rows must be fed to the collector in order
   typedef map<unsigned, const IWAMessage *> Rows_t;
   Rows_t rows;
 
   // save rows
-  for (const auto &it : get(msg).message(5))
+  for (const auto &it : msg.message(5))
   {
     if (!it.uint32(1) || !it.bytes(3) || !it.bytes(4))
       continue;
     const unsigned row = get(it.uint32(1))+decalY;
-    if (row >= m_currentTable->m_rows)
+    if (row >= rowCount)
     {
-      ETONYEK_DEBUG_MSG(("IWAParser::parseTile: invalid row: %u\n", row));
+      ETONYEK_DEBUG_MSG(("IWAParser::readTile: invalid row: %u\n", row));
       continue;
     }
     rows[row] = &it;
@@ -3226,7 +3446,7 @@ void IWAParser::parseTile(const unsigned id, const unsigned decalY)
 
       if (length >= factor*0xffff)
       {
-        ETONYEK_DEBUG_MSG(("IWAParser::parseTile: invalid column data length: %u\n", length));
+        ETONYEK_DEBUG_MSG(("IWAParser::readTile: invalid column data length: %u\n", length));
         length = factor*0xffff;
       }
 
@@ -3243,7 +3463,9 @@ void IWAParser::parseTile(const unsigned id, const unsigned decalY)
       ++offIt;
       unsigned endPos=offIt==offsets.end() ? length : offIt->second;
       input->seek((long) begPos, librevenge::RVNG_SEEK_SET);
-      parseTileDefinition(it.first, column, input, endPos, !useNewFormat);
+      TileCell cell(it.first, column, !useNewFormat);
+      if (readTileCell(input, endPos, cell))
+        cells.push_back(cell);
     }
   }
 }
@@ -3308,11 +3530,11 @@ void IWAParser::parseTableGridLine(unsigned id, IWORKGridLineMap_t &gridLine)
     return;
   }
   auto pos1=get(get(msg).uint32(1));
-  const deque<IWAMessage> &lines = get(msg).message(2).repeated();
+  const auto &lines = get(msg).message(2).repeated();
   if (gridLine.find(pos1)==gridLine.end())
     gridLine.insert(IWORKGridLineMap_t::value_type(pos1,IWORKGridLine_t(0,4096,nullptr)));
   auto &flatSegments=gridLine.find(pos1)->second;
-  for (auto it : lines)
+  for (const auto &it : lines)
   {
     if (!it.uint32(1) || !it.uint32(2))
     {
@@ -3515,12 +3737,12 @@ bool IWAParser::parseFormula(const IWAMessage &msg, IWORKFormulaPtr_t &formula)
     ETONYEK_DEBUG_MSG(("IWAParser::parseFormula: can not find the token table\n"));
     return false;
   }
-  const deque<IWAMessage> &tokens = get(msg.message(1)).message(1).repeated();
+  const auto &tokens = get(msg.message(1)).message(1).repeated();
 
   typedef std::vector<IWORKFormula::Token> Formula;
   std::vector<Formula> stack;
   bool ok=true;
-  for (auto it : tokens)
+  for (const auto &it : tokens)
   {
     auto type=it.uint32(1).optional();
     if (!type)
@@ -12,10 +12,14 @@
 
 #include <deque>
 #include <functional>
+#include <list>
 #include <map>
 #include <memory>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <boost/optional.hpp>
 #include <boost/variant.hpp>
@@ -59,11 +63,24 @@ public:
   {
   }
 
+  /// Set optional features, a combination of EtonyekDocument::Option values.
+  void setOptions(unsigned options);
+
+  /** Use an object index that has already been parsed.
+    *
+    * This avoids parsing it again if it has been needed for detection.
+    */
+  void setObjectIndex(const std::shared_ptr<IWAObjectIndex> &index);
+
   bool parse();
 
 protected:
   class ObjectMessage
   {
+    // -Weffc++
+    ObjectMessage(const ObjectMessage &);
+    ObjectMessage &operator=(const ObjectMessage &);
+
   public:
     ObjectMessage(IWAParser &parser, unsigned id, unsigned type = 0);
     ~ObjectMessage();
@@ -80,7 +97,7 @@ protected:
 
   private:
     IWAParser &m_parser;
-    boost::optional<IWAMessage> m_message;
+    const IWAMessage *m_message;
     const unsigned m_id;
     unsigned m_type;
   };
@@ -130,10 +147,21 @@ protected:
   const IWORKStylePtr_t queryStyle(unsigned id, StyleMap_t &styleMap, StyleParseFun_t parse) const;
   boost::optional<unsigned> getObjectType(unsigned id) const;
 
+  unsigned getOptions() const;
+  const std::shared_ptr<IWAObjectIndex> &getObjectIndex() const;
+
+  /** Start with the styles another parser has already parsed.
+    *
+    * The styles themselves are shared, so neither parser may change
+    * them; styles parsed later are only added to this parser's maps.
+    */
+  void shareStyles(const IWAParser &other);
+
 protected:
   IWORKFormatNameMap m_formatNameMap;
   IWORKLanguageManager m_langManager;
   IWORKTableNameMapPtr_t m_tableNameMap;
+  bool m_tableNamesOnWrite; //!< the table names are made unique when the tables are written
   std::shared_ptr<IWORKText> m_currentText;
 
 private:
@@ -197,12 +225,56 @@ private:
     DataList_t m_commentList;
   };
 
+  /** A cell record of a tile.
+    *
+    * It is read without the parser, so the tiles of a table can be read
+    * in parallel. The ids refer to the data lists of the table.
+    */
+  struct TileCell
+  {
+    TileCell(unsigned row, unsigned column, bool oldFormat);
+
+    unsigned m_row;
+    unsigned m_column;
+    bool m_oldFormat;
+    IWORKCellType m_type;
+    boost::optional<std::string> m_text;
+    bool m_numberSet;
+    boost::optional<unsigned> m_cellStyleId;
+    boost::optional<unsigned> m_formatId;
+    boost::optional<unsigned> m_paragraphStyleId;
+    boost::optional<unsigned> m_commentId;
+    boost::optional<unsigned> m_conditionId;
+    boost::optional<unsigned> m_formulaId;
+    boost::optional<unsigned> m_textId;
+    boost::optional<unsigned> m_textFormattedId;
+  };
+
 private:
   virtual bool parseDocument() = 0;
 
 private:
-  void queryObject(unsigned id, unsigned &type, boost::optional<IWAMessage> &msg) const;
-  const RVNGInputStreamPtr_t queryFile(unsigned id) const;
+  /// An object from the index, parsed once and shared by all its uses.
+  struct ResolvedObject
+  {
+    ResolvedObject();
+
+    unsigned m_type;
+    boost::optional<IWAMessage> m_message;
+    std::list<unsigned>::iterator m_lruPos; //!< position in m_objectLru
+  };
+
+  const ResolvedObject &resolveObject(unsigned id) const;
+  /// Drop the cached copy of an object that is not needed anymore.
+  void releaseObject(unsigned id);
+  /** Get a file as the data of a media.
+    *
+    * With OPTION_MEDIA_REFERENCES, the file is not opened; just its
+    * path is kept.
+    *
+    * @returns nullptr if the file does not exist
+    */
+  IWORKDataPtr_t queryData(unsigned id) const;
 
   void parseObjectIndex();
 
@@ -222,8 +294,11 @@ private:
 
   void parseTabularModel(unsigned id);
   void parseDataList(unsigned id, DataList_t &dataList);
+  void parseTiles(const std::vector<std::pair<unsigned, unsigned> > &tiles, bool streaming);
   void parseTile(unsigned id, unsigned decalY);
-  void parseTileDefinition(unsigned row, unsigned col, RVNGInputStreamPtr_t &input, unsigned endPos, bool oldFormat);
+  static void readTile(const IWAMessage &msg, unsigned decalY, unsigned rowCount, std::vector<TileCell> &cells);
+  static bool readTileCell(const RVNGInputStreamPtr_t &input, unsigned endPos, TileCell &cell);
+  void insertTileCell(const TileCell &cell);
   void parseTableHeaders(unsigned id, TableHeader &header);
   void parseTableGridLines(unsigned id, IWORKGridLineMap_t (&gridLines)[4]);
   void parseTableGridLine(unsigned id, IWORKGridLineMap_t &gridLines);
@@ -247,10 +322,14 @@ private:
 
 private:
   IWORKCollector &m_collector;
+  unsigned m_options;
 
-  IWAObjectIndex m_index;
+  std::shared_ptr<IWAObjectIndex> m_index;
+  bool m_indexParsed;
 
-  std::deque<unsigned> m_visited;
+  mutable std::unordered_map<unsigned, ResolvedObject> m_objectCache;
+  mutable std::list<unsigned> m_objectLru; //!< the cached objects, the most recently used first
+  std::unordered_set<unsigned> m_visited;
 
   mutable StyleMap_t m_charStyles;
   mutable StyleMap_t m_dropCapStyles;
@@ -10,7 +10,9 @@
 #include "IWAReader.h"
 
 #include <cassert>
+#include <cstring>
 #include <memory>
+#include <stdexcept>
 
 #include "IWAMessage.h"
 #include "IWORKMemoryStream.h"
@@ -23,83 +25,138 @@ namespace
 
 struct ParseError {};
 
+uint64_t readVar(IWAReader::Input &input)
+{
+  uint64_t value = 0;
+  for (unsigned shift = 0;; shift += 7)
+  {
+    if (input.m_pos == input.m_end)
+      throw EndOfStreamException();
+    const unsigned char c = *input.m_pos++;
+    const uint64_t bits = c & 0x7f;
+    if (shift < 64)
+    {
+      if ((shift > 57) && (bits >> (64 - shift)) != 0)
+        throw std::range_error("Number too big");
+      value |= bits << shift;
+    }
+    else if (bits != 0)
+    {
+      throw std::range_error("Number too big");
+    }
+    if (!(c & 0x80))
+      return value;
+  }
+}
+
+const unsigned char *readFixed(IWAReader::Input &input, const std::size_t length)
+{
+  if (static_cast<std::size_t>(input.m_end - input.m_pos) < length)
+    throw EndOfStreamException();
+  const unsigned char *const bytes = input.m_pos;
+  input.m_pos += length;
+  return bytes;
+}
+
 }
 
 namespace IWAReader
 {
 
-uint32_t UInt32::read(const RVNGInputStreamPtr_t &input, unsigned long)
+Input::Input(const IWABufferPtr_t &buffer, const std::size_t begin, const std::size_t end)
+  : m_buffer(buffer)
+  , m_pos(buffer->data() + begin)
+  , m_end(buffer->data() + end)
+{
+  assert(begin <= end);
+  assert(end <= buffer->size());
+}
+
+uint32_t UInt32::read(Input &input, unsigned long)
 {
-  return uint32_t(readUVar(input));
+  return uint32_t(readVar(input));
 }
 
-uint64_t UInt64::read(const RVNGInputStreamPtr_t &input, unsigned long)
+uint64_t UInt64::read(Input &input, unsigned long)
 {
-  return readUVar(input);
+  return readVar(input);
 }
 
-int64_t SInt64::read(const RVNGInputStreamPtr_t &input, unsigned long)
+int64_t SInt64::read(Input &input, unsigned long)
 {
-  return readSVar(input);
+  const uint64_t encoded = readVar(input);
+  // zigzag encoding: the sign is in the lowest bit
+  return (encoded & 1) ? -int64_t(encoded >> 1) - 1 : int64_t(encoded >> 1);
 }
 
-int32_t SInt32::read(const RVNGInputStreamPtr_t &input, unsigned long)
+int32_t SInt32::read(Input &input, unsigned long)
 {
-  return int32_t(readSVar(input));
+  return int32_t(SInt64::read(input, 0));
 }
 
-bool Bool::read(const RVNGInputStreamPtr_t &input, unsigned long)
+bool Bool::read(Input &input, unsigned long)
 {
-  return bool(readUVar(input));
+  return bool(readVar(input));
 }
 
-uint64_t Fixed64::read(const RVNGInputStreamPtr_t &input, unsigned long)
+uint64_t Fixed64::read(Input &input, unsigned long)
 {
-  return readU64(input);
+  const unsigned char *const p = readFixed(input, 8);
+  return (uint64_t)p[0]|((uint64_t)p[1]<<8)|((uint64_t)p[2]<<16)|((uint64_t)p[3]<<24)|((uint64_t)p[4]<<32)|((uint64_t)p[5]<<40)|((uint64_t)p[6]<<48)|((uint64_t)p[7]<<56);
 }
 
-double Double::read(const RVNGInputStreamPtr_t &input, unsigned long)
+double Double::read(Input &input, unsigned long)
 {
-  return readDouble(input);
+  const uint64_t value = Fixed64::read(input, 0);
+  double d;
+  std::memcpy(&d, &value, sizeof(d));
+  return d;
 }
 
-std::string String::read(const RVNGInputStreamPtr_t &input, const unsigned long length)
+std::string String::read(Input &input, const unsigned long length)
 {
   assert(length != 0);
 
-  unsigned long readBytes(0);
-  const unsigned char *const bytes = input->read(length, readBytes);
-  if (readBytes < length)
+  if (static_cast<unsigned long>(input.m_end - input.m_pos) < length)
     throw ParseError();
+  const unsigned char *const bytes = readFixed(input, length);
   return std::string(reinterpret_cast<const char *>(bytes), std::size_t(length));
 }
 
-const RVNGInputStreamPtr_t Bytes::read(const RVNGInputStreamPtr_t &input, const unsigned long length)
+const RVNGInputStreamPtr_t Bytes::read(Input &input, const unsigned long length)
 {
   assert(length != 0);
 
-  unsigned long readBytes(0);
-  const unsigned char *const bytes = input->read(length, readBytes);
-  if (readBytes < length)
+  if (static_cast<unsigned long>(input.m_end - input.m_pos) < length)
     throw ParseError();
-  return std::make_shared<IWORKMemoryStream>(bytes, std::size_t(length));
+  const unsigned char *const bytes = readFixed(input, length);
+  return std::make_shared<IWORKMemoryStream>(bytes, unsigned(length));
 }
 
-IWAMessage Message::read(const RVNGInputStreamPtr_t &input, const unsigned long length)
+IWAMessage Message::read(Input &input, const unsigned long length)
 {
   assert(length != 0);
 
-  return IWAMessage(input, length);
+  // the message is just a view into the same buffer
+  const std::size_t begin = std::size_t(input.m_pos - input.m_buffer->data());
+  const std::size_t available = std::size_t(input.m_end - input.m_pos);
+  const std::size_t end = begin + (length < available ? length : available);
+  input.m_pos = input.m_buffer->data() + end;
+  return IWAMessage(input.m_buffer, begin, end);
 }
 
-uint32_t Fixed32::read(const RVNGInputStreamPtr_t &input, unsigned long)
+uint32_t Fixed32::read(Input &input, unsigned long)
 {
-  return readU32(input);
+  const unsigned char *const p = readFixed(input, 4);
+  return (uint32_t)p[0]|((uint32_t)p[1]<<8)|((uint32_t)p[2]<<16)|((uint32_t)p[3]<<24);
 }
 
-float Float::read(const RVNGInputStreamPtr_t &input, unsigned long)
+float Float::read(Input &input, unsigned long)
 {
-  return readFloat(input);
+  const uint32_t value = Fixed32::read(input, 0);
+  float f;
+  std::memcpy(&f, &value, sizeof(f));
+  return f;
 }
 
 }
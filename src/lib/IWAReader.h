@@ -10,7 +10,10 @@
 #ifndef IWAREADER_H_INCLUDED
 #define IWAREADER_H_INCLUDED
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "libetonyek_utils.h"
 
@@ -19,67 +22,83 @@ namespace libetonyek
 
 class IWAMessage;
 
+typedef std::shared_ptr<const std::vector<unsigned char>> IWABufferPtr_t;
+
 namespace IWAReader
 {
 
+/** A read position in a shared buffer.
+  *
+  * The readers advance m_pos. They throw EndOfStreamException if they
+  * would need to read past m_end.
+  */
+struct Input
+{
+  Input(const IWABufferPtr_t &buffer, std::size_t begin, std::size_t end);
+
+  const IWABufferPtr_t &m_buffer;
+  const unsigned char *m_pos;
+  const unsigned char *const m_end;
+};
+
 struct UInt32
 {
-  static uint32_t read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static uint32_t read(Input &input, unsigned long length);
 };
 
 struct UInt64
 {
-  static uint64_t read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static uint64_t read(Input &input, unsigned long length);
 };
 
 struct SInt32
 {
-  static int32_t read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static int32_t read(Input &input, unsigned long length);
 };
 
 struct SInt64
 {
-  static int64_t read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static int64_t read(Input &input, unsigned long length);
 };
 
 struct Bool
 {
-  static bool read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static bool read(Input &input, unsigned long length);
 };
 
 struct Fixed64
 {
-  static uint64_t read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static uint64_t read(Input &input, unsigned long length);
 };
 
 struct Double
 {
-  static double read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static double read(Input &input, unsigned long length);
 };
 
 struct String
 {
-  static std::string read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static std::string read(Input &input, unsigned long length);
 };
 
 struct Bytes
 {
-  static const RVNGInputStreamPtr_t read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static const RVNGInputStreamPtr_t read(Input &input, unsigned long length);
 };
 
 struct Message
 {
-  static IWAMessage read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static IWAMessage read(Input &input, unsigned long length);
 };
 
 struct Fixed32
 {
-  static uint32_t read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static uint32_t read(Input &input, unsigned long length);
 };
 
 struct Float
 {
-  static float read(const RVNGInputStreamPtr_t &input, unsigned long length);
+  static float read(Input &input, unsigned long length);
 };
 
 }
@@ -11,12 +11,16 @@
 
 #include <algorithm>
 #include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <deque>
 #include <limits>
 #include <memory>
 #include <utility>
 #include <vector>
 
 #include "IWORKMemoryStream.h"
+#include "IWORKProfiler.h"
 
 using std::vector;
 
@@ -30,145 +34,551 @@ struct CompressionException
 {
 };
 
-struct Data
-{
-  explicit Data(vector<unsigned char> &data);
+/// Number of bytes the wide copies are allowed to write past the end of a run.
+const size_t copySlack = 16;
 
-  vector<unsigned char> &m_data; //! Uncompressed data.
-  size_t m_blockStart; //! A position in m_data where data from the current block start.
-};
+/// The greatest expansion a valid snappy block can produce: a 3-byte far ref yields 64 bytes.
+const unsigned long maxExpansion = 22;
 
-Data::Data(vector<unsigned char> &data)
-  : m_data(data)
-  , m_blockStart(m_data.size())
+inline void copy8(unsigned char *const dest, const unsigned char *const src)
 {
+  // go through a temporary, so overlapping ranges are handled correctly
+  unsigned char tmp[8];
+  std::memcpy(tmp, src, 8);
+  std::memcpy(dest, tmp, 8);
 }
 
-void appendRef(Data &data, const unsigned offset, const unsigned length)
+inline void copy16(unsigned char *const dest, const unsigned char *const src)
 {
-  if (offset == 0)
-    throw CompressionException();
-  if (offset > data.m_data.size() - data.m_blockStart) // we don't have enough uncompressed data in the current block
-    throw CompressionException();
-
-  data.m_data.resize(data.m_data.size() + length);
-  const vector<unsigned char>::iterator end = data.m_data.end();
-  auto dest = data.m_data.end() - vector<unsigned char>::difference_type(length);
-  auto src = dest - vector<unsigned char>::difference_type(offset);
-
-  if (offset >= length)
-  {
-    std::copy(src, src + vector<unsigned char>::difference_type(length), dest);
-  }
-  else // the run is inserted repeatedly
-  {
-    while (size_t(end - dest) >= offset) // as long as the whole run fits
-    {
-      std::copy(src, src + vector<unsigned char>::difference_type(offset), dest);
-      dest += vector<unsigned char>::difference_type(offset);
-    }
-    if (dest != end) // copy the remainder
-      std::copy(src, src + (end - dest), dest);
-  }
+  unsigned char tmp[16];
+  std::memcpy(tmp, src, 16);
+  std::memcpy(dest, tmp, 16);
 }
 
-bool uncompressBlock(const RVNGInputStreamPtr_t &input, const unsigned long length, vector<unsigned char> &uncompressed)
+/** Decoder of a single snappy block.
+  *
+  * It works directly on the compressed bytes and writes into an output
+  * buffer that is pre-sized from the block preamble, with copySlack
+  * bytes of scratch space at the end. Short literals and matches are
+  * copied 16 or 8 bytes at a time, possibly writing into the scratch
+  * space; the output is only grown if the preamble lied about the size.
+  */
+class BlockDecoder
 {
-  Data data(uncompressed);
+public:
+  BlockDecoder(const unsigned char *input, unsigned long length, vector<unsigned char> &output);
+
+  bool decode();
+
+private:
+  bool readVarLength(unsigned long &value);
+  void reserve(size_t length);
+  bool appendLiteral(size_t length);
+  bool appendRef(size_t offset, size_t length);
+
+private:
+  const unsigned char *m_input;
+  const unsigned char *const m_inputEnd;
+  vector<unsigned char> &m_output;
+  const size_t m_blockStart; //! A position in m_output where data from the current block start.
+  size_t m_pos; //! The current end of uncompressed data in m_output.
+};
 
-  const long blockEnd = input->tell() + long(length);
-  const auto uncompressedLength = (unsigned long) readUVar(input);
-  const size_t maxSize = size_t((std::min)(2 * length, uncompressedLength)); // don't want unbounded allocation
-  size_t newSize = data.m_data.size() + maxSize;
-  data.m_data.reserve(newSize);
+BlockDecoder::BlockDecoder(const unsigned char *const input, const unsigned long length, vector<unsigned char> &output)
+  : m_input(input)
+  , m_inputEnd(input + length)
+  , m_output(output)
+  , m_blockStart(output.size())
+  , m_pos(output.size())
+{
+}
 
-  while (!input->isEnd() && (input->tell() < blockEnd))
+bool BlockDecoder::decode()
+{
+  unsigned long uncompressedLength = 0;
+  if (!readVarLength(uncompressedLength))
+    return false;
+  const unsigned long length = (unsigned long)(m_inputEnd - m_input);
+  // don't want unbounded allocation from a broken preamble
+  reserve(size_t((std::min)(uncompressedLength, maxExpansion * length)));
+
+  bool ok = true;
+  while (ok && (m_input < m_inputEnd))
   {
-    const unsigned char c = readU8(input);
+    const unsigned char c = *m_input++;
     switch (c & 0x3)
     {
     case 0 : // a run of literals
     {
-      unsigned runLength = 0;
-      if ((c & 0xf0) == 0xf0)
+      size_t runLength = (c >> 2) + 1;
+      if (runLength > 60)
       {
-        const unsigned count = ((c >> 2) & 0x3) + 1;
+        const unsigned count = unsigned(runLength) - 60;
         assert(count > 0);
         assert(count <= 4);
-        runLength = unsigned(readU8(input)) + 1;
-        for (unsigned shift = 8; shift < 8 * count; shift += 8)
+        if (size_t(m_inputEnd - m_input) < count)
         {
-          const unsigned b = readU8(input);
-          runLength += b << shift;
+          ok = false;
+          break;
         }
+        runLength = 0;
+        for (unsigned i = 0; i < count; ++i)
+          runLength |= size_t(m_input[i]) << (8 * i);
+        runLength += 1;
+        m_input += count;
       }
-      else
-      {
-        runLength = (c >> 2) + 1;
-      }
-      assert(runLength > 0);
-      unsigned long bytesRead = 0;
-      const unsigned char *const bytes = input->read(runLength, bytesRead);
-      if (bytesRead != runLength)
-        return false;
-      data.m_data.insert(data.m_data.end(), bytes, bytes + runLength);
+      ok = appendLiteral(runLength);
       break;
     }
     case 1 : // near ref
     {
-      const unsigned runLength = ((c >> 2) & 0x7) + 4;
-      const unsigned high = c >> 5;
-      const unsigned low = readU8(input);
-      const unsigned offset = (high << 8) | low;
-      appendRef(data, offset, runLength);
+      if (m_input == m_inputEnd)
+      {
+        ok = false;
+        break;
+      }
+      const size_t runLength = ((c >> 2) & 0x7) + 4;
+      const size_t offset = (size_t(c >> 5) << 8) | *m_input++;
+      ok = appendRef(offset, runLength);
       break;
     }
     case 2 : // far ref
     {
-      const unsigned runLength = (c >> 2) + 1;
-      const unsigned low = readU8(input);
-      const unsigned high = readU8(input);
-      const unsigned offset = (high << 8) | low;
-      appendRef(data, offset, runLength);
+      if (m_inputEnd - m_input < 2)
+      {
+        ok = false;
+        break;
+      }
+      const size_t runLength = (c >> 2) + 1;
+      const size_t offset = size_t(m_input[0]) | (size_t(m_input[1]) << 8);
+      m_input += 2;
+      ok = appendRef(offset, runLength);
       break;
     }
     case 3 : // unknown
       ETONYEK_DEBUG_MSG(("uncompressBlock: Found an unexpected mark value 3\n"));
-      return false;
+      ok = false;
+      break;
     default :
       assert(0);
     }
   }
 
+  m_output.resize(m_pos);
+  return ok;
+}
+
+bool BlockDecoder::readVarLength(unsigned long &value)
+{
+  value = 0;
+  for (unsigned shift = 0; m_input < m_inputEnd; shift += 7)
+  {
+    const unsigned char c = *m_input++;
+    if (shift < std::numeric_limits<unsigned long>::digits)
+      value |= (unsigned long)(c & 0x7f) << shift;
+    if (!(c & 0x80))
+      return true;
+  }
+  return false;
+}
+
+void BlockDecoder::reserve(const size_t length)
+{
+  if (m_output.size() < m_pos + length + copySlack)
+    m_output.resize(m_pos + length + copySlack);
+}
+
+bool BlockDecoder::appendLiteral(const size_t length)
+{
+  if (size_t(m_inputEnd - m_input) < length)
+    return false;
+
+  unsigned char *const dest = &m_output[0] + m_pos;
+  if ((length <= 16) && (size_t(m_inputEnd - m_input) >= 16) && (m_output.size() - m_pos >= 16))
+  {
+    copy16(dest, m_input);
+  }
+  else
+  {
+    reserve(length);
+    std::memcpy(&m_output[0] + m_pos, m_input, length);
+  }
+  m_input += length;
+  m_pos += length;
   return true;
 }
 
-RVNGInputStreamPtr_t uncompress(const RVNGInputStreamPtr_t &input)
+bool BlockDecoder::appendRef(const size_t offset, const size_t length)
 {
-  vector<unsigned char> data;
+  if (offset == 0)
+    return false;
+  if (offset > m_pos - m_blockStart) // we don't have enough uncompressed data in the current block
+    return false;
+
+  reserve(length);
 
-  while (!input->isEnd())
+  unsigned char *dest = &m_output[0] + m_pos;
+  const unsigned char *src = dest - offset;
+  m_pos += length;
+
+  if (offset >= 16 && length <= 16)
+  {
+    copy16(dest, src);
+  }
+  else if (offset >= 8)
+  {
+    for (size_t copied = 0; copied < length; copied += 8)
+      copy8(dest + copied, src + copied);
+  }
+  else // the run is inserted repeatedly
+  {
+    // Widen the pattern until it is at least 8 bytes long. Every copy
+    // adds (dest - src) correct bytes, doubling the pattern length.
+    ptrdiff_t remaining = ptrdiff_t(length);
+    while ((remaining > 0) && (dest - src < 8))
+    {
+      copy8(dest, src);
+      remaining -= dest - src;
+      dest += dest - src;
+    }
+    for (; remaining > 0; remaining -= 8, src += 8, dest += 8)
+      copy8(dest, src);
+  }
+  return true;
+}
+
+bool uncompressBlock(const unsigned char *const input, const unsigned long length, vector<unsigned char> &uncompressed)
+{
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_DECOMPRESSION);
+  BlockDecoder decoder(input, length, uncompressed);
+  return decoder.decode();
+}
+
+/** Read @c length bytes from the current position of the input.
+  *
+  * The data are returned directly from the stream's buffer if it is
+  * able to provide them in one go; otherwise they are collected into
+  * @c buffer. On return, @c length holds the number of bytes read.
+  */
+const unsigned char *readBytes(const RVNGInputStreamPtr_t &input, vector<unsigned char> &buffer, unsigned long &length)
+{
+  if (length == 0)
+    return nullptr;
+
+  unsigned long bytesRead = 0;
+  const unsigned char *data = input->read(length, bytesRead);
+  if (bytesRead == length)
+    return data;
+
+  buffer.assign(data, data + bytesRead);
+  while (!input->isEnd() && (buffer.size() < length))
+  {
+    data = input->read(length - buffer.size(), bytesRead);
+    if (bytesRead == 0)
+      break;
+    buffer.insert(buffer.end(), data, data + bytesRead);
+  }
+  length = buffer.size();
+  return buffer.empty() ? nullptr : &buffer[0];
+}
+
+/// Get the content of the input from the current position to the end.
+const unsigned char *readRemaining(const RVNGInputStreamPtr_t &input, vector<unsigned char> &buffer, unsigned long &length)
+{
+  length = getRemainingLength(input);
+  return readBytes(input, buffer, length);
+}
+
+IWABufferPtr_t uncompress(const RVNGInputStreamPtr_t &input)
+{
+  vector<unsigned char> buffer;
+  unsigned long length = 0;
+  const unsigned char *const compressed = readRemaining(input, buffer, length);
+
+  const auto data = std::make_shared<vector<unsigned char>>();
+  unsigned long pos = 0;
+  while (pos < length)
   {
+    if (length - pos < 4)
+      throw EndOfStreamException();
+    // rare, but the blockLength can be greater than 65536, ie. I find 06 00 01 in one file
+    unsigned long blockLength = compressed[pos + 1] | (unsigned long)(compressed[pos + 2]) << 8 | (unsigned long)(compressed[pos + 3]) << 16;
+    pos += 4;
+    blockLength = (std::min)(blockLength, length - pos);
+    if (!uncompressBlock(compressed + pos, blockLength, *data))
+      throw CompressionException();
+    pos += blockLength;
+  }
+
+  return data;
+}
+
+/** A stream that uncompresses chunks only when they are accessed.
+  *
+  * The chunk headers and the uncompressed length of every chunk are
+  * read at construction. The chunks themselves are uncompressed when a
+  * read touches them and the most recently used ones are kept in a
+  * small cache, so seeking over data that are never read is cheap.
+  */
+class OnDemandStream : public librevenge::RVNGInputStream
+{
+  // -Weffc++
+  OnDemandStream(const OnDemandStream &other);
+  OnDemandStream &operator=(const OnDemandStream &other);
+
+  struct Chunk
+  {
+    Chunk(long pos, unsigned long length, long begin, long end);
+
+    long m_pos; //! Start of the compressed data in the input.
+    unsigned long m_length; //! Length of the compressed data.
+    long m_begin; //! Start of the uncompressed data in this stream.
+    long m_end; //! End of the uncompressed data in this stream.
+  };
+
+  typedef std::shared_ptr<const vector<unsigned char>> ChunkData_t;
+
+public:
+  explicit OnDemandStream(const RVNGInputStreamPtr_t &input);
+
+  bool isStructured() override;
+  unsigned subStreamCount() override;
+  const char *subStreamName(unsigned id) override;
+  bool existsSubStream(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamByName(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamById(unsigned id) override;
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override;
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override;
+  long tell() override;
+  bool isEnd() override;
+
+private:
+  std::size_t findChunk(long pos) const;
+  ChunkData_t getChunk(std::size_t index);
+
+private:
+  const RVNGInputStreamPtr_t m_input;
+  vector<Chunk> m_chunks;
+  std::deque<std::pair<std::size_t, ChunkData_t>> m_cache; //! Uncompressed chunks, the most recently used first.
+  vector<unsigned char> m_buffer; //! Data of a read that spans more chunks.
+  long m_length;
+  long m_pos;
+};
+
+/// Number of uncompressed chunks kept in memory by OnDemandStream.
+const std::size_t chunkCacheSize = 8;
+
+OnDemandStream::Chunk::Chunk(const long pos, const unsigned long length, const long begin, const long end)
+  : m_pos(pos)
+  , m_length(length)
+  , m_begin(begin)
+  , m_end(end)
+{
+}
+
+OnDemandStream::OnDemandStream(const RVNGInputStreamPtr_t &input)
+  : m_input(input)
+  , m_chunks()
+  , m_cache()
+  , m_buffer()
+  , m_length(0)
+  , m_pos(0)
+{
+  const auto length = long(getLength(input));
+  long pos = 0;
+  while (pos < length)
+  {
+    if ((length - pos < 4) || (input->seek(pos, librevenge::RVNG_SEEK_SET) != 0))
+      throw EndOfStreamException();
     readU8(input);
     unsigned long blockLength = readU16(input);
-    // rare, but the blockLength can be greater than 65536, ie. I find 06 00 01 in one file
-    blockLength+=65536*readU8(input);
-    if (!uncompressBlock(input, (std::min)(blockLength, getRemainingLength(input)), data))
+    blockLength += 65536 * readU8(input);
+    pos += 4;
+    blockLength = (std::min)(blockLength, (unsigned long)(length - pos));
+    const auto uncompressedLength = (unsigned long) readUVar(input);
+    if ((input->tell() > pos + long(blockLength)) || (uncompressedLength > maxExpansion * blockLength))
       throw CompressionException();
+    m_chunks.push_back(Chunk(pos, blockLength, m_length, m_length + long(uncompressedLength)));
+    m_length += long(uncompressedLength);
+    pos += long(blockLength);
   }
+}
 
-  return std::make_shared<IWORKMemoryStream>(data);
+bool OnDemandStream::isStructured()
+{
+  return false;
+}
+
+unsigned OnDemandStream::subStreamCount()
+{
+  return 0;
+}
+
+const char *OnDemandStream::subStreamName(unsigned)
+{
+  return nullptr;
+}
+
+bool OnDemandStream::existsSubStream(const char *)
+{
+  return false;
+}
+
+librevenge::RVNGInputStream *OnDemandStream::getSubStreamByName(const char *)
+{
+  return nullptr;
+}
+
+librevenge::RVNGInputStream *OnDemandStream::getSubStreamById(unsigned)
+{
+  return nullptr;
+}
+
+const unsigned char *OnDemandStream::read(unsigned long numBytes, unsigned long &numBytesRead) try
+{
+  numBytesRead = 0;
+
+  if ((0 == numBytes) || (m_pos >= m_length))
+    return nullptr;
+  if (numBytes > static_cast<unsigned long>(m_length - m_pos))
+    numBytes = static_cast<unsigned long>(m_length - m_pos);
+
+  std::size_t index = findChunk(m_pos);
+  ChunkData_t data = getChunk(index);
+  if (!data)
+    return nullptr;
+
+  if (m_pos + long(numBytes) <= m_chunks[index].m_end)
+  {
+    // the common case: all the data are in one chunk
+    const unsigned char *const bytes = &(*data)[0] + (m_pos - m_chunks[index].m_begin);
+    m_pos += long(numBytes);
+    numBytesRead = numBytes;
+    return bytes;
+  }
+
+  m_buffer.clear();
+  m_buffer.reserve(numBytes);
+  while (data && (m_buffer.size() < numBytes))
+  {
+    const auto begin = data->begin() + (m_pos - m_chunks[index].m_begin);
+    const auto count = (std::min)(numBytes - m_buffer.size(), (unsigned long)(data->end() - begin));
+    m_buffer.insert(m_buffer.end(), begin, begin + long(count));
+    m_pos += long(count);
+    if ((m_buffer.size() < numBytes) && (++index < m_chunks.size()))
+      data = getChunk(index);
+  }
+  numBytesRead = m_buffer.size();
+  return m_buffer.empty() ? nullptr : &m_buffer[0];
+}
+catch (...)
+{
+  return nullptr;
+}
+
+int OnDemandStream::seek(const long offset, const librevenge::RVNG_SEEK_TYPE seekType)
+{
+  long pos = 0;
+  switch (seekType)
+  {
+  case librevenge::RVNG_SEEK_SET :
+    pos = offset;
+    break;
+  case librevenge::RVNG_SEEK_CUR :
+    pos = offset + m_pos;
+    break;
+  case librevenge::RVNG_SEEK_END :
+    pos = offset + m_length;
+    break;
+  default :
+    return -1;
+  }
+
+  if ((pos < 0) || (pos > m_length))
+    return 1;
+
+  m_pos = pos;
+  return 0;
+}
+
+long OnDemandStream::tell()
+{
+  return m_pos;
+}
+
+bool OnDemandStream::isEnd()
+{
+  return m_length <= m_pos;
+}
+
+std::size_t OnDemandStream::findChunk(const long pos) const
+{
+  const auto it = std::upper_bound(m_chunks.begin(), m_chunks.end(), pos,
+                                   [](const long p, const Chunk &chunk)
+  {
+    return p < chunk.m_end;
+  });
+  assert(it != m_chunks.end());
+  return std::size_t(it - m_chunks.begin());
+}
+
+OnDemandStream::ChunkData_t OnDemandStream::getChunk(const std::size_t index)
+{
+  for (auto it = m_cache.begin(); it != m_cache.end(); ++it)
+  {
+    if (it->first == index)
+    {
+      if (it != m_cache.begin())
+      {
+        const auto entry = *it;
+        m_cache.erase(it);
+        m_cache.push_front(entry);
+      }
+      return m_cache.front().second;
+    }
+  }
+
+  const Chunk &chunk = m_chunks[index];
+  vector<unsigned char> buffer;
+  unsigned long length = chunk.m_length;
+  const unsigned char *compressed = nullptr;
+  if (m_input->seek(chunk.m_pos, librevenge::RVNG_SEEK_SET) == 0)
+    compressed = readBytes(m_input, buffer, length);
+
+  const auto data = std::make_shared<vector<unsigned char>>();
+  if (!compressed || (length != chunk.m_length) || !uncompressBlock(compressed, length, *data)
+      || (long(data->size()) != chunk.m_end - chunk.m_begin))
+  {
+    ETONYEK_DEBUG_MSG(("OnDemandStream::getChunk: chunk %u is broken, truncating the stream\n", unsigned(index)));
+    m_length = chunk.m_begin;
+    m_chunks.erase(m_chunks.begin() + long(index), m_chunks.end());
+    m_cache.clear();
+    if (m_pos > m_length)
+      m_pos = m_length;
+    return ChunkData_t();
+  }
+
+  if (m_cache.size() >= chunkCacheSize)
+    m_cache.pop_back();
+  m_cache.push_front(std::make_pair(index, data));
+  return data;
 }
 
 }
 
-IWASnappyStream::IWASnappyStream(const RVNGInputStreamPtr_t &stream)
+IWASnappyStream::IWASnappyStream(const RVNGInputStreamPtr_t &stream, const Mode mode)
   : m_stream()
+  , m_buffer()
+  , m_pos(0)
 {
   if (0 != stream->seek(0, librevenge::RVNG_SEEK_SET))
     throw EndOfStreamException();
 
-  m_stream = uncompress(stream);
+  if (mode == MODE_ON_DEMAND)
+    m_stream = std::make_shared<OnDemandStream>(stream);
+  else
+    m_buffer = uncompress(stream);
 }
 
 IWASnappyStream::~IWASnappyStream()
@@ -177,11 +587,19 @@ IWASnappyStream::~IWASnappyStream()
 
 RVNGInputStreamPtr_t IWASnappyStream::uncompressBlock(const RVNGInputStreamPtr_t &block)
 {
+  vector<unsigned char> buffer;
+  unsigned long length = 0;
+  const unsigned char *const compressed = readRemaining(block, buffer, length);
   vector<unsigned char> data;
-  libetonyek::uncompressBlock(block, getLength(block), data);
+  libetonyek::uncompressBlock(compressed, length, data);
   return std::make_shared<IWORKMemoryStream>(data);
 }
 
+const IWABufferPtr_t &IWASnappyStream::getBuffer() const
+{
+  return m_buffer;
+}
+
 bool IWASnappyStream::isStructured()
 {
   return false;
@@ -214,22 +632,57 @@ librevenge::RVNGInputStream *IWASnappyStream::getSubStreamById(unsigned)
 
 const unsigned char *IWASnappyStream::read(const unsigned long numBytes, unsigned long &numBytesRead)
 {
-  return m_stream->read(numBytes, numBytesRead);
+  if (m_stream)
+    return m_stream->read(numBytes, numBytesRead);
+
+  numBytesRead = (std::min)(numBytes, m_buffer->size() - m_pos);
+  if (numBytesRead == 0)
+    return nullptr;
+  const unsigned char *const data = m_buffer->data() + m_pos;
+  m_pos += numBytesRead;
+  return data;
 }
 
 int IWASnappyStream::seek(long offset, const librevenge::RVNG_SEEK_TYPE seekType)
 {
-  return m_stream->seek(offset, seekType);
+  if (m_stream)
+    return m_stream->seek(offset, seekType);
+
+  long pos = 0;
+  switch (seekType)
+  {
+  case librevenge::RVNG_SEEK_SET :
+    pos = offset;
+    break;
+  case librevenge::RVNG_SEEK_CUR :
+    pos = offset + long(m_pos);
+    break;
+  case librevenge::RVNG_SEEK_END :
+    pos = offset + long(m_buffer->size());
+    break;
+  default :
+    return -1;
+  }
+
+  if ((pos < 0) || (pos > long(m_buffer->size())))
+    return 1;
+
+  m_pos = (unsigned long) pos;
+  return 0;
 }
 
 long IWASnappyStream::tell()
 {
-  return m_stream->tell();
+  if (m_stream)
+    return m_stream->tell();
+  return long(m_pos);
 }
 
 bool IWASnappyStream::isEnd()
 {
-  return m_stream->isEnd();
+  if (m_stream)
+    return m_stream->isEnd();
+  return m_pos == m_buffer->size();
 }
 
 }
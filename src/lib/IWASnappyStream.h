@@ -12,6 +12,7 @@
 
 #include <librevenge-stream/librevenge-stream.h>
 
+#include "IWAReader.h"
 #include "libetonyek_utils.h"
 
 namespace libetonyek
@@ -20,12 +21,26 @@ namespace libetonyek
 class IWASnappyStream : public librevenge::RVNGInputStream
 {
 public:
-  explicit IWASnappyStream(const RVNGInputStreamPtr_t &stream);
+  enum Mode
+  {
+    MODE_WHOLE, //! Uncompress the whole stream at once.
+    MODE_ON_DEMAND //! Uncompress chunks when they are read, keeping only a few in memory.
+  };
+
+public:
+  explicit IWASnappyStream(const RVNGInputStreamPtr_t &stream, Mode mode = MODE_WHOLE);
   ~IWASnappyStream() override;
 
   // for unit tests
   static RVNGInputStreamPtr_t uncompressBlock(const RVNGInputStreamPtr_t &block);
 
+  /** Get the whole uncompressed data.
+    *
+    * @returns the data, or an empty pointer if they are uncompressed
+    * on demand
+    */
+  const IWABufferPtr_t &getBuffer() const;
+
   bool isStructured() override;
   unsigned subStreamCount() override;
   const char *subStreamName(unsigned id) override;
@@ -40,7 +55,9 @@ public:
   bool isEnd() override;
 
 private:
-  RVNGInputStreamPtr_t m_stream;
+  RVNGInputStreamPtr_t m_stream; //!< the data uncompressed on demand
+  IWABufferPtr_t m_buffer; //!< the data uncompressed at once
+  unsigned long m_pos; //!< the position in m_buffer
 };
 
 }
@@ -17,6 +17,7 @@
 #include <memory>
 
 #include "IWORKDocumentInterface.h"
+#include "IWORKMediaCache.h"
 #include "IWORKOutputElements.h"
 #include "IWORKPath.h"
 #include "IWORKProperties.h"
@@ -53,8 +54,8 @@ librevenge::RVNGPropertyList makePoint(const double x, const double y)
 
 struct FillWriter : public boost::static_visitor<void>
 {
-  explicit FillWriter(RVNGPropertyList &props)
-    : m_props(props), m_opacity(1)
+  FillWriter(RVNGPropertyList &props, IWORKMediaCache &mediaCache)
+    : m_props(props), m_mediaCache(mediaCache), m_opacity(1)
   {
   }
 
@@ -122,16 +123,11 @@ struct FillWriter : public boost::static_visitor<void>
 
   void operator()(const IWORKMediaContent &bitmap) const
   {
-    if (bitmap.m_data && bitmap.m_data->m_stream)
+    if (bitmap.m_data)
     {
-      const unsigned long length = getLength(bitmap.m_data->m_stream);
-      unsigned long readBytes = 0;
-      bitmap.m_data->m_stream->seek(0, librevenge::RVNG_SEEK_SET);
-      const unsigned char *const bytes = bitmap.m_data->m_stream->read(length, readBytes);
-      if (readBytes == length)
+      if (m_mediaCache.insert(*bitmap.m_data, "draw:fill-image", m_props))
       {
         m_props.insert("draw:fill", "bitmap");
-        m_props.insert("draw:fill-image", librevenge::RVNGBinaryData(bytes, length));
         m_props.insert("librevenge:mime-type", "jpg"); // TODO: fix
         switch (bitmap.m_type)
         {
@@ -174,6 +170,7 @@ struct FillWriter : public boost::static_visitor<void>
 
 private:
   RVNGPropertyList &m_props;
+  IWORKMediaCache &m_mediaCache;
   //! the opacity
   mutable double m_opacity;
 };
@@ -205,6 +202,7 @@ IWORKCollector::IWORKCollector(IWORKDocumentInterface *const document)
   , m_attachmentStack()
   , m_inAttachment(false)
   , m_inAttachments(false)
+  , m_mediaCache(std::make_shared<IWORKMediaCache>())
   , m_currentData()
   , m_currentUnfiltered()
   , m_currentFiltered()
@@ -232,6 +230,17 @@ void IWORKCollector::setRecorder(const std::shared_ptr<IWORKRecorder> &recorder)
   m_recorder = recorder;
 }
 
+void IWORKCollector::setMediaCache(const std::shared_ptr<IWORKMediaCache> &mediaCache)
+{
+  assert(bool(mediaCache));
+  m_mediaCache = mediaCache;
+}
+
+const std::shared_ptr<IWORKMediaCache> &IWORKCollector::getMediaCache() const
+{
+  return m_mediaCache;
+}
+
 void IWORKCollector::collectStyle(const IWORKStylePtr_t &style)
 {
   if (bool(m_recorder))
@@ -587,7 +596,9 @@ void IWORKCollector::closeGroup()
 
 std::shared_ptr<IWORKTable> IWORKCollector::createTable(const IWORKTableNameMapPtr_t &tableNameMap, IWORKFormatNameMap &formatNameMap, const IWORKLanguageManager &langManager) const
 {
-  return shared_ptr<IWORKTable>(new IWORKTable(tableNameMap, formatNameMap, langManager));
+  const shared_ptr<IWORKTable> table(new IWORKTable(tableNameMap, formatNameMap, langManager));
+  table->setMediaCache(m_mediaCache);
+  return table;
 }
 
 std::shared_ptr<IWORKText> IWORKCollector::createText(const IWORKLanguageManager &langManager, bool discardEmptyContent, bool allowListInsertion) const
@@ -751,7 +762,7 @@ void IWORKCollector::fillGraphicProps(const IWORKStylePtr_t style, librevenge::R
   double opacity=style->has<Opacity>() ? style->get<Opacity>() : 1.;
   if (isSurface && style->has<Fill>())
   {
-    FillWriter fillWriter(props);
+    FillWriter fillWriter(props, *m_mediaCache);
     apply_visitor(fillWriter, style->get<Fill>());
     opacity*=fillWriter.getOpacity();
   }
@@ -1103,26 +1114,23 @@ void IWORKCollector::drawMedia(const IWORKMediaPtr_t &media)
       && bool(media->m_geometry)
       && bool(media->m_content)
       && bool(media->m_content->m_data)
-      && bool(media->m_content->m_data->m_stream))
+      && (bool(media->m_content->m_data->m_stream) || !media->m_content->m_data->m_path.empty()))
   {
     const glm::dmat3 trafo = m_levelStack.top().m_trafo;
     const RVNGInputStreamPtr_t input = media->m_content->m_data->m_stream;
 
     std::string mimetype(media->m_content->m_data->m_mimeType);
     if (mimetype.empty())
-      mimetype = detectMimetype(input);
+      mimetype = input ? detectMimetype(input) : detectMimetypeFromName(media->m_content->m_data->m_path);
     if (!mimetype.empty())
     {
-      input->seek(0, librevenge::RVNG_SEEK_END);
-      const auto size = (unsigned long) input->tell();
-      input->seek(0, librevenge::RVNG_SEEK_SET);
-
-      unsigned long readBytes = 0;
-      const unsigned char *const bytes = input->read(size, readBytes);
-      if (readBytes != size)
-        throw GenericException();
-
       librevenge::RVNGPropertyList props;
+      if (!m_mediaCache->insert(*media->m_content->m_data, "office:binary-data", props))
+      {
+        ETONYEK_DEBUG_MSG(("IWORKCollector::drawMedia: can not read the media\n"));
+        return;
+      }
+
       glm::dvec3 pos = trafo * glm::dvec3(0, 0, 1);
       glm::dvec3 dim = trafo * glm::dvec3(media->m_geometry->m_size.m_width, media->m_geometry->m_size.m_height, 0);
 
@@ -1204,7 +1212,6 @@ void IWORKCollector::drawMedia(const IWORKMediaPtr_t &media)
         fillWrapProps(media->m_style, props, media->m_order);
       }
       props.insert("librevenge:mime-type", mimetype.c_str());
-      props.insert("office:binary-data", librevenge::RVNGBinaryData(bytes, size));
       props.insert("svg:width", pt2in(dim[0]));
       props.insert("svg:height", pt2in(dim[1]));
       drawMedia(pos[0], pos[1], props);
@@ -1268,7 +1275,7 @@ void IWORKCollector::drawShape(const IWORKShapePtr_t &shape)
 
 void IWORKCollector::writeFill(const IWORKFill &fill, librevenge::RVNGPropertyList &props)
 {
-  apply_visitor(FillWriter(props), fill);
+  apply_visitor(FillWriter(props, *m_mediaCache), fill);
 }
 
 } // namespace libetonyek
@@ -32,6 +32,7 @@ namespace libetonyek
 
 class IWORKDocumentInterface;
 class IWORKLanguageManager;
+class IWORKMediaCache;
 class IWORKPropertyMap;
 class IWORKRecorder;
 class IWORKTable;
@@ -57,6 +58,13 @@ public:
 
   void setRecorder(const std::shared_ptr<IWORKRecorder> &recorder);
 
+  /** Use a media cache shared with another collector.
+    *
+    * By default, each collector has its own cache.
+    */
+  void setMediaCache(const std::shared_ptr<IWORKMediaCache> &mediaCache);
+  const std::shared_ptr<IWORKMediaCache> &getMediaCache() const;
+
   // collector functions
 
   void collectStyle(const IWORKStylePtr_t &style);
@@ -133,6 +141,15 @@ public:
   {
     return boost::none;
   }
+  /** Try to draw a table row by row while it is being parsed.
+    *
+    * On success, the parser must flush the completed rows with
+    * IWORKTable::flushRows() and then collect the table as usual.
+    */
+  virtual bool streamTable(const std::shared_ptr<IWORKTable> &/*table*/)
+  {
+    return false;
+  }
   IWORKOutputManager &getOutputManager();
 
 public:
@@ -142,13 +159,13 @@ public:
 protected:
   void fillMetadata(librevenge::RVNGPropertyList &props);
 
-  static void fillGraphicProps(const IWORKStylePtr_t style, librevenge::RVNGPropertyList &props,
-                               bool isSurface=true, bool isFrame=false);
+  void fillGraphicProps(const IWORKStylePtr_t style, librevenge::RVNGPropertyList &props,
+                        bool isSurface=true, bool isFrame=false);
   static void fillLayoutProps(const IWORKStylePtr_t style, librevenge::RVNGPropertyList &props);
   static void fillTextAutoSizeProps(const boost::optional<unsigned> &resizeFlags, const IWORKGeometryPtr_t &boundingBox, librevenge::RVNGPropertyList &props);
   static void fillWrapProps(const IWORKStylePtr_t style, librevenge::RVNGPropertyList &props,
                             const boost::optional<int> &order);
-  static void writeFill(const IWORKFill &fill, librevenge::RVNGPropertyList &props);
+  void writeFill(const IWORKFill &fill, librevenge::RVNGPropertyList &props);
   void drawShape(const IWORKShapePtr_t &shape);
 
 private:
@@ -192,6 +209,8 @@ protected:
   bool m_inAttachments;
 
 private:
+  std::shared_ptr<IWORKMediaCache> m_mediaCache;
+
   IWORKDataPtr_t m_currentData;
   IWORKMediaContentPtr_t m_currentUnfiltered;
   IWORKMediaContentPtr_t m_currentFiltered;
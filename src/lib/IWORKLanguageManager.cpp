@@ -17,6 +17,10 @@
 #include <memory>
 #include <stdexcept>
 
+#ifdef WITH_THREADS
+#include <mutex>
+#endif
+
 #ifdef WITH_LIBLANGTAG
 #include <liblangtag/langtag.h>
 #endif
@@ -62,6 +66,25 @@ const std::string makeFullTag(const shared_ptr<lt_tag_t> &tag)
   return full.get();
 }
 
+#ifdef WITH_THREADS
+// liblangtag keeps global state, so it must not be used by more threads at once
+std::recursive_mutex langTagMutex;
+#endif
+
+struct LangTagLock
+{
+  LangTagLock()
+#ifdef WITH_THREADS
+    : m_lock(langTagMutex)
+#endif
+  {
+  }
+
+#ifdef WITH_THREADS
+  const std::lock_guard<std::recursive_mutex> m_lock;
+#endif
+};
+
 }
 #endif
 
@@ -104,6 +127,7 @@ IWORKLanguageManager::IWORKLanguageManager()
 const std::string IWORKLanguageManager::addTag(const std::string &tag)
 {
 #ifdef WITH_LIBLANGTAG
+  const LangTagLock lock;
   // Check if the tag is already known
   const unordered_map<string, string>::const_iterator it = m_tagMap.find(tag);
   if (it != m_tagMap.end())
@@ -133,6 +157,7 @@ const std::string IWORKLanguageManager::addTag(const std::string &tag)
 const std::string IWORKLanguageManager::addLanguage(const std::string &lang)
 {
 #ifdef WITH_LIBLANGTAG
+  const LangTagLock lock;
   // Check if the lang is already known
   const unordered_map<string, string>::const_iterator it = m_langMap.find(lang);
   if (it != m_langMap.end())
@@ -167,6 +192,7 @@ const std::string IWORKLanguageManager::addLanguage(const std::string &lang)
 const std::string IWORKLanguageManager::addLocale(const std::string &locale)
 {
 #ifdef WITH_LIBLANGTAG
+  const LangTagLock lock;
   // Check if the locale is already known
   const unordered_map<string, string>::const_iterator it = m_localeMap.find(locale);
   if (it != m_localeMap.end())
@@ -199,6 +225,7 @@ const std::string IWORKLanguageManager::addLocale(const std::string &locale)
 const std::string IWORKLanguageManager::getLanguage(const std::string &tag) const
 {
 #ifdef WITH_LIBLANGTAG
+  const LangTagLock lock;
   const shared_ptr<lt_tag_t> &langTag = parseTag(tag);
   if (!langTag)
     throw std::logic_error("cannot parse tag that has been successfully parsed before");
@@ -219,6 +246,7 @@ const IWORKLanguageManager::LangDB &IWORKLanguageManager::getLangDB() const
 void IWORKLanguageManager::addProperties(const std::string &tag)
 {
 #ifdef WITH_LIBLANGTAG
+  const LangTagLock lock;
   const shared_ptr<lt_tag_t> &langTag = parseTag(tag);
   if (!langTag)
     throw std::logic_error("cannot parse tag that has been successfully parsed before");
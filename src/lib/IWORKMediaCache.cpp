@@ -0,0 +1,220 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "IWORKMediaCache.h"
+
+#include <cstdio>
+
+#include "IWORKTypes.h"
+
+namespace libetonyek
+{
+
+namespace
+{
+
+/// Compute the 64-bit FNV-1a hash of the data.
+std::uint64_t hashData(const unsigned char *const data, const unsigned long length)
+{
+  std::uint64_t hash = 14695981039346656037ull;
+  for (unsigned long i = 0; i != length; ++i)
+  {
+    hash ^= data[i];
+    hash *= 1099511628211ull;
+  }
+  return hash;
+}
+
+// the contents are usually much smaller; a document with more of
+// them than this reads some of them more times
+const std::size_t defaultMaxRetainedSize = 64 * 1024 * 1024;
+
+std::string makeId(const std::uint64_t hash, const std::size_t collisions)
+{
+  char buffer[40];
+  if (collisions == 0)
+    std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+  else
+    std::snprintf(buffer, sizeof(buffer), "%016llx-%u", static_cast<unsigned long long>(hash), unsigned(collisions));
+  return buffer;
+}
+
+}
+
+IWORKMediaCache::Entry::Entry(const std::string &id, const unsigned long size)
+  : m_data()
+  , m_id(id)
+  , m_size(size)
+  , m_retained(false)
+  , m_lruPos()
+{
+}
+
+IWORKMediaCache::IWORKMediaCache()
+  : m_streams()
+  , m_hashes()
+  , m_entries()
+  , m_lru()
+  , m_retainedSize(0)
+  , m_maxRetainedSize(defaultMaxRetainedSize)
+  , m_references(false)
+#ifdef WITH_THREADS
+  , m_mutex()
+#endif
+{
+}
+
+void IWORKMediaCache::setReferences(const bool references)
+{
+  m_references = references;
+}
+
+bool IWORKMediaCache::getReferences() const
+{
+  return m_references;
+}
+
+bool IWORKMediaCache::insert(const IWORKData &data, const char *const name, librevenge::RVNGPropertyList &props)
+{
+  if (m_references && !data.m_path.empty())
+  {
+    props.insert("xlink:href", data.m_path.c_str());
+    return true;
+  }
+
+  librevenge::RVNGBinaryData content;
+  std::string id;
+  if (!get(data.m_stream, content, id))
+    return false;
+  props.insert(name, content);
+  props.insert("librevenge:media-id", id.c_str());
+  return true;
+}
+
+bool IWORKMediaCache::get(const RVNGInputStreamPtr_t &stream, librevenge::RVNGBinaryData &data, std::string &id)
+{
+  if (!stream)
+    return false;
+
+  {
+#ifdef WITH_THREADS
+    const std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+    const std::size_t index = findStream(stream);
+    if ((index != m_entries.size()) && m_entries[index].m_retained)
+    {
+      touch(index);
+      data = m_entries[index].m_data;
+      id = m_entries[index].m_id;
+      return true;
+    }
+  }
+
+  // read and hash the content without holding the lock
+  stream->seek(0, librevenge::RVNG_SEEK_END);
+  const auto length = (unsigned long) stream->tell();
+  stream->seek(0, librevenge::RVNG_SEEK_SET);
+  unsigned long readBytes = 0;
+  const unsigned char *const bytes = length == 0 ? nullptr : stream->read(length, readBytes);
+  if (readBytes != length)
+    return false;
+  const std::uint64_t hash = hashData(bytes, length);
+
+#ifdef WITH_THREADS
+  const std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+  // the hash and the size are enough to tell the contents apart
+  std::size_t index = m_entries.size();
+  std::size_t collisions = 0;
+  const auto range = m_hashes.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it)
+  {
+    if (m_entries[it->second].m_size == length)
+    {
+      index = it->second;
+      break;
+    }
+    ++collisions;
+  }
+  if (index == m_entries.size())
+  {
+    m_entries.push_back(Entry(makeId(hash, collisions), length));
+    m_hashes.insert(std::make_pair(hash, index));
+  }
+  if (m_entries[index].m_retained)
+    touch(index);
+  else
+    retain(index, bytes);
+  m_streams[stream.get()] = StreamEntry_t(stream, index);
+
+  data = m_entries[index].m_data;
+  id = m_entries[index].m_id;
+  return true;
+}
+
+std::size_t IWORKMediaCache::size() const
+{
+#ifdef WITH_THREADS
+  const std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+  return m_entries.size();
+}
+
+void IWORKMediaCache::setMaxRetainedSize(const std::size_t size)
+{
+#ifdef WITH_THREADS
+  const std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+  m_maxRetainedSize = size;
+}
+
+std::size_t IWORKMediaCache::getRetainedSize() const
+{
+#ifdef WITH_THREADS
+  const std::lock_guard<std::mutex> lock(m_mutex);
+#endif
+  return m_retainedSize;
+}
+
+std::size_t IWORKMediaCache::findStream(const RVNGInputStreamPtr_t &stream) const
+{
+  const auto it = m_streams.find(stream.get());
+  // the address could have been reused by another stream
+  if ((it == m_streams.end()) || (it->second.first.lock() != stream))
+    return m_entries.size();
+  return it->second.second;
+}
+
+void IWORKMediaCache::retain(const std::size_t index, const unsigned char *const bytes)
+{
+  Entry &entry = m_entries[index];
+  entry.m_data = librevenge::RVNGBinaryData(bytes, entry.m_size);
+  entry.m_retained = true;
+  entry.m_lruPos = m_lru.insert(m_lru.begin(), index);
+  m_retainedSize += entry.m_size;
+
+  // the buffers stay alive as long as someone uses their copies
+  while ((m_retainedSize > m_maxRetainedSize) && (m_lru.back() != index))
+  {
+    Entry &dropped = m_entries[m_lru.back()];
+    dropped.m_data.clear();
+    dropped.m_retained = false;
+    m_retainedSize -= dropped.m_size;
+    m_lru.pop_back();
+  }
+}
+
+void IWORKMediaCache::touch(const std::size_t index)
+{
+  m_lru.splice(m_lru.begin(), m_lru, m_entries[index].m_lruPos);
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
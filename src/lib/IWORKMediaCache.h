@@ -0,0 +1,128 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef IWORKMEDIACACHE_H_INCLUDED
+#define IWORKMEDIACACHE_H_INCLUDED
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+#include "libetonyek_utils.h"
+
+#ifdef WITH_THREADS
+#include <mutex>
+#endif
+
+namespace libetonyek
+{
+
+struct IWORKData;
+
+/** Shares the content of the media (images, movies...) of a document.
+  *
+  * The same picture is often used many times, e.g., in the master
+  * slides or in the background of table cells. Its content is read
+  * only once per stream, and identical contents share one buffer
+  * (copies of librevenge::RVNGBinaryData share their data). Each
+  * distinct content also gets an ID derived from the content, so a
+  * generator can see the repeats.
+  *
+  * The IDs are kept for the whole document, but only a limited amount
+  * of content is retained; the least recently used contents are
+  * dropped first and read again if they are needed.
+  *
+  * In reference mode, media whose path in the package is known are not
+  * read at all; the generator gets just the path.
+  *
+  * The cache can be used by several threads.
+  */
+class IWORKMediaCache
+{
+  // disable copying
+  IWORKMediaCache(const IWORKMediaCache &);
+  IWORKMediaCache &operator=(const IWORKMediaCache &);
+
+public:
+  IWORKMediaCache();
+
+  /// Refer to the media by their path instead of sending their content.
+  void setReferences(bool references);
+  bool getReferences() const;
+
+  /** Insert the content of a media, or a reference to it.
+    *
+    * The content is inserted as property @c name, together with
+    * librevenge:media-id. A reference is inserted as xlink:href.
+    *
+    * @arg[in] data the media
+    * @arg[in] name the name of the property for the content
+    * @arg[out] props the properties to insert to
+    * @returns false if the media is not available
+    */
+  bool insert(const IWORKData &data, const char *name, librevenge::RVNGPropertyList &props);
+
+  /** Get the whole content of a stream.
+    *
+    * @arg[in] stream the stream
+    * @arg[out] data the content
+    * @arg[out] id the ID of the content
+    * @returns false if the stream could not be read
+    */
+  bool get(const RVNGInputStreamPtr_t &stream, librevenge::RVNGBinaryData &data, std::string &id);
+
+  /// Get the number of distinct contents.
+  std::size_t size() const;
+
+  /// Set the maximal size of the retained contents, in bytes.
+  void setMaxRetainedSize(std::size_t size);
+
+  /// Get the size of the retained contents, in bytes.
+  std::size_t getRetainedSize() const;
+
+private:
+  struct Entry
+  {
+    Entry(const std::string &id, unsigned long size);
+
+    librevenge::RVNGBinaryData m_data; //!< the content, if it is retained
+    std::string m_id;
+    unsigned long m_size;
+    bool m_retained;
+    std::list<std::size_t>::iterator m_lruPos; //!< the position in the list of retained entries
+  };
+
+  typedef std::pair<std::weak_ptr<librevenge::RVNGInputStream>, std::size_t> StreamEntry_t;
+
+  std::size_t findStream(const RVNGInputStreamPtr_t &stream) const;
+  void retain(std::size_t index, const unsigned char *bytes);
+  void touch(std::size_t index);
+
+private:
+  std::unordered_map<const librevenge::RVNGInputStream *, StreamEntry_t> m_streams; //!< the streams already read
+  std::unordered_multimap<std::uint64_t, std::size_t> m_hashes; //!< the entries with a content hash
+  std::deque<Entry> m_entries;
+  std::list<std::size_t> m_lru; //!< the retained entries, the most recently used first
+  std::size_t m_retainedSize;
+  std::size_t m_maxRetainedSize;
+  bool m_references;
+#ifdef WITH_THREADS
+  mutable std::mutex m_mutex;
+#endif
+};
+
+}
+
+#endif // IWORKMEDIACACHE_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -11,6 +11,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <utility>
 
 #include "libetonyek_utils.h"
 
@@ -64,6 +65,15 @@ IWORKMemoryStream::IWORKMemoryStream(const unsigned char *const data, const unsi
   assign(data, length);
 }
 
+IWORKMemoryStream::IWORKMemoryStream(std::unique_ptr<unsigned char[]> data, const unsigned length)
+  : m_data(std::move(data))
+  , m_length(long(length))
+  , m_pos(0)
+{
+  if (0 == length)
+    throw GenericException();
+}
+
 IWORKMemoryStream::~IWORKMemoryStream()
 {
 }
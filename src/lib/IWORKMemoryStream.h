@@ -29,6 +29,8 @@ public:
   IWORKMemoryStream(const RVNGInputStreamPtr_t &input, unsigned length);
   explicit IWORKMemoryStream(const std::vector<unsigned char> &data);
   IWORKMemoryStream(const unsigned char *data, unsigned length);
+  /// Take over the data, without copying them.
+  IWORKMemoryStream(std::unique_ptr<unsigned char[]> data, unsigned length);
   ~IWORKMemoryStream() override;
 
   bool isStructured() override;
@@ -13,6 +13,8 @@
 
 #include "IWORKDocumentInterface.h"
 #include "IWORKFormula.h"
+#include "IWORKProfiler.h"
+#include "IWORKTable.h"
 
 namespace libetonyek
 {
@@ -477,6 +479,26 @@ private:
   librevenge::RVNGPropertyList m_propList;
 };
 
+class OpenNamedTableElement : public IWORKOutputElement
+{
+public:
+  OpenNamedTableElement(const librevenge::RVNGPropertyList &propList, const IWORKTableNameMapPtr_t &tableNameMap,
+                        const std::string &name, const boost::optional<std::string> &globalId)
+    : m_propList(propList)
+    , m_tableNameMap(tableNameMap)
+    , m_name(name)
+    , m_globalId(globalId)
+    , m_finalName() {}
+  ~OpenNamedTableElement() override {}
+  void write(IWORKDocumentInterface *iface) const override;
+private:
+  librevenge::RVNGPropertyList m_propList;
+  const IWORKTableNameMapPtr_t m_tableNameMap;
+  const std::string m_name;
+  const boost::optional<std::string> m_globalId;
+  mutable boost::optional<std::string> m_finalName;
+};
+
 class OpenTableCellElement : public IWORKOutputElement
 {
 public:
@@ -525,11 +547,15 @@ class StartLayerElement : public IWORKOutputElement
 {
 public:
   explicit StartLayerElement(const librevenge::RVNGPropertyList &propList) :
-    m_propList(propList) {}
+    m_propList(propList), m_layerCount(), m_id() {}
+  StartLayerElement(const librevenge::RVNGPropertyList &propList, const std::shared_ptr<int> &layerCount) :
+    m_propList(propList), m_layerCount(layerCount), m_id() {}
   ~StartLayerElement() override {}
   void write(IWORKDocumentInterface *iface) const override;
 private:
   const librevenge::RVNGPropertyList m_propList;
+  const std::shared_ptr<int> m_layerCount;
+  mutable boost::optional<int> m_id;
 };
 
 class StartNotesElement : public IWORKOutputElement
@@ -836,6 +862,19 @@ void OpenTableElement::write(IWORKDocumentInterface *iface) const
     iface->openTable(m_propList);
 }
 
+void OpenNamedTableElement::write(IWORKDocumentInterface *iface) const
+{
+  // the name is registered only once, even if the element is written again
+  if (!m_finalName)
+    m_finalName = IWORKTable::registerName(*m_tableNameMap, m_name, m_globalId);
+
+  librevenge::RVNGPropertyList tableProps(m_propList);
+  tableProps.insert("librevenge:sheet-name", get(m_finalName).c_str());
+
+  if (iface)
+    iface->openTable(tableProps);
+}
+
 void OpenTableCellElement::write(IWORKDocumentInterface *iface) const
 {
   if (iface)
@@ -862,8 +901,22 @@ void SetStyleElement::write(IWORKDocumentInterface *iface) const
 
 void StartLayerElement::write(IWORKDocumentInterface *const iface) const
 {
+  if (!m_layerCount)
+  {
+    if (iface)
+      iface->startLayer(m_propList);
+    return;
+  }
+
+  // the layer is numbered only once, even if it is written again
+  if (!m_id)
+    m_id = ++*m_layerCount;
+
+  librevenge::RVNGPropertyList layerProps(m_propList);
+  layerProps.insert("svg:id", get(m_id));
+
   if (iface)
-    iface->startLayer(m_propList);
+    iface->startLayer(layerProps);
 }
 
 void StartNotesElement::write(IWORKDocumentInterface *const iface) const
@@ -903,6 +956,7 @@ void IWORKOutputElements::addShapesInSpreadsheet(const IWORKOutputElements &elem
 
 void IWORKOutputElements::write(IWORKDocumentInterface *iface) const
 {
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_EMIT);
   ElementList_t::const_iterator iter;
   for (iter = m_elements.begin(); iter != m_elements.end(); ++iter)
     (*iter)->write(iface);
@@ -1148,6 +1202,12 @@ void IWORKOutputElements::addOpenTable(const librevenge::RVNGPropertyList &propL
   m_elements.push_back(make_shared<OpenTableElement>(propList));
 }
 
+void IWORKOutputElements::addOpenTable(const librevenge::RVNGPropertyList &propList, const IWORKTableNameMapPtr_t &tableNameMap,
+                                       const std::string &name, const boost::optional<std::string> &globalId)
+{
+  m_elements.push_back(std::shared_ptr<OpenNamedTableElement>(new OpenNamedTableElement(propList, tableNameMap, name, globalId)));
+}
+
 void IWORKOutputElements::addOpenTableCell(const librevenge::RVNGPropertyList &propList)
 {
   m_elements.push_back(make_shared<OpenTableCellElement>(propList));
@@ -1173,6 +1233,11 @@ void IWORKOutputElements::addStartLayer(const librevenge::RVNGPropertyList &prop
   m_elements.push_back(make_shared<StartLayerElement>(propList));
 }
 
+void IWORKOutputElements::addStartLayer(const librevenge::RVNGPropertyList &propList, const std::shared_ptr<int> &layerCount)
+{
+  m_elements.push_back(make_shared<StartLayerElement>(propList, layerCount));
+}
+
 void IWORKOutputElements::addStartNotes(const librevenge::RVNGPropertyList &propList)
 {
   m_elements.push_back(make_shared<StartNotesElement>(propList));
@@ -12,6 +12,7 @@
 
 #include <deque>
 #include <memory>
+#include <string>
 #include <unordered_map>
 
 #include <boost/optional.hpp>
@@ -89,11 +90,20 @@ public:
   void addOpenSection(const librevenge::RVNGPropertyList &propList);
   void addOpenSpan(const librevenge::RVNGPropertyList &propList);
   void addOpenTable(const librevenge::RVNGPropertyList &propList);
+  //! add a table whose name is made unique in tableNameMap when it is written
+  void addOpenTable(const librevenge::RVNGPropertyList &propList, const IWORKTableNameMapPtr_t &tableNameMap,
+                    const std::string &name, const boost::optional<std::string> &globalId);
   void addOpenTableCell(const librevenge::RVNGPropertyList &propList);
   void addOpenTableRow(const librevenge::RVNGPropertyList &propList);
   void addOpenUnorderedListLevel(const librevenge::RVNGPropertyList &propList);
   void addSetStyle(const librevenge::RVNGPropertyList &propList);
   void addStartLayer(const librevenge::RVNGPropertyList &propList);
+  /** Add the start of a layer numbered when it is written.
+    *
+    * The layer gets the next number of @c layerCount as its @c svg:id
+    * the first time it is written.
+    */
+  void addStartLayer(const librevenge::RVNGPropertyList &propList, const std::shared_ptr<int> &layerCount);
   void addStartNotes(const librevenge::RVNGPropertyList &propList);
   void addStartTextObject(const librevenge::RVNGPropertyList &propList);
 
@@ -11,12 +11,14 @@
 
 #include <cassert>
 #include <memory>
+#include <utility>
 
 #include <libxml/xmlreader.h>
 
 #include <stack>
 
 #include "libetonyek_xml.h"
+#include "IWORKTokenCache.h"
 #include "IWORKTokenizer.h"
 #include "IWORKXMLContextBase.h"
 #include "IWORKXMLParserState.h"
@@ -30,9 +32,9 @@ namespace libetonyek
 namespace
 {
 
-void processAttribute(xmlTextReaderPtr reader, IWORKXMLContextPtr_t context, const IWORKTokenizer &tokenizer)
+void processAttribute(xmlTextReaderPtr reader, IWORKXMLContextPtr_t context, IWORKTokenCache &tokens)
 {
-  const int id = tokenizer.getQualifiedId(char_cast(xmlTextReaderConstLocalName(reader)), char_cast(xmlTextReaderConstNamespaceUri(reader)));
+  const int id = tokens.getQualifiedId(char_cast(xmlTextReaderConstLocalName(reader)), char_cast(xmlTextReaderConstNamespaceUri(reader)));
   const char *value = char_cast(xmlTextReaderConstValue(reader));
   context->attribute(id, value);
 }
@@ -58,8 +60,12 @@ bool IWORKParser::parse()
   xmlTextReaderPtr reader = sharedReader.get();
   assert(reader);
 
-  const IWORKTokenizer &tokenizer = getTokenizer();
+  // all names are interned by the reader, so their tokens can be cached
+  IWORKTokenCache tokens(getTokenizer());
+  const bool harvest = isDiscardHarvesting();
   stack<IWORKXMLContextPtr_t> contextStack;
+  // discarded elements whose content is being scanned, with their depths
+  stack<std::pair<const IWORKXMLContext *, int> > discardStack;
 
   int ret = xmlTextReaderRead(reader);
   contextStack.push(createDocumentContext());
@@ -68,6 +74,8 @@ bool IWORKParser::parse()
   char const *defaultNS=nullptr;
   while ((1 == ret))
   {
+    const bool scanning = !discardStack.empty() && (discardStack.top().first == contextStack.top().get());
+
     switch (xmlTextReaderNodeType(reader))
     {
     case XML_READER_TYPE_ELEMENT:
@@ -80,15 +88,31 @@ bool IWORKParser::parse()
             xmlTextReaderConstNamespaceUri(reader)==nullptr)
           defaultNS="http://developer.apple.com/schemas/APXL";
       }
-      const int id = tokenizer.getQualifiedId(char_cast(xmlTextReaderConstLocalName(reader)),
-                                              defaultNS ? defaultNS : char_cast(xmlTextReaderConstNamespaceUri(reader)));
+
+      const int id = tokens.getQualifiedId(char_cast(xmlTextReaderConstLocalName(reader)),
+                                           defaultNS ? defaultNS : char_cast(xmlTextReaderConstNamespaceUri(reader)));
 
       IWORKXMLContextPtr_t newContext = contextStack.top()->element(id);
 
-      if (!newContext)
-        newContext = createDiscardContext();
+      // in a discarded element, only the elements the discard context can use are read
+      if (scanning && (!newContext || (newContext == contextStack.top())))
+        break;
 
       const bool isEmpty = xmlTextReaderIsEmptyElement(reader);
+      const int depth = xmlTextReaderDepth(reader);
+
+      bool discarded = false;
+      if (!newContext)
+      {
+        if (!harvest && !isEmpty)
+        {
+          // there is nothing to be found in it, so do not even read it
+          ret = xmlTextReaderNext(reader);
+          continue;
+        }
+        newContext = createDiscardContext();
+        discarded = true;
+      }
 
       newContext->startOfElement();
       if (xmlTextReaderHasAttributes(reader))
@@ -96,32 +120,48 @@ bool IWORKParser::parse()
         ret = xmlTextReaderMoveToFirstAttribute(reader);
         while (1 == ret)
         {
-          processAttribute(reader, newContext, tokenizer);
+          processAttribute(reader, newContext, tokens);
           ret = xmlTextReaderMoveToNextAttribute(reader);
         }
       }
 
       if (isEmpty)
+      {
         newContext->endOfElement();
+      }
       else
-        contextStack.push(newContext);
+      {
+        if (discarded)
+          discardStack.push(std::make_pair(newContext.get(), depth));
+        contextStack.push(std::move(newContext));
+      }
 
       break;
     }
     case XML_READER_TYPE_END_ELEMENT:
     {
+      if (scanning)
+      {
+        if (xmlTextReaderDepth(reader) > discardStack.top().second)
+          break;
+        discardStack.pop();
+      }
       contextStack.top()->endOfElement();
       contextStack.pop();
       break;
     }
     case XML_READER_TYPE_CDATA :
     {
+      if (scanning)
+        break;
       const xmlChar *text = xmlTextReaderConstValue(reader);
       if (text) contextStack.top()->CDATA(char_cast(text));
       break;
     }
     case XML_READER_TYPE_TEXT :
     {
+      if (scanning)
+        break;
       xmlChar *const text = xmlTextReaderReadString(reader);
       contextStack.top()->text(char_cast(text));
       xmlFree(text);
@@ -145,6 +185,11 @@ bool IWORKParser::parse()
   return true;
 }
 
+bool IWORKParser::isDiscardHarvesting() const
+{
+  return true;
+}
+
 RVNGInputStreamPtr_t &IWORKParser::getInput()
 {
   return m_input;
@@ -45,6 +45,16 @@ private:
   virtual IWORKXMLContextPtr_t createDocumentContext() = 0;
   virtual IWORKXMLContextPtr_t createDiscardContext() = 0;
 
+  /** Check if the discard context can pick up definitions of referenceable objects.
+    *
+    * If it can, the content of a discarded element is scanned: only
+    * the elements for which the discard context returns a context of
+    * its own are read, the rest is passed over without processing
+    * attributes or text. Otherwise discarded elements are skipped
+    * entirely.
+    */
+  virtual bool isDiscardHarvesting() const;
+
 private:
   RVNGInputStreamPtr_t m_input;
   RVNGInputStreamPtr_t m_package;
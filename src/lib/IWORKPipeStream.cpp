@@ -0,0 +1,406 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "IWORKPipeStream.h"
+
+#include <algorithm>
+#include <vector>
+
+#ifdef WITH_THREADS
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace libetonyek
+{
+
+#ifdef WITH_THREADS
+
+namespace
+{
+
+/// Number of buffers in the ring.
+const unsigned bufferCount = 8;
+
+/// Size of a single read from the source.
+const unsigned long bufferSize = 1 << 16;
+
+}
+
+/** The ring of buffers between the reading thread and the consumer.
+  *
+  * There is a single producer and a single consumer, so the buffers
+  * are passed using two counters only. The mutex is only used to sleep
+  * when the ring is full or empty.
+  */
+struct IWORKPipeStream::Impl
+{
+  explicit Impl(const RVNGInputStreamPtr_t &source);
+  ~Impl();
+
+  void start();
+  void stop();
+  void produce();
+  void notify();
+
+  bool acquire();
+  bool wait(unsigned long buffer);
+  void release();
+  std::vector<unsigned char> &current();
+
+  const RVNGInputStreamPtr_t m_source;
+  std::vector<unsigned char> m_buffers[bufferCount];
+  std::atomic<unsigned long> m_produced; // number of buffers filled by the producer
+  std::atomic<unsigned long> m_consumed; // number of buffers given back by the consumer
+  std::atomic<bool> m_done; // the producer has reached the end of the source
+  std::atomic<bool> m_stop; // the producer should stop
+  std::mutex m_mutex;
+  std::condition_variable m_changed;
+  std::thread m_thread;
+
+  bool m_running;
+  long m_pos; // the position of the consumer
+  unsigned long m_offset; // the position of the consumer in the current buffer
+  std::vector<unsigned char> m_spill; // data of a read spanning more buffers
+};
+
+IWORKPipeStream::Impl::Impl(const RVNGInputStreamPtr_t &source)
+  : m_source(source)
+  , m_buffers()
+  , m_produced(0)
+  , m_consumed(0)
+  , m_done(false)
+  , m_stop(false)
+  , m_mutex()
+  , m_changed()
+  , m_thread()
+  , m_running(false)
+  , m_pos(source->tell())
+  , m_offset(0)
+  , m_spill()
+{
+}
+
+IWORKPipeStream::Impl::~Impl()
+{
+  stop();
+}
+
+void IWORKPipeStream::Impl::start()
+{
+  if (m_running)
+    return;
+  m_produced = 0;
+  m_consumed = 0;
+  m_done = false;
+  m_stop = false;
+  m_offset = 0;
+  m_thread = std::thread(&Impl::produce, this);
+  m_running = true;
+}
+
+void IWORKPipeStream::Impl::stop()
+{
+  if (!m_running)
+    return;
+  m_stop = true;
+  notify();
+  m_thread.join();
+  m_running = false;
+}
+
+void IWORKPipeStream::Impl::produce()
+{
+  try
+  {
+    while (!m_stop.load(std::memory_order_acquire))
+    {
+      const unsigned long produced = m_produced.load(std::memory_order_relaxed);
+      if (produced - m_consumed.load(std::memory_order_acquire) == bufferCount)
+      {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_changed.wait(lock, [this, produced]()
+        {
+          return m_stop.load(std::memory_order_acquire) || (produced - m_consumed.load(std::memory_order_acquire) < bufferCount);
+        });
+        continue;
+      }
+
+      unsigned long numBytesRead = 0;
+      const unsigned char *const data = m_source->isEnd() ? nullptr : m_source->read(bufferSize, numBytesRead);
+      if (!data || (numBytesRead == 0))
+        break;
+      m_buffers[produced % bufferCount].assign(data, data + numBytesRead);
+      m_produced.store(produced + 1, std::memory_order_release);
+      notify();
+    }
+  }
+  catch (...)
+  {
+    ETONYEK_DEBUG_MSG(("IWORKPipeStream::Impl::produce: reading the source failed\n"));
+  }
+  m_done.store(true, std::memory_order_release);
+  notify();
+}
+
+void IWORKPipeStream::Impl::notify()
+{
+  {
+    // do not let the notification slip in before the other thread waits
+    std::lock_guard<std::mutex> lock(m_mutex);
+  }
+  m_changed.notify_all();
+}
+
+/** Wait until the current buffer is available.
+  *
+  * @returns false at the end of the source
+  */
+bool IWORKPipeStream::Impl::acquire()
+{
+  start();
+  return wait(m_consumed.load(std::memory_order_relaxed));
+}
+
+/** Wait until the buffer with sequence number @c buffer is filled.
+  *
+  * @returns false if the source ends before
+  */
+bool IWORKPipeStream::Impl::wait(const unsigned long buffer)
+{
+  const auto available = [this, buffer]()
+  {
+    return buffer < m_produced.load(std::memory_order_acquire);
+  };
+
+  if (available())
+    return true;
+  if (!m_done.load(std::memory_order_acquire))
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait(lock, [this, &available]()
+    {
+      return available() || m_done.load(std::memory_order_acquire);
+    });
+  }
+  return available();
+}
+
+/// Give the current buffer back to the producer.
+void IWORKPipeStream::Impl::release()
+{
+  m_offset = 0;
+  m_consumed.store(m_consumed.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+  notify();
+}
+
+std::vector<unsigned char> &IWORKPipeStream::Impl::current()
+{
+  return m_buffers[m_consumed.load(std::memory_order_relaxed) % bufferCount];
+}
+
+IWORKPipeStream::IWORKPipeStream(const RVNGInputStreamPtr_t &source)
+  : m_impl(new Impl(source))
+{
+}
+
+IWORKPipeStream::~IWORKPipeStream()
+{
+}
+
+const unsigned char *IWORKPipeStream::read(const unsigned long numBytes, unsigned long &numBytesRead) try
+{
+  numBytesRead = 0;
+  if (numBytes == 0)
+    return nullptr;
+
+  // the previous read could have used the whole buffer; it can be given back now
+  if (m_impl->acquire() && (m_impl->m_offset == m_impl->current().size()))
+    m_impl->release();
+  if (!m_impl->acquire())
+    return nullptr;
+
+  std::vector<unsigned char> *buffer = &m_impl->current();
+  if (m_impl->m_offset + numBytes <= buffer->size())
+  {
+    // the common case: all the data are in one buffer
+    const unsigned char *const data = &(*buffer)[m_impl->m_offset];
+    m_impl->m_offset += numBytes;
+    m_impl->m_pos += long(numBytes);
+    numBytesRead = numBytes;
+    return data;
+  }
+
+  m_impl->m_spill.clear();
+  while (m_impl->m_spill.size() < numBytes)
+  {
+    const auto begin = buffer->begin() + long(m_impl->m_offset);
+    const auto count = (std::min)(numBytes - m_impl->m_spill.size(), (unsigned long)(buffer->end() - begin));
+    m_impl->m_spill.insert(m_impl->m_spill.end(), begin, begin + long(count));
+    m_impl->m_offset += count;
+    m_impl->m_pos += long(count);
+    if (m_impl->m_spill.size() < numBytes)
+    {
+      m_impl->release();
+      if (!m_impl->acquire())
+        break;
+      buffer = &m_impl->current();
+    }
+  }
+  numBytesRead = m_impl->m_spill.size();
+  return m_impl->m_spill.empty() ? nullptr : &m_impl->m_spill[0];
+}
+catch (...)
+{
+  return nullptr;
+}
+
+int IWORKPipeStream::seek(const long offset, const librevenge::RVNG_SEEK_TYPE seekType) try
+{
+  long pos = 0;
+  switch (seekType)
+  {
+  case librevenge::RVNG_SEEK_SET :
+    pos = offset;
+    break;
+  case librevenge::RVNG_SEEK_CUR :
+    pos = offset + m_impl->m_pos;
+    break;
+  case librevenge::RVNG_SEEK_END :
+  {
+    m_impl->stop();
+    const int ret = m_impl->m_source->seek(offset, librevenge::RVNG_SEEK_END);
+    m_impl->m_pos = m_impl->m_source->tell();
+    return ret;
+  }
+  default :
+    return -1;
+  }
+
+  if (m_impl->m_running && m_impl->acquire())
+  {
+    // stay in the current buffer, if possible
+    const long bufferStart = m_impl->m_pos - long(m_impl->m_offset);
+    if ((pos >= bufferStart) && (pos <= bufferStart + long(m_impl->current().size())))
+    {
+      m_impl->m_offset = (unsigned long)(pos - bufferStart);
+      m_impl->m_pos = pos;
+      return 0;
+    }
+  }
+
+  m_impl->stop();
+  const int ret = m_impl->m_source->seek(pos, librevenge::RVNG_SEEK_SET);
+  m_impl->m_pos = m_impl->m_source->tell();
+  return ret;
+}
+catch (...)
+{
+  return -1;
+}
+
+long IWORKPipeStream::tell()
+{
+  return m_impl->m_pos;
+}
+
+bool IWORKPipeStream::isEnd() try
+{
+  if (!m_impl->acquire())
+    return true;
+  if (m_impl->m_offset < m_impl->current().size())
+    return false;
+  // the current buffer must stay valid until the next read, so just wait for the next one
+  return !m_impl->wait(m_impl->m_consumed.load(std::memory_order_relaxed) + 1);
+}
+catch (...)
+{
+  return true;
+}
+
+#else
+
+struct IWORKPipeStream::Impl
+{
+  explicit Impl(const RVNGInputStreamPtr_t &source);
+
+  const RVNGInputStreamPtr_t m_source;
+};
+
+IWORKPipeStream::Impl::Impl(const RVNGInputStreamPtr_t &source)
+  : m_source(source)
+{
+}
+
+IWORKPipeStream::IWORKPipeStream(const RVNGInputStreamPtr_t &source)
+  : m_impl(new Impl(source))
+{
+}
+
+IWORKPipeStream::~IWORKPipeStream()
+{
+}
+
+const unsigned char *IWORKPipeStream::read(const unsigned long numBytes, unsigned long &numBytesRead)
+{
+  return m_impl->m_source->read(numBytes, numBytesRead);
+}
+
+int IWORKPipeStream::seek(const long offset, const librevenge::RVNG_SEEK_TYPE seekType)
+{
+  return m_impl->m_source->seek(offset, seekType);
+}
+
+long IWORKPipeStream::tell()
+{
+  return m_impl->m_source->tell();
+}
+
+bool IWORKPipeStream::isEnd()
+{
+  return m_impl->m_source->isEnd();
+}
+
+#endif
+
+bool IWORKPipeStream::isStructured()
+{
+  return false;
+}
+
+unsigned IWORKPipeStream::subStreamCount()
+{
+  return 0;
+}
+
+const char *IWORKPipeStream::subStreamName(unsigned)
+{
+  return nullptr;
+}
+
+bool IWORKPipeStream::existsSubStream(const char *)
+{
+  return false;
+}
+
+librevenge::RVNGInputStream *IWORKPipeStream::getSubStreamByName(const char *)
+{
+  return nullptr;
+}
+
+librevenge::RVNGInputStream *IWORKPipeStream::getSubStreamById(unsigned)
+{
+  return nullptr;
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
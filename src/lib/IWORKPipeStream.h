@@ -0,0 +1,61 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef IWORKPIPESTREAM_H_INCLUDED
+#define IWORKPIPESTREAM_H_INCLUDED
+
+#include <memory>
+
+#include "libetonyek_utils.h"
+
+namespace libetonyek
+{
+
+/** A stream that reads its source ahead in a separate thread.
+  *
+  * This lets an expensive source, like an inflating stream, produce
+  * the data while the previous data are being consumed. The source
+  * must not be used by anybody else while the pipe exists.
+  *
+  * Reading forward is cheap. A seek outside of the data already read
+  * ahead stops the thread and seeks the source. If the library is
+  * built without thread support, the source is just read directly.
+  */
+class IWORKPipeStream : public librevenge::RVNGInputStream
+{
+  // disable copying
+  IWORKPipeStream(const IWORKPipeStream &);
+  IWORKPipeStream &operator=(const IWORKPipeStream &);
+
+public:
+  explicit IWORKPipeStream(const RVNGInputStreamPtr_t &source);
+  ~IWORKPipeStream() override;
+
+  bool isStructured() override;
+  unsigned subStreamCount() override;
+  const char *subStreamName(unsigned id) override;
+  bool existsSubStream(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamByName(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamById(unsigned id) override;
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override;
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override;
+  long tell() override;
+  bool isEnd() override;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+}
+
+#endif // IWORKPIPESTREAM_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
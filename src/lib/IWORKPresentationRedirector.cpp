@@ -16,9 +16,17 @@ namespace libetonyek
 
 IWORKPresentationRedirector::IWORKPresentationRedirector(librevenge::RVNGPresentationInterface *const iface)
   : m_iface(iface)
+  , m_shareStyles(false)
+  , m_paragraphStyles("librevenge:paragraph-id")
+  , m_characterStyles("librevenge:span-id")
 {
 }
 
+void IWORKPresentationRedirector::setShareStyles(const bool share)
+{
+  m_shareStyles = share;
+}
+
 void IWORKPresentationRedirector::setDocumentMetaData(const librevenge::RVNGPropertyList &propList)
 {
   if (m_iface)
@@ -125,7 +133,17 @@ void IWORKPresentationRedirector::defineParagraphStyle(const librevenge::RVNGPro
 
 void IWORKPresentationRedirector::openParagraph(const librevenge::RVNGPropertyList &propList)
 {
-  if (m_iface)
+  if (!m_iface)
+    return;
+  if (m_shareStyles)
+  {
+    librevenge::RVNGPropertyList definition;
+    const librevenge::RVNGPropertyList ref(m_paragraphStyles.share(propList, definition));
+    if (!definition.empty())
+      m_iface->defineParagraphStyle(definition);
+    m_iface->openParagraph(ref);
+  }
+  else
     m_iface->openParagraph(propList);
 }
 
@@ -143,7 +161,17 @@ void IWORKPresentationRedirector::defineCharacterStyle(const librevenge::RVNGPro
 
 void IWORKPresentationRedirector::openSpan(const librevenge::RVNGPropertyList &propList)
 {
-  if (m_iface)
+  if (!m_iface)
+    return;
+  if (m_shareStyles)
+  {
+    librevenge::RVNGPropertyList definition;
+    const librevenge::RVNGPropertyList ref(m_characterStyles.share(propList, definition));
+    if (!definition.empty())
+      m_iface->defineCharacterStyle(definition);
+    m_iface->openSpan(ref);
+  }
+  else
     m_iface->openSpan(propList);
 }
 
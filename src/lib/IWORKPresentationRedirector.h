@@ -11,6 +11,7 @@
 #define IWORKPRESENTATIONREDIRECTOR_H_INCLUDED
 
 #include "IWORKDocumentInterface.h"
+#include "IWORKSharedStyles.h"
 
 namespace libetonyek
 {
@@ -20,6 +21,11 @@ class IWORKPresentationRedirector : public IWORKDocumentInterface
 public:
   explicit IWORKPresentationRedirector(librevenge::RVNGPresentationInterface *iface);
 
+  /** Define each distinct paragraph and character style once and
+    * refer to it by its ID.
+    */
+  void setShareStyles(bool share);
+
   void setDocumentMetaData(const librevenge::RVNGPropertyList &propList) override;
 
   void startDocument(const librevenge::RVNGPropertyList &propList) override;
@@ -161,6 +167,9 @@ private:
   IWORKPresentationRedirector &operator=(const IWORKPresentationRedirector &);
 
   librevenge::RVNGPresentationInterface *const m_iface;
+  bool m_shareStyles;
+  IWORKSharedStyles m_paragraphStyles;
+  IWORKSharedStyles m_characterStyles;
 };
 
 }
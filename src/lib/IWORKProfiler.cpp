@@ -0,0 +1,114 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "IWORKProfiler.h"
+
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+
+namespace libetonyek
+{
+
+namespace
+{
+
+typedef std::chrono::steady_clock Clock_t;
+
+std::atomic<bool> enabled(false);
+std::atomic<uint64_t> phaseTimes[IWORKProfiler::PHASE_COUNT]; // in nanoseconds
+
+thread_local IWORKProfiler::Phase currentPhase = IWORKProfiler::PHASE_NONE;
+thread_local Clock_t::time_point phaseStart;
+
+/// Account the time spent in the current phase, up to now.
+void updateCurrentPhase()
+{
+  const Clock_t::time_point now = Clock_t::now();
+  if (currentPhase != IWORKProfiler::PHASE_NONE)
+  {
+    const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(now - phaseStart).count();
+    phaseTimes[currentPhase].fetch_add(uint64_t(elapsed), std::memory_order_relaxed);
+  }
+  phaseStart = now;
+}
+
+}
+
+IWORKProfiler::Scope::Scope(const Phase phase)
+  : m_previous(currentPhase)
+  , m_active(enabled.load(std::memory_order_relaxed))
+{
+  assert(phase < PHASE_COUNT);
+
+  if (m_active)
+  {
+    updateCurrentPhase();
+    currentPhase = phase;
+  }
+}
+
+IWORKProfiler::Scope::~Scope()
+{
+  if (m_active)
+  {
+    updateCurrentPhase();
+    currentPhase = m_previous;
+  }
+}
+
+void IWORKProfiler::enable(const bool enabledNow)
+{
+  enabled.store(enabledNow);
+}
+
+void IWORKProfiler::reset()
+{
+  for (auto &time : phaseTimes)
+    time.store(0);
+}
+
+double IWORKProfiler::getTime(const Phase phase)
+{
+  assert(phase < PHASE_COUNT);
+  return double(phaseTimes[phase].load()) / 1e9;
+}
+
+const char *IWORKProfiler::getName(const Phase phase)
+{
+  switch (phase)
+  {
+  case PHASE_NONE :
+    return "none";
+  case PHASE_DETECTION :
+    return "detection";
+  case PHASE_DECOMPRESSION :
+    return "decompression";
+  case PHASE_OBJECT_INDEX :
+    return "object_index";
+  case PHASE_PARSE :
+    return "parse";
+  case PHASE_EMIT :
+    return "emit";
+  case PHASE_COUNT :
+  default :
+    break;
+  }
+  return "unknown";
+}
+
+IWORKProfiler::Phase IWORKProfiler::getCurrentPhase()
+{
+  return currentPhase;
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
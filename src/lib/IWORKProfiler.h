@@ -0,0 +1,70 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef IWORKPROFILER_H_INCLUDED
+#define IWORKPROFILER_H_INCLUDED
+
+namespace libetonyek
+{
+
+/** Accounting of the time spent in the phases of an import.
+  *
+  * This is meant for benchmarks: nothing is measured until it is
+  * enabled. Each thread has its own current phase; a phase entered
+  * inside another one pauses the outer phase, so the times do not
+  * overlap. The times of all threads are summed.
+  */
+class IWORKProfiler
+{
+public:
+  enum Phase
+  {
+    PHASE_NONE,
+    PHASE_DETECTION,
+    PHASE_DECOMPRESSION,
+    PHASE_OBJECT_INDEX,
+    PHASE_PARSE,
+    PHASE_EMIT,
+    PHASE_COUNT
+  };
+
+  /// Switch the current thread to a phase for the lifetime of the scope.
+  class Scope
+  {
+    // disable copying
+    Scope(const Scope &);
+    Scope &operator=(const Scope &);
+
+  public:
+    explicit Scope(Phase phase);
+    ~Scope();
+
+  private:
+    Phase m_previous;
+    bool m_active;
+  };
+
+public:
+  static void enable(bool enabled);
+  /// Clear the accumulated times.
+  static void reset();
+
+  /// Get the time spent in @c phase since the last reset, in seconds.
+  static double getTime(Phase phase);
+  static const char *getName(Phase phase);
+
+  /// Get the phase of the current thread.
+  static Phase getCurrentPhase();
+};
+
+}
+
+#endif // IWORKPROFILER_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -10,12 +10,151 @@
 #ifndef IWORKPROPERTYINFO_H_INCLUDED
 #define IWORKPROPERTYINFO_H_INCLUDED
 
-#include <string>
+#include <cstddef>
 
 namespace libetonyek
 {
 
-typedef std::string IWORKPropertyID_t;
+/** A dense property ID.
+  *
+  * The IDs are given by the position of the property in
+  * IWORK_PROPERTY_LIST, so they are known at compile time and can be
+  * used as indices.
+  */
+typedef unsigned IWORKPropertyID_t;
+
+/** All the properties.
+  *
+  * Every property declared by IWORK_DECLARE_PROPERTY must be listed
+  * here.
+  */
+#define IWORK_PROPERTY_LIST(X) \
+  X(Alignment) \
+  X(Baseline) \
+  X(BaselineShift) \
+  X(Bold) \
+  X(BottomBorder) \
+  X(Capitalization) \
+  X(Columns) \
+  X(DropCap) \
+  X(ExternalTextWrap) \
+  X(EvenPageMaster) \
+  X(Fill) \
+  X(FirstLineIndent) \
+  X(FirstPageMaster) \
+  X(FollowingLayoutStyle) \
+  X(FollowingParagraphStyle) \
+  X(FontColor) \
+  X(FontName) \
+  X(FontSize) \
+  X(Geometry) \
+  X(HeadLineEnd) \
+  X(Hyphenate) \
+  X(Italic) \
+  X(KeepLinesTogether) \
+  X(KeepWithNext) \
+  X(LabelCharacterStyle) \
+  X(Language) \
+  X(LayoutMargins) \
+  X(LayoutParagraphStyle) \
+  X(LayoutStyle) \
+  X(LeftBorder) \
+  X(LeftIndent) \
+  X(LineSpacing) \
+  X(ListLabelGeometry) \
+  X(ListLabelGeometries) \
+  X(ListLabelIndent) \
+  X(ListLabelIndents) \
+  X(ListLabelTypeInfo) \
+  X(ListLabelTypes) \
+  X(ListLevelStyles) \
+  X(ListStyle) \
+  X(ListTextIndent) \
+  X(ListTextIndents) \
+  X(Opacity) \
+  X(OddPageMaster) \
+  X(Outline) \
+  X(Padding) \
+  X(PageBreakBefore) \
+  X(ParagraphBorderType) \
+  X(ParagraphFill) \
+  X(ParagraphStroke) \
+  X(RightBorder) \
+  X(RightIndent) \
+  X(SFSeries) \
+  X(SFTAutoResizeProperty) \
+  X(SFC2DAreaFillProperty) \
+  X(SFC2DColumnFillProperty) \
+  X(SFC2DMixedColumnFillProperty) \
+  X(SFC2DPieFillProperty) \
+  X(SFC3DAreaFillProperty) \
+  X(SFC3DColumnFillProperty) \
+  X(SFC3DPieFillProperty) \
+  X(SFTableCellStylePropertyFill) \
+  X(SFTableStylePropertyCellStyle) \
+  X(SFTableStylePropertyHeaderColumnCellStyle) \
+  X(SFTableStylePropertyHeaderRowCellStyle) \
+  X(SFTCellStylePropertyDateTimeFormat) \
+  X(SFTCellStylePropertyDurationFormat) \
+  X(SFTCellStylePropertyNumberFormat) \
+  X(SFTCellStylePropertyLayoutStyle) \
+  X(SFTCellStylePropertyParagraphStyle) \
+  X(SFTDefaultBodyCellStyleProperty) \
+  X(SFTDefaultBodyVectorStyleProperty) \
+  X(SFTDefaultBorderVectorStyleProperty) \
+  X(SFTDefaultFooterBodyVectorStyleProperty) \
+  X(SFTDefaultFooterRowCellStyleProperty) \
+  X(SFTDefaultFooterSeparatorVectorStyleProperty) \
+  X(SFTDefaultGroupingLevelVectorStyleProperty) \
+  X(SFTDefaultGroupingRowCellStyleProperty) \
+  X(SFTDefaultHeaderBodyVectorStyleProperty) \
+  X(SFTDefaultHeaderColumnCellStyleProperty) \
+  X(SFTDefaultHeaderRowCellStyleProperty) \
+  X(SFTDefaultHeaderSeparatorVectorStyleProperty) \
+  X(SFTHeaderColumnRepeatsProperty) \
+  X(SFTHeaderRowRepeatsProperty) \
+  X(SFTStrokeProperty) \
+  X(SFTTableBandedCellFillProperty) \
+  X(SFTTableBandedRowsProperty) \
+  X(SFTTableNameStylePropertyLayoutStyle) \
+  X(SFTTableNameStylePropertyParagraphStyle) \
+  X(Shadow) \
+  X(SpaceAfter) \
+  X(SpaceBefore) \
+  X(Strikethru) \
+  X(Stroke) \
+  X(Tabs) \
+  X(TailLineEnd) \
+  X(TextBackground) \
+  X(TextShadow) \
+  X(TopBorder) \
+  X(TocStyle) \
+  X(Tracking) \
+  X(Underline) \
+  X(VerticalAlignment) \
+  X(WidowControl) \
+  X(WritingMode) \
+  X(AnimationAutoPlay) \
+  X(AnimationDelay) \
+  X(AnimationDuration) \
+  X(Transition)
+
+enum
+{
+#define IWORK_PROPERTY_ENUMERATOR(name) IWORK_PROPERTY_ID_##name,
+  IWORK_PROPERTY_LIST(IWORK_PROPERTY_ENUMERATOR)
+#undef IWORK_PROPERTY_ENUMERATOR
+  IWORK_PROPERTY_COUNT //!< the number of listed properties
+};
+
+/** The maximal number of properties.
+  *
+  * The IDs between IWORK_PROPERTY_COUNT and this are free for
+  * properties that are not part of the library (e.g., in tests).
+  */
+const std::size_t IWORK_PROPERTY_MAX = 128;
+
+static_assert(IWORK_PROPERTY_COUNT <= IWORK_PROPERTY_MAX, "too many properties");
 
 template<typename Name>
 struct IWORKPropertyInfo
@@ -33,11 +172,11 @@ template<> \
 struct IWORKPropertyInfo<property::name> \
 { \
   typedef type ValueType; \
-  static const IWORKPropertyID_t id; \
+  static const IWORKPropertyID_t id = IWORK_PROPERTY_ID_##name; \
 }
 
 #define IWORK_IMPLEMENT_PROPERTY(name) \
-const IWORKPropertyID_t IWORKPropertyInfo<property::name>::id = #name
+const IWORKPropertyID_t IWORKPropertyInfo<property::name>::id
 
 }
 
@@ -9,23 +9,54 @@
 
 #include "IWORKPropertyMap.h"
 
+#include <cassert>
+#include <cstddef>
+
 namespace libetonyek
 {
 
+namespace
+{
+
+const IWORKPropertyValue clearedValue;
+
+}
+
+IWORKPropertyValue::IWORKPropertyValue()
+  : m_empty(true)
+{
+}
+
+IWORKPropertyValue::IWORKPropertyValue(const bool empty)
+  : m_empty(empty)
+{
+}
+
+IWORKPropertyValue::~IWORKPropertyValue()
+{
+}
+
+IWORKPropertyMap::Data::Data()
+  : m_set()
+  , m_cleared()
+  , m_values()
+{
+}
+
 IWORKPropertyMap::IWORKPropertyMap()
-  : m_map()
+  : m_data()
   , m_parent(nullptr)
 {
 }
 
 IWORKPropertyMap::IWORKPropertyMap(const IWORKPropertyMap *const parent)
-  : m_map()
+  : m_data()
   , m_parent(parent)
 {
 }
 
 IWORKPropertyMap::IWORKPropertyMap(const IWORKPropertyMap &other)
-  : m_map(other.m_map)
+  : m_data(other.m_data)
   , m_parent(other.m_parent)
 {
 }
@@ -40,7 +71,7 @@ IWORKPropertyMap &IWORKPropertyMap::operator=(const IWORKPropertyMap &other)
 void IWORKPropertyMap::swap(IWORKPropertyMap &other)
 {
   using std::swap;
-  swap(m_map, other.m_map);
+  swap(m_data, other.m_data);
   swap(m_parent, other.m_parent);
 }
 
@@ -49,6 +80,90 @@ void IWORKPropertyMap::setParent(const IWORKPropertyMap *const parent)
   m_parent = parent;
 }
 
+IWORKPropertyMap IWORKPropertyMap::flatten() const
+{
+  return m_parent ? flatten(m_parent->flatten()) : flatten(IWORKPropertyMap());
+}
+
+IWORKPropertyMap IWORKPropertyMap::flatten(const IWORKPropertyMap &base) const
+{
+  IWORKPropertyMap flat;
+  if (!m_data)
+  {
+    flat.m_data = base.m_data;
+  }
+  else if (!base.m_data)
+  {
+    flat.m_data = m_data;
+  }
+  else
+  {
+    const Data &top = *m_data;
+    const Data &bottom = *base.m_data;
+    flat.m_data = std::make_shared<Data>();
+    Data &data = *flat.m_data;
+    // a property set or cleared in this map hides the one in base
+    data.m_set = top.m_set | (bottom.m_set & ~top.m_cleared);
+    data.m_cleared = top.m_cleared | (bottom.m_cleared & ~top.m_set);
+    data.m_values.reserve(data.m_set.count());
+    auto topIt = top.m_values.begin();
+    auto bottomIt = bottom.m_values.begin();
+    for (std::size_t id = 0; id != IWORK_PROPERTY_MAX; ++id)
+    {
+      if (top.m_set[id])
+        data.m_values.push_back(*topIt++);
+      else if (data.m_set[id])
+        data.m_values.push_back(*bottomIt);
+      if (bottom.m_set[id])
+        ++bottomIt;
+    }
+  }
+  return flat;
+}
+
+const IWORKPropertyValue *IWORKPropertyMap::getClearedValue()
+{
+  return &clearedValue;
+}
+
+void IWORKPropertyMap::set(const IWORKPropertyID_t id, const std::shared_ptr<const IWORKPropertyValue> &value)
+{
+  assert(id < IWORK_PROPERTY_MAX);
+  detach();
+  const auto it = m_data->m_values.begin() + std::ptrdiff_t(getIndex(m_data->m_set, id));
+  if (m_data->m_set[id])
+  {
+    *it = value;
+  }
+  else
+  {
+    m_data->m_values.insert(it, value);
+    m_data->m_set[id] = true;
+  }
+  m_data->m_cleared[id] = false;
+}
+
+void IWORKPropertyMap::reset(const IWORKPropertyID_t id)
+{
+  assert(id < IWORK_PROPERTY_MAX);
+  detach();
+  if (m_data->m_set[id])
+  {
+    m_data->m_values.erase(m_data->m_values.begin() + std::ptrdiff_t(getIndex(m_data->m_set, id)));
+    m_data->m_set[id] = false;
+  }
+  m_data->m_cleared[id] = true;
+}
+
+/// Make sure the data are not shared with another map.
+void IWORKPropertyMap::detach()
+{
+  if (!m_data)
+    m_data = std::make_shared<Data>();
+  else if (!m_data.unique())
+    m_data = std::make_shared<Data>(*m_data);
+}
+
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -10,16 +10,86 @@
 #ifndef IWORKPROPERTYMAP_H_INCLUDED
 #define IWORKPROPERTYMAP_H_INCLUDED
 
-#include <unordered_map>
-
-#include <boost/any.hpp>
+#include <bitset>
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <vector>
 
 #include "IWORKPropertyInfo.h"
 
 namespace libetonyek
 {
 
+/** The value of a property.
+  *
+  * The value itself is kept in a derived class, in its own type, so
+  * reading it needs no type check. A value without a type marks a
+  * cleared property.
+  */
+class IWORKPropertyValue
+{
+  // disable copying
+  IWORKPropertyValue(const IWORKPropertyValue &);
+  IWORKPropertyValue &operator=(const IWORKPropertyValue &);
+
+public:
+  IWORKPropertyValue();
+  virtual ~IWORKPropertyValue();
+
+  /** Check if this marks a cleared property.
+    */
+  bool empty() const
+  {
+    return m_empty;
+  }
+
+  /** Get the value of property @c Property.
+    *
+    * The value must have been created for that property.
+    */
+  template<class Property>
+  const typename IWORKPropertyInfo<Property>::ValueType &get() const;
+
+protected:
+  explicit IWORKPropertyValue(bool empty);
+
+private:
+  const bool m_empty;
+};
+
+namespace detail
+{
+
+template<typename T>
+class IWORKTypedPropertyValue : public IWORKPropertyValue
+{
+public:
+  explicit IWORKTypedPropertyValue(const T &value)
+    : IWORKPropertyValue(false)
+    , m_value(value)
+  {
+  }
+
+  const T m_value;
+};
+
+}
+
+template<class Property>
+const typename IWORKPropertyInfo<Property>::ValueType &IWORKPropertyValue::get() const
+{
+  assert(!m_empty);
+  return static_cast<const detail::IWORKTypedPropertyValue<typename IWORKPropertyInfo<Property>::ValueType> &>(*this).m_value;
+}
+
 /** Represents a (hierarchical) property map.
+  *
+  * The presence of a property is kept in a bitset indexed by the
+  * property ID, so checking a property is cheap. The values are kept
+  * in the order of their IDs, so the position of a value is the number
+  * of set properties with a lower ID. The values are shared by copies
+  * of the map until one of them is changed.
   */
 class IWORKPropertyMap
 {
@@ -27,7 +97,14 @@ public:
   class NotFoundException {};
 
 private:
-  typedef std::unordered_map<IWORKPropertyID_t, boost::any> Map_t;
+  struct Data
+  {
+    Data();
+
+    std::bitset<IWORK_PROPERTY_MAX> m_set; //!< the property has a value in this map
+    std::bitset<IWORK_PROPERTY_MAX> m_cleared; //!< the property is cleared in this map
+    std::vector<std::shared_ptr<const IWORKPropertyValue> > m_values; //!< values of set properties, in the order of their IDs
+  };
 
 public:
   /** Construct an empty map.
@@ -65,6 +142,22 @@ public:
     */
   void setParent(const IWORKPropertyMap *parent);
 
+  /** Get a map without parent that has the values of this map and all its parents.
+    *
+    * The values are shared with the original maps.
+    */
+  IWORKPropertyMap flatten() const;
+
+  /** Get a map without parent that has the values of this map over those of @c base.
+    *
+    * Parents of neither map are searched. The values are shared with
+    * the original maps.
+    *
+    * @arg[in] base the map providing the values not set or cleared in
+    * this map
+    */
+  IWORKPropertyMap flatten(const IWORKPropertyMap &base) const;
+
   /** Check for the presence of a property.
     *
     * If the property is not found in this map and @c lookInParent is @c
@@ -77,27 +170,15 @@ public:
   template<class Property>
   bool has(bool lookInParent = false) const
   {
-    const auto it = m_map.find(IWORKPropertyInfo<Property>::id);
-    if (m_map.end() != it)
-      return !it->second.empty();
-
-    if (lookInParent && m_parent)
-      return m_parent->has<Property>(lookInParent);
-
-    return false;
+    const IWORKPropertyValue *const value = lookup(getID<Property>(), lookInParent);
+    return value && !value->empty();
   }
 
   template<class Property>
   bool clears(bool lookInParent = false) const
   {
-    const auto it = m_map.find(IWORKPropertyInfo<Property>::id);
-    if (m_map.end() != it)
-      return it->second.empty();
-
-    if (lookInParent && m_parent)
-      return m_parent->clears<Property>(lookInParent);
-
-    return false;
+    const IWORKPropertyValue *const value = lookup(getID<Property>(), lookInParent);
+    return value && value->empty();
   }
 
   /** Retrieve the value of a property.
@@ -112,18 +193,10 @@ public:
   template<class Property>
   const typename IWORKPropertyInfo<Property>::ValueType &get(bool lookInParent = false) const
   {
-    const auto it = m_map.find(IWORKPropertyInfo<Property>::id);
-    if (m_map.end() != it)
-    {
-      if (!it->second.empty())
-        return boost::any_cast<const typename IWORKPropertyInfo<Property>::ValueType &>(it->second);
-    }
-    else if (lookInParent && m_parent)
-    {
-      return m_parent->get<Property>(lookInParent);
-    }
-
-    throw NotFoundException();
+    const IWORKPropertyValue *const value = lookup(getID<Property>(), lookInParent);
+    if (!value || value->empty())
+      throw NotFoundException();
+    return value->get<Property>();
   }
 
   /** Insert a new value for key @c key.
@@ -133,7 +206,8 @@ public:
   template<class Property>
   void put(const typename IWORKPropertyInfo<Property>::ValueType &value)
   {
-    m_map[IWORKPropertyInfo<Property>::id] = value;
+    typedef detail::IWORKTypedPropertyValue<typename IWORKPropertyInfo<Property>::ValueType> Value_t;
+    set(getID<Property>(), std::make_shared<Value_t>(value));
   }
 
   /** Clear property.
@@ -144,11 +218,57 @@ public:
   template<class Property>
   void clear()
   {
-    m_map[IWORKPropertyInfo<Property>::id] = boost::any();
+    reset(getID<Property>());
+  }
+
+  /** Find the value of a property by its ID.
+    *
+    * @arg[in] id the ID of the property
+    * @arg[in] lookInParent should the parent map be searched if the
+    * property is not found in this map?
+    * @returns the value, an empty value if the property is cleared, or
+    * @c nullptr if it is not found
+    */
+  const IWORKPropertyValue *lookup(const IWORKPropertyID_t id, const bool lookInParent = false) const
+  {
+    if (id >= IWORK_PROPERTY_MAX)
+      return nullptr;
+    for (const IWORKPropertyMap *map = this; map; map = lookInParent ? map->m_parent : nullptr)
+    {
+      const Data *const data = map->m_data.get();
+      if (!data)
+        continue;
+      if (data->m_set[id])
+        return data->m_values[getIndex(data->m_set, id)].get();
+      if (data->m_cleared[id])
+        return getClearedValue();
+    }
+    return nullptr;
   }
 
 private:
-  Map_t m_map;
+  template<class Property>
+  static IWORKPropertyID_t getID()
+  {
+    static_assert(IWORKPropertyInfo<Property>::id < IWORK_PROPERTY_MAX, "invalid property ID");
+    return IWORKPropertyInfo<Property>::id;
+  }
+
+  /// Get the position of the value of a set property.
+  static std::size_t getIndex(const std::bitset<IWORK_PROPERTY_MAX> &set, const IWORKPropertyID_t id)
+  {
+    // count the set properties with lower IDs
+    return (set << (IWORK_PROPERTY_MAX - id)).count();
+  }
+
+  static const IWORKPropertyValue *getClearedValue();
+
+  void set(IWORKPropertyID_t id, const std::shared_ptr<const IWORKPropertyValue> &value);
+  void reset(IWORKPropertyID_t id);
+  void detach();
+
+private:
+  std::shared_ptr<Data> m_data; //!< shared with copies until changed; empty if nothing has been inserted
   const IWORKPropertyMap *m_parent;
 };
 
@@ -0,0 +1,85 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "IWORKSharedStyles.h"
+
+namespace libetonyek
+{
+
+namespace
+{
+
+void appendString(const char *const str, std::string &key)
+{
+  const std::string::size_type length = std::char_traits<char>::length(str);
+  key.append(std::to_string(length));
+  key.push_back(':');
+  key.append(str, length);
+}
+
+/// Serialize the properties, so that only identical lists get the same key.
+void appendKey(const librevenge::RVNGPropertyList &propList, std::string &key)
+{
+  key.push_back('{');
+  librevenge::RVNGPropertyList::Iter it(propList);
+  for (it.rewind(); it.next();)
+  {
+    appendString(it.key(), key);
+    if (const librevenge::RVNGPropertyListVector *const child = it.child())
+    {
+      key.push_back('[');
+      for (unsigned long i = 0; i != child->count(); ++i)
+        appendKey((*child)[i], key);
+      key.push_back(']');
+    }
+    else if (it())
+    {
+      appendString(it()->getStr().cstr(), key);
+    }
+  }
+  key.push_back('}');
+}
+
+}
+
+IWORKSharedStyles::IWORKSharedStyles(const char *const idName)
+  : m_idName(idName)
+  , m_ids()
+  , m_key()
+{
+}
+
+librevenge::RVNGPropertyList IWORKSharedStyles::share(const librevenge::RVNGPropertyList &propList, librevenge::RVNGPropertyList &definition)
+{
+  if (propList.empty())
+    return propList;
+
+  m_key.clear();
+  appendKey(propList, m_key);
+
+  librevenge::RVNGPropertyList ref;
+  const auto it = m_ids.find(m_key);
+  if (it != m_ids.end())
+  {
+    ref.insert(m_idName, it->second);
+  }
+  else
+  {
+    const int id = int(m_ids.size());
+    m_ids.insert(std::make_pair(m_key, id));
+    definition = propList;
+    definition.insert(m_idName, id);
+    ref.insert(m_idName, id);
+  }
+  return ref;
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
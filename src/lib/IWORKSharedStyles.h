@@ -0,0 +1,60 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef IWORKSHAREDSTYLES_H_INCLUDED
+#define IWORKSHAREDSTYLES_H_INCLUDED
+
+#include <string>
+#include <unordered_map>
+
+#include <librevenge/librevenge.h>
+
+namespace libetonyek
+{
+
+/** Gives the same ID to identical styles.
+  *
+  * A style seen for the first time has to be defined, e.g., by
+  * defineCharacterStyle(), together with its ID. Then it is enough to
+  * refer to it by the ID.
+  */
+class IWORKSharedStyles
+{
+  // disable copying
+  IWORKSharedStyles(const IWORKSharedStyles &);
+  IWORKSharedStyles &operator=(const IWORKSharedStyles &);
+
+public:
+  /** Construct an empty set of styles.
+    *
+    * @arg[in] idName the name of the property holding the ID of a style
+    * (e.g., librevenge:span-id)
+    */
+  explicit IWORKSharedStyles(const char *idName);
+
+  /** Find the style with properties @c propList.
+    *
+    * @arg[in] propList the properties of the style
+    * @arg[out] definition the properties the style has to be defined
+    * with, if it is new; untouched otherwise
+    * @returns the properties referring to the style
+    */
+  librevenge::RVNGPropertyList share(const librevenge::RVNGPropertyList &propList, librevenge::RVNGPropertyList &definition);
+
+private:
+  const char *const m_idName;
+  std::unordered_map<std::string, int> m_ids;
+  std::string m_key; //!< kept to reuse the buffer
+};
+
+}
+
+#endif // IWORKSHAREDSTYLES_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -16,9 +16,17 @@ namespace libetonyek
 
 IWORKSpreadsheetRedirector::IWORKSpreadsheetRedirector(librevenge::RVNGSpreadsheetInterface *const iface)
   : m_iface(iface)
+  , m_shareStyles(false)
+  , m_paragraphStyles("librevenge:paragraph-id")
+  , m_characterStyles("librevenge:span-id")
 {
 }
 
+void IWORKSpreadsheetRedirector::setShareStyles(const bool share)
+{
+  m_shareStyles = share;
+}
+
 void IWORKSpreadsheetRedirector::setDocumentMetaData(const librevenge::RVNGPropertyList &propList)
 {
   m_iface->setDocumentMetaData(propList);
@@ -109,7 +117,16 @@ void IWORKSpreadsheetRedirector::defineParagraphStyle(const librevenge::RVNGProp
 
 void IWORKSpreadsheetRedirector::openParagraph(const librevenge::RVNGPropertyList &propList)
 {
-  m_iface->openParagraph(propList);
+  if (m_shareStyles)
+  {
+    librevenge::RVNGPropertyList definition;
+    const librevenge::RVNGPropertyList ref(m_paragraphStyles.share(propList, definition));
+    if (!definition.empty())
+      m_iface->defineParagraphStyle(definition);
+    m_iface->openParagraph(ref);
+  }
+  else
+    m_iface->openParagraph(propList);
 }
 void IWORKSpreadsheetRedirector::closeParagraph()
 {
@@ -123,7 +140,16 @@ void IWORKSpreadsheetRedirector::defineCharacterStyle(const librevenge::RVNGProp
 
 void IWORKSpreadsheetRedirector::openSpan(const librevenge::RVNGPropertyList &propList)
 {
-  m_iface->openSpan(propList);
+  if (m_shareStyles)
+  {
+    librevenge::RVNGPropertyList definition;
+    const librevenge::RVNGPropertyList ref(m_characterStyles.share(propList, definition));
+    if (!definition.empty())
+      m_iface->defineCharacterStyle(definition);
+    m_iface->openSpan(ref);
+  }
+  else
+    m_iface->openSpan(propList);
 }
 void IWORKSpreadsheetRedirector::closeSpan()
 {
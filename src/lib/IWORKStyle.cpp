@@ -9,6 +9,12 @@
 
 #include "IWORKStyle.h"
 
+#include <algorithm>
+
+#ifdef WITH_THREADS
+#include <mutex>
+#endif
+
 #include "libetonyek_utils.h"
 #include "IWORKStyleStack.h"
 
@@ -17,22 +23,67 @@
 namespace libetonyek
 {
 
+namespace
+{
+
+#ifdef WITH_THREADS
+// styles can be linked by parsers running in more threads
+std::mutex styleMutex;
+#endif
+
+/// Guards the links between styles and the rebuilding of flattened properties.
+struct StyleLock
+{
+  StyleLock()
+#ifdef WITH_THREADS
+    : m_lock(styleMutex)
+#endif
+  {
+  }
+
+#ifdef WITH_THREADS
+  const std::lock_guard<std::mutex> m_lock;
+#endif
+};
+
+}
+
 IWORKStyle::IWORKStyle(const IWORKPropertyMap &props, const boost::optional<std::string> &ident, const boost::optional<std::string> &parentIdent)
   : m_props(props)
+  , m_flat()
+  , m_children()
   , m_ident(ident)
   , m_parentIdent(parentIdent)
   , m_parent()
 {
+  changed();
 }
 
 IWORKStyle::IWORKStyle(const IWORKPropertyMap &props, const boost::optional<std::string> &ident, const IWORKStylePtr_t &parent)
   : m_props(props)
+  , m_flat()
+  , m_children()
   , m_ident(ident)
   , m_parentIdent()
-  , m_parent(parent)
+  , m_parent()
+{
+  if (parent)
+    setParent(parent);
+  else
+    changed();
+}
+
+IWORKStyle::~IWORKStyle()
 {
+  // the children keep the style alive, so there are none left
+  assert(m_children.empty());
   if (m_parent)
-    m_props.setParent(&m_parent->getPropertyMap());
+  {
+    // the parent may go away with us, so it must not be released under the lock
+    const IWORKStylePtr_t parent(m_parent);
+    StyleLock lock;
+    attach(IWORKStylePtr_t());
+  }
 }
 
 bool IWORKStyle::link(const IWORKStylesheetPtr_t &stylesheet)
@@ -52,11 +103,11 @@ bool IWORKStyle::link(const IWORKStylesheetPtr_t &stylesheet)
     ETONYEK_DEBUG_MSG(("IWORKStyle::find: can not find parent %s\n", m_parentIdent.get().c_str()));
     return false;
   }
-  m_parent=currentStylesheet->find(m_parentIdent.get());
-  if (m_parent)
-    m_props.setParent(&m_parent->getPropertyMap());
+  const IWORKStylePtr_t parent = currentStylesheet->find(m_parentIdent.get());
+  if (parent)
+    setParent(parent);
 
-  return bool(m_parent);
+  return bool(parent);
 }
 
 void IWORKStyle::flatten()
@@ -69,9 +120,35 @@ const IWORKPropertyMap &IWORKStyle::getPropertyMap() const
   return m_props;
 }
 
-IWORKPropertyMap &IWORKStyle::getPropertyMap()
+void IWORKStyle::changed()
 {
-  return m_props;
+  StyleLock lock;
+  update();
+}
+
+/// Rebuild the flattened properties of the style and of all styles inheriting from it.
+void IWORKStyle::update()
+{
+  m_flat = m_parent ? m_props.flatten(m_parent->m_flat) : m_props.flatten();
+  for (const auto &child : m_children)
+    child->update();
+}
+
+/// Move the style to the children of another parent. The lock must be held.
+void IWORKStyle::attach(const IWORKStylePtr_t &parent)
+{
+  if (parent)
+    parent->m_children.push_back(this);
+  if (m_parent)
+  {
+    std::vector<IWORKStyle *> &siblings = m_parent->m_children;
+    const auto it = std::find(siblings.begin(), siblings.end(), this);
+    assert(it != siblings.end());
+    *it = siblings.back();
+    siblings.pop_back();
+  }
+  m_parent = parent;
+  m_props.setParent(m_parent ? &m_parent->m_props : nullptr);
 }
 
 const boost::optional<std::string> &IWORKStyle::getIdent() const
@@ -91,9 +168,12 @@ const IWORKStylePtr_t IWORKStyle::getParent() const
 
 void IWORKStyle::setParent(const IWORKStylePtr_t parent)
 {
-  m_parent=parent;
-  if (m_parent)
-    m_props.setParent(&m_parent->getPropertyMap());
+  // the old parent may go away, so it must not be released under the lock
+  const IWORKStylePtr_t oldParent(m_parent);
+  StyleLock lock;
+  if (parent != m_parent)
+    attach(parent);
+  update();
 }
 
 void IWORKStyle::createListLevelStyles()
@@ -132,6 +212,7 @@ void IWORKStyle::createListLevelStyles()
   for (std::size_t i = 0; i != levels; ++i)
     levelsStyle[unsigned(i)] = std::make_shared<IWORKStyle>(levelProps[i], boost::none, boost::none);
   m_props.put<ListLevelStyles>(levelsStyle);
+  changed();
 }
 
 }
@@ -12,7 +12,9 @@
 
 #include "IWORKStyle_fwd.h"
 
-#include <boost/any.hpp>
+#include <memory>
+#include <vector>
+
 #include <boost/optional.hpp>
 
 #include "IWORKPropertyMap.h"
@@ -24,12 +26,24 @@ namespace libetonyek
 class IWORKStyleStack;
 
 /** Represents a hierarchical style.
+  *
+  * A style keeps a flattened view of all its properties, including the
+  * inherited ones, so looking up a property does not walk the parent
+  * styles. The view is rebuilt whenever the style or one of its parents
+  * changes, never on lookup. A style must not be changed while its
+  * properties, or those of a style inheriting from it, are being looked
+  * up by another thread.
   */
 class IWORKStyle
 {
+  // disable copying
+  IWORKStyle(const IWORKStyle &);
+  IWORKStyle &operator=(const IWORKStyle &);
+
 public:
   IWORKStyle(const IWORKPropertyMap &props, const boost::optional<std::string> &ident, const boost::optional<std::string> &parentIdent);
   IWORKStyle(const IWORKPropertyMap &props, const boost::optional<std::string> &ident, const IWORKStylePtr_t &parent);
+  ~IWORKStyle();
 
   /** Find the parent style by its ID.
     *
@@ -48,10 +62,6 @@ public:
     */
   const IWORKPropertyMap &getPropertyMap() const;
 
-  /** Get the style's property map.
-    */
-  IWORKPropertyMap &getPropertyMap();
-
   /** Check for the presence of a property.
     *
     * @returns true if the property is present
@@ -59,7 +69,8 @@ public:
   template<class Property>
   bool has() const
   {
-    return m_props.has<Property>(true);
+    const IWORKPropertyValue *const value = lookup(IWORKPropertyInfo<Property>::id);
+    return value && !value->empty();
   }
 
   /** Retrieve the value of a property.
@@ -69,7 +80,44 @@ public:
   template<class Property>
   const typename IWORKPropertyInfo<Property>::ValueType &get() const
   {
-    return m_props.get<Property>(true);
+    const IWORKPropertyValue *const value = lookup(IWORKPropertyInfo<Property>::id);
+    if (!value || value->empty())
+      throw IWORKPropertyMap::NotFoundException();
+    return value->get<Property>();
+  }
+
+  /** Set a property of the style.
+    *
+    * The styles inheriting from this one see the new value too.
+    *
+    * @arg[in] value the value to set
+    */
+  template<class Property>
+  void put(const typename IWORKPropertyInfo<Property>::ValueType &value)
+  {
+    m_props.put<Property>(value);
+    changed();
+  }
+
+  /** Clear a property of the style.
+    *
+    * The styles inheriting from this one see the change too.
+    */
+  template<class Property>
+  void clear()
+  {
+    m_props.clear<Property>();
+    changed();
+  }
+
+  /** Find the value of a property in the style or its parents.
+    *
+    * @returns the value, an empty value if the property is cleared, or
+    * @c nullptr if it is not found
+    */
+  const IWORKPropertyValue *lookup(const IWORKPropertyID_t id) const
+  {
+    return m_flat.lookup(id);
   }
 
   const boost::optional<std::string> &getIdent() const;
@@ -83,8 +131,15 @@ protected:
   const boost::optional<std::string> &getParentIdent() const;
   const IWORKStylePtr_t getParent() const;
 
+private:
+  void changed();
+  void update();
+  void attach(const IWORKStylePtr_t &parent);
+
 private:
   IWORKPropertyMap m_props;
+  IWORKPropertyMap m_flat; //!< the properties of the style and its parents
+  std::vector<IWORKStyle *> m_children; //!< the styles having this one as parent
 
   const boost::optional<std::string> m_ident;
   const boost::optional<std::string> m_parentIdent;
@@ -50,6 +50,20 @@ void IWORKStyleStack::set(const IWORKStylePtr_t &style)
   m_stack.front() = style;
 }
 
+const IWORKPropertyValue *IWORKStyleStack::lookup(const IWORKPropertyID_t id, const bool lookInParent) const
+{
+  for (const auto &it : m_stack)
+  {
+    if (it)
+    {
+      const IWORKPropertyValue *const value = lookInParent ? it->lookup(id) : it->getPropertyMap().lookup(id);
+      if (value)
+        return value;
+    }
+  }
+  return nullptr;
+}
+
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -12,7 +12,6 @@
 
 #include <deque>
 
-#include <boost/any.hpp>
 
 #include "IWORKStyle.h"
 
@@ -68,35 +67,22 @@ public:
   template<class Property>
   bool has(const bool lookInParent = true) const
   {
-    for (auto it = m_stack.begin(); m_stack.end() != it; ++it)
-    {
-      if (*it)
-      {
-        if ((*it)->getPropertyMap().has<Property>(lookInParent))
-          return true;
-        else if ((*it)->getPropertyMap().clears<Property>(lookInParent))
-          break;
-      }
-    }
-    return false;
+    const IWORKPropertyValue *const value = lookup(IWORKPropertyInfo<Property>::id, lookInParent);
+    return value && !value->empty();
   }
 
   template<class Property>
   const typename IWORKPropertyInfo<Property>::ValueType &get(const bool lookInParent = true) const
   {
-    for (auto it = m_stack.begin(); m_stack.end() != it; ++it)
-    {
-      if (*it)
-      {
-        if ((*it)->getPropertyMap().has<Property>(lookInParent))
-          return (*it)->getPropertyMap().get<Property>(lookInParent);
-        else if ((*it)->getPropertyMap().clears<Property>(lookInParent))
-          break;
-      }
-    }
-    throw IWORKPropertyMap::NotFoundException();
+    const IWORKPropertyValue *const value = lookup(IWORKPropertyInfo<Property>::id, lookInParent);
+    if (!value || value->empty())
+      throw IWORKPropertyMap::NotFoundException();
+    return value->get<Property>();
   }
 
+private:
+  const IWORKPropertyValue *lookup(IWORKPropertyID_t id, bool lookInParent) const;
+
 private:
   Stack_t m_stack;
 };
@@ -9,6 +9,7 @@
 
 #include "IWORKTable.h"
 
+#include <algorithm>
 #include <cassert>
 #include <ctime>
 #include <iomanip>
@@ -22,6 +23,7 @@
 #include "libetonyek_xml.h"
 #include "libetonyek_utils.h"
 #include "IWORKDocumentInterface.h"
+#include "IWORKMediaCache.h"
 #include "IWORKProperties.h"
 #include "IWORKStyle.h"
 #include "IWORKStyleStack.h"
@@ -41,6 +43,13 @@ namespace libetonyek
 namespace
 {
 
+// the id of a missing value, style or extra data of a cell
+const unsigned NO_ID = unsigned(-1);
+// the type tag of a covered cell
+const unsigned char COVERED_CELL = 0xff;
+// a result of IWORKTable::Row::find()
+const std::size_t NO_CELL = std::size_t(-1);
+
 void parseDateTimeFormat(std::string const &format, librevenge::RVNGPropertyList &props, boost::optional<std::string> &rvngValueType)
 {
   if (format.empty())
@@ -240,7 +249,7 @@ void writeCellStyle(librevenge::RVNGPropertyList &props, const IWORKStyleStack &
 bool writeCellValue(librevenge::RVNGPropertyList &props,
                     const boost::optional<std::string> &styleName,
                     const IWORKCellType type, const boost::optional<std::string> &valueType,
-                    const boost::optional<std::string> &value, const boost::optional<IWORKDateTimeData> &dateTime)
+                    const std::string *const value, const boost::optional<IWORKDateTimeData> &dateTime)
 try
 {
   using namespace property;
@@ -254,13 +263,13 @@ try
     if (valueType)
     {
       props.insert("librevenge:value-type", get(valueType).c_str());
-      props.insert("librevenge:value", value ? get(value).c_str() : "0");
+      props.insert("librevenge:value", value ? value->c_str() : "0");
       return true;
     }
     else if (value)
     {
       props.insert("librevenge:value-type", "double");
-      props.insert("librevenge:value", get(value).c_str());
+      props.insert("librevenge:value", value->c_str());
       return true;
     }
     break;
@@ -281,7 +290,7 @@ try
       }
       else
       {
-        boost::optional<double> seconds=try_double_cast(get(value).c_str());
+        boost::optional<double> seconds=try_double_cast(value->c_str());
         if (!seconds)
         {
           ETONYEK_DEBUG_MSG(("writeCellValue[IWORKTable.cpp]: can not read seconds\n"));
@@ -308,7 +317,7 @@ try
   case IWORK_CELL_TYPE_DURATION :
     if (value)
     {
-      const int seconds = int(double_cast(get(value).c_str()));
+      const int seconds = int(double_cast(value->c_str()));
       props.insert("librevenge:value-type", valueType ? get(valueType).c_str() : "time");
       props.insert("librevenge:hours", int(seconds / 3600));
       props.insert("librevenge:minutes", int((seconds % 3600) / 60));
@@ -318,7 +327,7 @@ try
     break;
   case IWORK_CELL_TYPE_BOOL :
     props.insert("librevenge:value-type", valueType ? get(valueType).c_str() : "boolean");
-    props.insert("librevenge:value", value ? get(value).c_str() : "0");  // false is default
+    props.insert("librevenge:value", value ? value->c_str() : "0");  // false is default
     return true;
   case IWORK_CELL_TYPE_TEXT :
   default:
@@ -335,7 +344,7 @@ catch (...)
   return false;
 }
 
-librevenge::RVNGString convertCellValueInText(const IWORKStyleStack &style, const IWORKCellType type, const boost::optional<std::string> &value, const boost::optional<IWORKDateTimeData> &dateTime)
+librevenge::RVNGString convertCellValueInText(const IWORKStyleStack &style, const IWORKCellType type, const std::string *const value, const boost::optional<IWORKDateTimeData> &dateTime)
 {
   try
   {
@@ -354,7 +363,7 @@ librevenge::RVNGString convertCellValueInText(const IWORKStyleStack &style, cons
         formatType=format.m_type;
         currency=format.m_currencyCode.c_str();
       }
-      const double val = value ? double_cast(get(value).c_str()) : 0;
+      const double val = value ? double_cast(value->c_str()) : 0;
       std::stringstream s;
       if (numDecimals>=0 && numDecimals<100)  // 65535 means default
         s << std::setprecision(-numDecimals);
@@ -390,7 +399,7 @@ librevenge::RVNGString convertCellValueInText(const IWORKStyleStack &style, cons
         return res;
       }
       if (!value) break;
-      boost::optional<double> seconds=try_double_cast(get(value).c_str());
+      boost::optional<double> seconds=try_double_cast(value->c_str());
       if (!seconds)
       {
         ETONYEK_DEBUG_MSG(("convertCellValueInText: can not read seconds\n"));
@@ -408,13 +417,13 @@ librevenge::RVNGString convertCellValueInText(const IWORKStyleStack &style, cons
     case IWORK_CELL_TYPE_DURATION :
     {
       if (!value) break;
-      const int seconds = int(double_cast(get(value).c_str()));
+      const int seconds = int(double_cast(value->c_str()));
       librevenge::RVNGString res;
       res.sprintf("%d:%d:%d", int(seconds / 3600), int((seconds % 3600) / 60), int((seconds % 3600) % 60));
       return res;
     }
     case IWORK_CELL_TYPE_BOOL :
-      return value && get(value)!="0" ? "true" : "false";
+      return value && *value!="0" ? "true" : "false";
     case IWORK_CELL_TYPE_TEXT :
     default:
       break;
@@ -429,28 +438,90 @@ librevenge::RVNGString convertCellValueInText(const IWORKStyleStack &style, cons
 
 }
 
-IWORKTable::Cell::Cell()
+IWORKTable::CellExtra::CellExtra()
   : m_content()
   , m_columnSpan(1)
   , m_rowSpan(1)
-  , m_covered(false)
   , m_formula()
   , m_formulaHC()
-  , m_style()
-  , m_type(IWORK_CELL_TYPE_TEXT)
-  , m_value()
   , m_dateTime()
 {
 }
 
+IWORKTable::Row::Row()
+  : m_columns()
+  , m_types()
+  , m_values()
+  , m_styles()
+  , m_extras()
+  , m_cellExtras()
+{
+}
+
+std::size_t IWORKTable::Row::find(const unsigned column) const
+{
+  const auto it = std::lower_bound(m_columns.begin(), m_columns.end(), column);
+  if ((it == m_columns.end()) || (*it != column))
+    return NO_CELL;
+  return std::size_t(it - m_columns.begin());
+}
+
+std::size_t IWORKTable::Row::insert(const unsigned column)
+{
+  const auto it = std::lower_bound(m_columns.begin(), m_columns.end(), column);
+  const auto offset = it - m_columns.begin();
+  if ((it == m_columns.end()) || (*it != column))
+  {
+    m_columns.insert(it, column);
+    m_types.insert(m_types.begin() + offset, IWORK_CELL_TYPE_TEXT);
+    m_values.insert(m_values.begin() + offset, NO_ID);
+    m_styles.insert(m_styles.begin() + offset, NO_ID);
+    m_extras.insert(m_extras.begin() + offset, NO_ID);
+  }
+  return std::size_t(offset);
+}
+
+IWORKTable::CellExtra &IWORKTable::Row::getExtra(const std::size_t index)
+{
+  if (m_extras[index] == NO_ID)
+  {
+    m_extras[index] = unsigned(m_cellExtras.size());
+    m_cellExtras.push_back(CellExtra());
+  }
+  return m_cellExtras[m_extras[index]];
+}
+
+void IWORKTable::Row::removeExtra(const std::size_t index)
+{
+  const unsigned extra = m_extras[index];
+  if (extra == NO_ID)
+    return;
+  m_extras[index] = NO_ID;
+
+  // move the last extra data to the freed place
+  const unsigned last = unsigned(m_cellExtras.size() - 1);
+  if (extra != last)
+  {
+    std::swap(m_cellExtras[extra], m_cellExtras[last]);
+    *std::find(m_extras.begin(), m_extras.end(), last) = extra;
+  }
+  m_cellExtras.pop_back();
+}
+
 IWORKTable::IWORKTable(const IWORKTableNameMapPtr_t &tableNameMap, IWORKFormatNameMap &formatNameMap, const IWORKLanguageManager &langManager)
   : m_tableNameMap(tableNameMap)
   , m_langManager(langManager)
   , m_formatNameMap(formatNameMap)
   , m_commentMap()
   , m_table()
+  , m_cellValueIds()
+  , m_cellValues()
+  , m_cellStyleIds()
+  , m_cellStyles()
   , m_style()
   , m_name()
+  , m_nameOnWrite(false)
+  , m_globalId()
   , m_order()
   , m_columnSizes()
   , m_rowSizes()
@@ -467,6 +538,10 @@ IWORKTable::IWORKTable(const IWORKTableNameMapPtr_t &tableNameMap, IWORKFormatNa
   , m_headerRowsRepeated(false)
   , m_headerColumnsRepeated(false)
   , m_recorder()
+  , m_mediaCache(std::make_shared<IWORKMediaCache>())
+  , m_streamSink()
+  , m_streamAsSimpleTable(false)
+  , m_flushedRows(0)
 {
 }
 
@@ -480,9 +555,24 @@ const std::shared_ptr<IWORKTableRecorder> &IWORKTable::getRecorder() const
   return m_recorder;
 }
 
+void IWORKTable::setMediaCache(const std::shared_ptr<IWORKMediaCache> &mediaCache)
+{
+  assert(bool(mediaCache));
+  m_mediaCache = mediaCache;
+}
+
 void IWORKTable::setName(std::string const &name)
 {
   m_name=name;
+  m_nameOnWrite=false;
+  m_globalId.reset();
+}
+
+void IWORKTable::setNameOnWrite(std::string const &name, const boost::optional<std::string> &globalId)
+{
+  m_name=name;
+  m_nameOnWrite=true;
+  m_globalId=globalId;
 }
 
 void IWORKTable::setSize(const unsigned columns, const unsigned rows)
@@ -567,7 +657,7 @@ void IWORKTable::setSizes(const IWORKColumnSizes_t &columnSizes, const IWORKRowS
   m_rowSizes = rowSizes;
 
   // init. content table of appropriate dimensions
-  m_table = Table_t(m_rowSizes.size(), Row_t());
+  m_table = Table_t(m_rowSizes.size(), Row());
 }
 
 void IWORKTable::setBorders(const IWORKGridLineMap_t &verticalLines, const IWORKGridLineMap_t &horizontalLines)
@@ -589,6 +679,11 @@ void IWORKTable::setComment(unsigned column, unsigned row, IWORKOutputElements c
     m_recorder->setComment(column,row,text);
     return;
   }
+  if (row < m_flushedRows)
+  {
+    ETONYEK_DEBUG_MSG(("IWORKTable::setComment: row %u is already drawn\n", row));
+    return;
+  }
   m_commentMap[std::make_pair(row,column)]=text;
 }
 
@@ -617,8 +712,25 @@ void IWORKTable::insertCell(const unsigned column, const unsigned row, const boo
 
   if ((m_rowSizes.size() <= row) || (m_columnSizes.size() <= column))
     return;
+  if (row < m_flushedRows)
+  {
+    ETONYEK_DEBUG_MSG(("IWORKTable::insertCell: row %u is already drawn\n", row));
+    return;
+  }
+
+  Row &cells = m_table[row];
+  const std::size_t index = cells.insert(column);
+  cells.m_types[index] = static_cast<unsigned char>(type);
+  cells.m_values[index] = value ? internValue(get(value)) : NO_ID;
+  cells.m_styles[index] = internStyle(style);
+  if (!text && (columnSpan <= 1) && (rowSpan <= 1) && !formula && !formulaHC && !dateTime)
+  {
+    cells.removeExtra(index);
+    return;
+  }
 
-  Cell cell;
+  CellExtra &extra = cells.getExtra(index);
+  extra = CellExtra();
   if (bool(text))
   {
     IWORKStyleStack fStyle;
@@ -633,17 +745,13 @@ void IWORKTable::insertCell(const unsigned column, const unsigned row, const boo
       text->pushBaseLayoutStyle(fStyle.get<SFTCellStylePropertyLayoutStyle>());
     else
       text->pushBaseLayoutStyle(getDefaultLayoutStyle(column,row));
-    text->draw(cell.m_content);
+    text->draw(extra.m_content);
   }
-  cell.m_columnSpan = columnSpan;
-  cell.m_rowSpan = rowSpan;
-  cell.m_formula = formula;
-  cell.m_formulaHC = formulaHC;
-  cell.m_style = style;
-  cell.m_type = type;
-  cell.m_value = value;
-  cell.m_dateTime = dateTime;
-  m_table[row][column] = cell;
+  extra.m_columnSpan = columnSpan;
+  extra.m_rowSpan = rowSpan;
+  extra.m_formula = formula;
+  extra.m_formulaHC = formulaHC;
+  extra.m_dateTime = dateTime;
 }
 
 void IWORKTable::insertCoveredCell(const unsigned column, const unsigned row)
@@ -656,10 +764,56 @@ void IWORKTable::insertCoveredCell(const unsigned column, const unsigned row)
 
   if ((m_rowSizes.size() <= row) || (m_columnSizes.size() <= column))
     return;
+  if (row < m_flushedRows)
+  {
+    ETONYEK_DEBUG_MSG(("IWORKTable::insertCoveredCell: row %u is already drawn\n", row));
+    return;
+  }
 
-  Cell cell;
-  cell.m_covered = true;
-  m_table[row][column] = cell;
+  Row &cells = m_table[row];
+  const std::size_t index = cells.insert(column);
+  cells.m_types[index] = COVERED_CELL;
+  cells.m_values[index] = NO_ID;
+  cells.m_styles[index] = NO_ID;
+  cells.removeExtra(index);
+}
+
+unsigned IWORKTable::internValue(const std::string &value)
+{
+  const auto it = m_cellValueIds.insert(std::make_pair(value, unsigned(m_cellValues.size())));
+  if (it.second)
+    m_cellValues.push_back(&it.first->first);
+  return it.first->second;
+}
+
+void IWORKTable::releaseValues()
+{
+  std::unordered_map<std::string, unsigned> valueIds;
+  std::vector<const std::string *> values;
+  for (auto r = m_flushedRows; r < m_table.size(); ++r)
+  {
+    for (auto &value : m_table[r].m_values)
+    {
+      if (value == NO_ID)
+        continue;
+      const auto it = valueIds.insert(std::make_pair(*m_cellValues[value], unsigned(values.size())));
+      if (it.second)
+        values.push_back(&it.first->first);
+      value = it.first->second;
+    }
+  }
+  m_cellValueIds.swap(valueIds);
+  m_cellValues.swap(values);
+}
+
+unsigned IWORKTable::internStyle(const IWORKStylePtr_t &style)
+{
+  if (!style)
+    return NO_ID;
+  const auto it = m_cellStyleIds.insert(std::make_pair(style.get(), unsigned(m_cellStyles.size())));
+  if (it.second)
+    m_cellStyles.push_back(style);
+  return it.first->second;
 }
 
 boost::optional<std::string> IWORKTable::writeFormat(IWORKOutputElements &elements, const IWORKStylePtr_t &style, const IWORKCellType type, boost::optional<std::string> &rvngValueType)
@@ -741,9 +895,78 @@ boost::optional<std::string> IWORKTable::writeFormat(IWORKOutputElements &elemen
 void IWORKTable::draw(const librevenge::RVNGPropertyList &tableProps, IWORKOutputElements &elements, bool drawAsSimpleTable)
 {
   assert(!m_recorder);
+  assert(!m_streamSink);
+
+  openTable(tableProps, elements, drawAsSimpleTable);
+  for (unsigned r = 0; m_table.size() != r; ++r)
+    drawRow(r, elements, drawAsSimpleTable);
+  elements.addCloseTable();
+}
+
+void IWORKTable::startStreaming(const librevenge::RVNGPropertyList &tableProps, const bool drawAsSimpleTable, const StreamSink_t &sink)
+{
+  assert(!m_recorder);
+  assert(!m_streamSink);
+  assert(bool(sink));
+
+  m_streamSink = sink;
+  m_streamAsSimpleTable = drawAsSimpleTable;
+  m_flushedRows = 0;
+
+  IWORKOutputElements elements;
+  openTable(tableProps, elements, drawAsSimpleTable);
+  m_streamSink(elements);
+}
+
+bool IWORKTable::isStreaming() const
+{
+  return bool(m_streamSink);
+}
+
+void IWORKTable::flushRows(const unsigned row)
+{
+  if (!m_streamSink)
+    return;
+
+  IWORKOutputElements elements;
+  const unsigned lastRow = std::min(row, unsigned(m_table.size()));
+  for (; m_flushedRows < lastRow; ++m_flushedRows)
+  {
+    drawRow(m_flushedRows, elements, m_streamAsSimpleTable);
+
+    // the row is final now, so release its content
+    m_table[m_flushedRows] = Row();
+    m_commentMap.erase(m_commentMap.lower_bound(std::make_pair(m_flushedRows, 0u)),
+                       m_commentMap.lower_bound(std::make_pair(m_flushedRows + 1, 0u)));
+  }
+  if (!elements.empty())
+  {
+    releaseValues();
+    m_streamSink(elements);
+  }
+}
+
+void IWORKTable::endStreaming()
+{
+  if (!m_streamSink)
+    return;
+
+  flushRows(unsigned(m_table.size()));
+  IWORKOutputElements elements;
+  elements.addCloseTable();
+  m_streamSink(elements);
+  m_streamSink = StreamSink_t();
+}
 
+std::size_t IWORKTable::getValueCount() const
+{
+  return m_cellValues.size();
+}
+
+void IWORKTable::openTable(const librevenge::RVNGPropertyList &tableProps, IWORKOutputElements &elements, const bool drawAsSimpleTable) const
+{
   librevenge::RVNGPropertyList allTableProps(tableProps);
-  if (m_name)
+  if (m_name && !m_nameOnWrite)
     allTableProps.insert("librevenge:sheet-name", get(m_name).c_str());
 
   librevenge::RVNGPropertyListVector columnSizes;
@@ -761,8 +984,15 @@ void IWORKTable::draw(const librevenge::RVNGPropertyList &tableProps, IWORKOutpu
 
   allTableProps.insert(drawAsSimpleTable ? "librevenge:table-columns" : "librevenge:columns", columnSizes);
 
-  elements.addOpenTable(allTableProps);
-  unsigned numColumns=unsigned(m_columnSizes.size());
+  if (m_name && m_nameOnWrite)
+    elements.addOpenTable(allTableProps, m_tableNameMap, get(m_name), m_globalId);
+  else
+    elements.addOpenTable(allTableProps);
+}
+
+void IWORKTable::drawRow(const unsigned r, IWORKOutputElements &elements, const bool drawAsSimpleTable)
+{
+  const unsigned numColumns=unsigned(m_columnSizes.size());
   std::set<unsigned> colSet;
   if (drawAsSimpleTable)
   {
@@ -770,153 +1000,155 @@ void IWORKTable::draw(const librevenge::RVNGPropertyList &tableProps, IWORKOutpu
     for (unsigned col=0; col<numColumns; ++col)
       colSet.insert(col);
   }
-  for (std::size_t r = 0; m_table.size() != r; ++r)
-  {
-    const Row_t &row = m_table[r];
+  const Row &row = m_table[r];
 
-    librevenge::RVNGPropertyList rowProps;
-    auto const &rSize=m_rowSizes[r];
-    if (rSize.m_size && rSize.m_exactSize)
-      rowProps.insert("style:row-height", pt2in(get(rSize.m_size)));
-    else if (rSize.m_size)
-      rowProps.insert("style:min-row-height", pt2in(get(rSize.m_size)));
-    if (r < m_headerRows)
-      rowProps.insert("librevenge:is-header-row", true);
+  librevenge::RVNGPropertyList rowProps;
+  auto const &rSize=m_rowSizes[r];
+  if (rSize.m_size && rSize.m_exactSize)
+    rowProps.insert("style:row-height", pt2in(get(rSize.m_size)));
+  else if (rSize.m_size)
+    rowProps.insert("style:min-row-height", pt2in(get(rSize.m_size)));
+  if (r < m_headerRows)
+    rowProps.insert("librevenge:is-header-row", true);
 
-    elements.addOpenTableRow(rowProps);
+  elements.addOpenTableRow(rowProps);
 
-    if (!drawAsSimpleTable)
+  if (!drawAsSimpleTable)
+  {
+    // first compute the list of column that we will need to display
+    colSet.clear();
+    colSet.insert(0);
+    for (auto const &c : row.m_columns)   // cells
     {
-      // first compute the list of column that we will need to display
-      colSet.clear();
-      colSet.insert(0);
-      for (auto const &cIt : row)   // cells
-      {
-        colSet.insert(cIt.first);
-        colSet.insert(cIt.first+1);
-      }
-      for (auto const &vIt : m_verticalLines)   // vertical lines
-      {
-        colSet.insert(vIt.first);
-        colSet.insert(vIt.first+1);
-      }
-      for (auto const &vIt : m_verticalRightLines)
-      {
-        colSet.insert(vIt.first);
-        colSet.insert(vIt.first+1);
-      }
-      if (bool(m_defaultCellStyles[CELL_TYPE_COLUMN_HEADER]) ||
-          bool(m_defaultLayoutStyles[CELL_TYPE_COLUMN_HEADER]) ||
-          bool(m_defaultParaStyles[CELL_TYPE_COLUMN_HEADER])) // default style
-        colSet.insert(m_headerColumns);
-      auto commentIt=m_commentMap.lower_bound(std::make_pair(r,0));
-      while (commentIt!=m_commentMap.end() && commentIt->first.first==r)   // comments
-      {
-        colSet.insert(commentIt->first.second);
-        colSet.insert(commentIt->first.second+1);
-        ++commentIt;
-      }
+      colSet.insert(c);
+      colSet.insert(c+1);
     }
-    Cell const emptyCell;
-    for (auto colIt=colSet.begin(); colIt!=colSet.end();)
+    for (auto const &vIt : m_verticalLines)   // vertical lines
     {
-      unsigned col=*(colIt++);
-      if (col>=numColumns)
-        break;
-      auto const &cIt=row.find(col);
-      const Cell &cell = cIt==row.end() ? emptyCell : cIt->second;
-      librevenge::RVNGPropertyList cellProps;
-      cellProps.insert("librevenge:column", numeric_cast<int>(col));
-      cellProps.insert("librevenge:row", numeric_cast<int>(r));
-      unsigned numRepeat=colIt!=colSet.end() ? *colIt-col : numColumns-col;
-      if (numRepeat>1)
-        cellProps.insert("table:number-columns-repeated", numeric_cast<int>(numRepeat));
-
-      using namespace property;
-      unsigned const rMax= unsigned(r+ std::max(unsigned(1),cell.m_rowSpan));
-      unsigned const cMax= unsigned(col+std::max(unsigned(1),cell.m_columnSpan));
-      if (m_horizontalLines.find(unsigned(r))!=m_horizontalLines.end())
-        writeBorder(cellProps, "fo:border-top", m_horizontalLines.find(unsigned(r))->second, col);
-      if (!m_horizontalBottomLines.empty())
-      {
-        if (m_horizontalBottomLines.find(rMax-1)!=m_horizontalBottomLines.end())
-          writeBorder(cellProps, "fo:border-bottom", m_horizontalBottomLines.find(rMax-1)->second, col);
-      }
-      else if (m_horizontalLines.find(rMax)!=m_horizontalLines.end())
-        writeBorder(cellProps, "fo:border-bottom", m_horizontalLines.find(rMax)->second, col);
-      if (m_verticalLines.find(col)!=m_verticalLines.end())
-        writeBorder(cellProps, "fo:border-left", m_verticalLines.find(col)->second, unsigned(r));
-      if (!m_verticalRightLines.empty())
-      {
-        if (m_verticalRightLines.find(cMax-1)!=m_verticalRightLines.end())
-          writeBorder(cellProps, "fo:border-right", m_verticalRightLines.find(cMax-1)->second, unsigned(r));
-      }
-      else if (m_verticalLines.find(cMax)!=m_verticalLines.end())
-        writeBorder(cellProps, "fo:border-right", m_verticalLines.find(cMax)->second, unsigned(r));
+      colSet.insert(vIt.first);
+      colSet.insert(vIt.first+1);
+    }
+    for (auto const &vIt : m_verticalRightLines)
+    {
+      colSet.insert(vIt.first);
+      colSet.insert(vIt.first+1);
+    }
+    if (bool(m_defaultCellStyles[CELL_TYPE_COLUMN_HEADER]) ||
+        bool(m_defaultLayoutStyles[CELL_TYPE_COLUMN_HEADER]) ||
+        bool(m_defaultParaStyles[CELL_TYPE_COLUMN_HEADER])) // default style
+      colSet.insert(m_headerColumns);
+    auto commentIt=m_commentMap.lower_bound(std::make_pair(r,0));
+    while (commentIt!=m_commentMap.end() && commentIt->first.first==r)   // comments
+    {
+      colSet.insert(commentIt->first.second);
+      colSet.insert(commentIt->first.second+1);
+      ++commentIt;
+    }
+  }
+  CellExtra const emptyExtra;
+  IWORKStylePtr_t const noStyle;
+  for (auto colIt=colSet.begin(); colIt!=colSet.end();)
+  {
+    unsigned col=*(colIt++);
+    if (col>=numColumns)
+      break;
+    std::size_t const index=row.find(col);
+    bool const found=index!=NO_CELL;
+    bool const covered=found && row.m_types[index]==COVERED_CELL;
+    IWORKCellType const cellType=found && !covered ? IWORKCellType(row.m_types[index]) : IWORK_CELL_TYPE_TEXT;
+    std::string const *const cellValue=found && row.m_values[index]!=NO_ID ? m_cellValues[row.m_values[index]] : nullptr;
+    IWORKStylePtr_t const &cellStyle=found && row.m_styles[index]!=NO_ID ? m_cellStyles[row.m_styles[index]] : noStyle;
+    CellExtra const &extra=found && row.m_extras[index]!=NO_ID ? row.m_cellExtras[row.m_extras[index]] : emptyExtra;
+    librevenge::RVNGPropertyList cellProps;
+    cellProps.insert("librevenge:column", numeric_cast<int>(col));
+    cellProps.insert("librevenge:row", numeric_cast<int>(r));
+    unsigned numRepeat=colIt!=colSet.end() ? *colIt-col : numColumns-col;
+    if (numRepeat>1)
+      cellProps.insert("table:number-columns-repeated", numeric_cast<int>(numRepeat));
+
+    using namespace property;
+    unsigned const rMax= unsigned(r+ std::max(unsigned(1),extra.m_rowSpan));
+    unsigned const cMax= unsigned(col+std::max(unsigned(1),extra.m_columnSpan));
+    if (m_horizontalLines.find(unsigned(r))!=m_horizontalLines.end())
+      writeBorder(cellProps, "fo:border-top", m_horizontalLines.find(unsigned(r))->second, col);
+    if (!m_horizontalBottomLines.empty())
+    {
+      if (m_horizontalBottomLines.find(rMax-1)!=m_horizontalBottomLines.end())
+        writeBorder(cellProps, "fo:border-bottom", m_horizontalBottomLines.find(rMax-1)->second, col);
+    }
+    else if (m_horizontalLines.find(rMax)!=m_horizontalLines.end())
+      writeBorder(cellProps, "fo:border-bottom", m_horizontalLines.find(rMax)->second, col);
+    if (m_verticalLines.find(col)!=m_verticalLines.end())
+      writeBorder(cellProps, "fo:border-left", m_verticalLines.find(col)->second, unsigned(r));
+    if (!m_verticalRightLines.empty())
+    {
+      if (m_verticalRightLines.find(cMax-1)!=m_verticalRightLines.end())
+        writeBorder(cellProps, "fo:border-right", m_verticalRightLines.find(cMax-1)->second, unsigned(r));
+    }
+    else if (m_verticalLines.find(cMax)!=m_verticalLines.end())
+      writeBorder(cellProps, "fo:border-right", m_verticalLines.find(cMax)->second, unsigned(r));
 
-      if (cell.m_covered)
+    if (covered)
+    {
+      elements.addInsertCoveredTableCell(cellProps);
+    }
+    else
+    {
+      if (1 < extra.m_columnSpan)
+        cellProps.insert("table:number-columns-spanned", numeric_cast<int>(extra.m_columnSpan));
+      if (1 < extra.m_rowSpan)
+        cellProps.insert("table:number-rows-spanned", numeric_cast<int>(extra.m_rowSpan));
+
+      IWORKStyleStack style;
+      style.push(getDefaultCellStyle(col, unsigned(r)));
+      style.push(cellStyle);
+      if (!drawAsSimpleTable)
       {
-        elements.addInsertCoveredTableCell(cellProps);
+        optional<std::string> valueType;
+        auto formatName=writeFormat(elements, cellStyle, cellType, valueType);
+        if (formatName) cellProps.insert("librevenge:numbering-name", get(formatName).c_str());
+        // do not add a 0 value if the cell is empty
+        if (cellType==IWORK_CELL_TYPE_NUMBER && !bool(cellValue))
+          valueType.reset();
+        writeCellValue(cellProps, cellStyle ? cellStyle->getIdent() : none,
+                       cellType, valueType, cellValue, extra.m_dateTime);
       }
-      else
-      {
-        if (1 < cell.m_columnSpan)
-          cellProps.insert("table:number-columns-spanned", numeric_cast<int>(cell.m_columnSpan));
-        if (1 < cell.m_rowSpan)
-          cellProps.insert("table:number-rows-spanned", numeric_cast<int>(cell.m_rowSpan));
-
-        IWORKStyleStack style;
-        style.push(getDefaultCellStyle(col, unsigned(r)));
-        style.push(cell.m_style);
-        if (!drawAsSimpleTable)
-        {
-          optional<std::string> valueType;
-          auto formatName=writeFormat(elements, cell.m_style, cell.m_type, valueType);
-          if (formatName) cellProps.insert("librevenge:numbering-name", get(formatName).c_str());
-          // do not add a 0 value if the cell is empty
-          if (cell.m_type==IWORK_CELL_TYPE_NUMBER && !bool(cell.m_value))
-            valueType.reset();
-          writeCellValue(cellProps, cell.m_style ? cell.m_style->getIdent() : none,
-                         cell.m_type, valueType, cell.m_value, cell.m_dateTime);
-        }
-        writeCellStyle(cellProps, style);
+      writeCellStyle(cellProps, style);
 
-        IWORKStyleStack pStyle;
-        pStyle.push(getDefaultParagraphStyle(col,unsigned(r)));
-        if (style.has<SFTCellStylePropertyParagraphStyle>())
-          pStyle.push(style.get<SFTCellStylePropertyParagraphStyle>());
-        IWORKText::fillCharPropList(pStyle, m_langManager, cellProps);
+      IWORKStyleStack pStyle;
+      pStyle.push(getDefaultParagraphStyle(col,unsigned(r)));
+      if (style.has<SFTCellStylePropertyParagraphStyle>())
+        pStyle.push(style.get<SFTCellStylePropertyParagraphStyle>());
+      IWORKText::fillCharPropList(pStyle, m_langManager, cellProps);
 
-        if (!drawAsSimpleTable && cell.m_formula)
-          elements.addOpenFormulaCell(cellProps, *cell.m_formula, cell.m_formulaHC, m_tableNameMap);
-        else
-          elements.addOpenTableCell(cellProps);
+      if (!drawAsSimpleTable && extra.m_formula)
+        elements.addOpenFormulaCell(cellProps, *extra.m_formula, extra.m_formulaHC, m_tableNameMap);
+      else
+        elements.addOpenTableCell(cellProps);
 
-        if (!drawAsSimpleTable && style.has<property::Fill>())
+      if (!drawAsSimpleTable && style.has<property::Fill>())
+      {
+        // look for a picture in a cell
+        // FIXME: we must do the same for basic table, but the code
+        //   must be different in odp(no frame) and in odt(frame ok)
+        try
         {
-          // look for a picture in a cell
-          // FIXME: we must do the same for basic table, but the code
-          //   must be different in odp(no frame) and in odt(frame ok)
-          try
+          auto const &media=boost::get<IWORKMediaContent>(style.get<property::Fill>());
+          if (media.m_data && (media.m_data->m_stream || !media.m_data->m_path.empty()))
           {
-            auto const &media=boost::get<IWORKMediaContent>(style.get<property::Fill>());
-            if (media.m_data && media.m_data->m_stream)
+            auto input=media.m_data->m_stream;
+            string mimetype(media.m_data->m_mimeType);
+            if (mimetype.empty())
+              mimetype = input ? detectMimetype(input) : detectMimetypeFromName(media.m_data->m_path);
+            if (!mimetype.empty())
             {
-              auto input=media.m_data->m_stream;
-              string mimetype(media.m_data->m_mimeType);
-              if (mimetype.empty())
-                mimetype = detectMimetype(input);
-              if (!mimetype.empty())
+              librevenge::RVNGPropertyList imageProps;
+              if (!m_mediaCache->insert(*media.m_data, "office:binary-data", imageProps))
+              {
+                ETONYEK_DEBUG_MSG(("IWORKTable::draw: can not read some image\n"));
+              }
+              else
               {
-                input->seek(0, librevenge::RVNG_SEEK_END);
-                const auto size = (unsigned long) input->tell();
-                input->seek(0, librevenge::RVNG_SEEK_SET);
-
-                unsigned long readBytes = 0;
-                const unsigned char *const bytes = input->read(size, readBytes);
-                if (readBytes != size)
-                  throw GenericException();
-
                 librevenge::RVNGPropertyList frameProps;
                 for (int wh=0; wh<2; ++wh)
                 {
@@ -947,51 +1179,48 @@ void IWORKTable::draw(const librevenge::RVNGPropertyList &tableProps, IWORKOutpu
                 frameProps.insert("table:end-cell-address", endCellName);
                 frameProps.insert("table:table-background", true);
                 elements.addOpenFrame(frameProps);
-                librevenge::RVNGPropertyList imageProps;
                 imageProps.insert("librevenge:mime-type", mimetype.c_str());
-                imageProps.insert("office:binary-data", librevenge::RVNGBinaryData(bytes, size));
                 elements.addInsertBinaryObject(imageProps);
                 elements.addCloseFrame();
               }
-              else
-              {
-                ETONYEK_DEBUG_MSG(("IWORKTable::draw: can not find mimetype for some image\n"));
-              }
             }
-          }
-          catch (...)
-          {
+            else
+            {
+              ETONYEK_DEBUG_MSG(("IWORKTable::draw: can not find mimetype for some image\n"));
+            }
           }
         }
-
-        if (!cell.m_content.empty() && cell.m_type!=IWORK_CELL_TYPE_DATE_TIME && cell.m_type!=IWORK_CELL_TYPE_DURATION)
-          elements.append(cell.m_content);
-        else if (drawAsSimpleTable)
+        catch (...)
         {
-          librevenge::RVNGString value=convertCellValueInText(style, cell.m_type, cell.m_value, cell.m_dateTime);
-          if (!value.empty())
-          {
-            librevenge::RVNGPropertyList const empty;
-            elements.addOpenParagraph(empty);
-            elements.addOpenSpan(empty);
-            elements.addInsertText(value);
-            elements.addCloseSpan();
-            elements.addCloseParagraph();
-          }
         }
-        auto nIt=m_commentMap.find(std::make_pair(r,col));
-        if (nIt!=m_commentMap.end())
+      }
+
+      if (!extra.m_content.empty() && cellType!=IWORK_CELL_TYPE_DATE_TIME && cellType!=IWORK_CELL_TYPE_DURATION)
+        elements.append(extra.m_content);
+      else if (drawAsSimpleTable)
+      {
+        librevenge::RVNGString value=convertCellValueInText(style, cellType, cellValue, extra.m_dateTime);
+        if (!value.empty())
         {
-          elements.addOpenComment(librevenge::RVNGPropertyList());
-          elements.append(nIt->second);
-          elements.addCloseComment();
+          librevenge::RVNGPropertyList const empty;
+          elements.addOpenParagraph(empty);
+          elements.addOpenSpan(empty);
+          elements.addInsertText(value);
+          elements.addCloseSpan();
+          elements.addCloseParagraph();
         }
-        elements.addCloseTableCell();
       }
+      auto nIt=m_commentMap.find(std::make_pair(r,col));
+      if (nIt!=m_commentMap.end())
+      {
+        elements.addOpenComment(librevenge::RVNGPropertyList());
+        elements.append(nIt->second);
+        elements.addCloseComment();
+      }
+      elements.addCloseTableCell();
     }
-    elements.addCloseTableRow();
   }
-  elements.addCloseTable();
+  elements.addCloseTableRow();
 }
 
 void IWORKTable::setDefaultCellStyle(const CellType type, const IWORKStylePtr_t &style)
@@ -1055,6 +1284,29 @@ IWORKStylePtr_t IWORKTable::getDefaultParagraphStyle(unsigned column, unsigned r
   return getDefaultStyle(column, row, m_defaultParaStyles);
 }
 
+std::string IWORKTable::registerName(IWORKTableNameMap_t &tableNameMap, const std::string &name, const boost::optional<std::string> &globalId)
+{
+  std::string finalName(name);
+  if (tableNameMap.find(finalName)!=tableNameMap.end())
+  {
+    ETONYEK_DEBUG_MSG(("IWORKTable::registerName: a table with name %s already exists\n", finalName.c_str()));
+    // let create an unique name
+    int nId=0;
+    while (true)
+    {
+      std::stringstream s;
+      s << name << "_" << ++nId;
+      if (tableNameMap.find(s.str())!=tableNameMap.end()) continue;
+      finalName=s.str();
+      break;
+    }
+  }
+  tableNameMap[finalName]=finalName;
+  if (globalId)
+    tableNameMap[std::string("SFTGlobalID_")+get(globalId)] = finalName;
+  return finalName;
+}
+
 IWORKStylePtr_t IWORKTable::getDefaultStyle(const unsigned column, const unsigned row, const IWORKStylePtr_t *const group) const
 {
   if ((row < m_headerRows) && bool(group[CELL_TYPE_ROW_HEADER]))
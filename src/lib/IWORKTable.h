@@ -11,9 +11,13 @@
 #define IWORKTABLE_H_INCLUDED
 
 #include <deque>
+#include <functional>
 #include <map>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include <boost/optional.hpp>
 
@@ -25,31 +29,55 @@ namespace libetonyek
 {
 
 class IWORKLanguageManager;
+class IWORKMediaCache;
 class IWORKText;
 class IWORKTableRecorder;
 
 class IWORKTable
 {
-  struct Cell
+  /// The data of the few cells which need more than a type, a value and a style.
+  struct CellExtra
   {
+    CellExtra();
+
     IWORKOutputElements m_content;
     unsigned m_columnSpan;
     unsigned m_rowSpan;
-    bool m_covered;
     IWORKFormulaPtr_t m_formula;
     boost::optional<unsigned> m_formulaHC;
-    IWORKStylePtr_t m_style;
-    IWORKCellType m_type;
-    boost::optional<std::string> m_value;
     boost::optional<IWORKDateTimeData> m_dateTime;
+  };
 
-    Cell();
+  /** The cells of a row.
+    *
+    * The cells are sorted by column and stored in parallel arrays. The
+    * values and the styles are interned by the table.
+    */
+  struct Row
+  {
+    Row();
+
+    std::size_t find(unsigned column) const;
+    std::size_t insert(unsigned column);
+    /// Get the extra data of a cell, creating them if needed.
+    CellExtra &getExtra(std::size_t index);
+    /// Remove the extra data of a cell, if it has any.
+    void removeExtra(std::size_t index);
+
+    std::vector<unsigned> m_columns;
+    std::vector<unsigned char> m_types; // an IWORKCellType, or a covered cell tag
+    std::vector<unsigned> m_values;
+    std::vector<unsigned> m_styles;
+    std::vector<unsigned> m_extras; // index in m_cellExtras
+    std::vector<CellExtra> m_cellExtras;
   };
 
-  typedef std::map<unsigned, Cell> Row_t;
-  typedef std::deque<Row_t> Table_t;
+  typedef std::deque<Row> Table_t;
 
 public:
+  /// Receives the output of a table drawn incrementally.
+  typedef std::function<void(const IWORKOutputElements &)> StreamSink_t;
+
   enum CellType
   {
     CELL_TYPE_BODY,
@@ -65,7 +93,19 @@ public:
   void setRecorder(const std::shared_ptr<IWORKTableRecorder> &recorder);
   const std::shared_ptr<IWORKTableRecorder> &getRecorder() const;
 
+  /// Set the cache of the pictures of the cells.
+  void setMediaCache(const std::shared_ptr<IWORKMediaCache> &mediaCache);
+
   void setName(std::string const &name);
+  /** Set a name that is made unique only when the table is written.
+    *
+    * This is for tables parsed in parallel: they get their names in
+    * the order of the output, as if they were parsed one by one.
+    *
+    * @arg[in] name the wanted name
+    * @arg[in] globalId the global ID of the table, used by formulas
+    */
+  void setNameOnWrite(std::string const &name, const boost::optional<std::string> &globalId);
   void setSize(unsigned columns, unsigned rows);
   void setHeaders(unsigned headerColumns, unsigned headerRows, unsigned footerRows);
   void setBandedRows(bool banded = true);
@@ -91,6 +131,26 @@ public:
 
   void draw(const librevenge::RVNGPropertyList &tableProps, IWORKOutputElements &elements, bool drawAsSimpleTable);
 
+  /** Start to draw the table incrementally.
+    *
+    * The table is opened immediately and the output is then sent to
+    * @c sink by flushRows() and endStreaming(). The table must be
+    * completely set up, except its cells and comments.
+    */
+  void startStreaming(const librevenge::RVNGPropertyList &tableProps, bool drawAsSimpleTable, const StreamSink_t &sink);
+  bool isStreaming() const;
+  /** Draw all the rows before @c row which are not drawn yet.
+    *
+    * The content of these rows is released, so they can not be
+    * modified anymore.
+    */
+  void flushRows(unsigned row);
+  /// Draw the remaining rows and close the table.
+  void endStreaming();
+
+  /// Get the number of distinct cell values kept by the table.
+  std::size_t getValueCount() const;
+
   void setDefaultCellStyle(CellType type, const IWORKStylePtr_t &style);
   void setDefaultLayoutStyle(CellType type, const IWORKStylePtr_t &style);
   void setDefaultParagraphStyle(CellType type, const IWORKStylePtr_t &style);
@@ -101,9 +161,26 @@ public:
   IWORKStylePtr_t getDefaultLayoutStyle(unsigned column, unsigned row) const;
   IWORKStylePtr_t getDefaultParagraphStyle(unsigned column, unsigned row) const;
 
+  /** Add a name to a table name map, making it unique.
+    *
+    * @arg[in] tableNameMap the map
+    * @arg[in] name the wanted name
+    * @arg[in] globalId the global ID of the table, if any
+    * @returns the unique name
+    */
+  static std::string registerName(IWORKTableNameMap_t &tableNameMap, const std::string &name, const boost::optional<std::string> &globalId);
+
 private:
   IWORKStylePtr_t getDefaultStyle(unsigned column, unsigned row, const IWORKStylePtr_t *group) const;
 
+  void openTable(const librevenge::RVNGPropertyList &tableProps, IWORKOutputElements &elements, bool drawAsSimpleTable) const;
+  void drawRow(unsigned row, IWORKOutputElements &elements, bool drawAsSimpleTable);
+
+  unsigned internValue(const std::string &value);
+  unsigned internStyle(const IWORKStylePtr_t &style);
+  /// Forget the values which are only used by the drawn rows.
+  void releaseValues();
+
   boost::optional<std::string> writeFormat(IWORKOutputElements &elements, const IWORKStylePtr_t &style, const IWORKCellType type, boost::optional<std::string> &rvngValueType);
 
 private:
@@ -113,8 +190,14 @@ private:
   std::map<std::pair<unsigned, unsigned>, IWORKOutputElements> m_commentMap;
 
   Table_t m_table;
+  std::unordered_map<std::string, unsigned> m_cellValueIds;
+  std::vector<const std::string *> m_cellValues; // points to the keys of m_cellValueIds
+  std::unordered_map<const IWORKStyle *, unsigned> m_cellStyleIds;
+  std::vector<IWORKStylePtr_t> m_cellStyles;
   IWORKStylePtr_t m_style;
   boost::optional<std::string> m_name;
+  bool m_nameOnWrite; //!< m_name is not unique yet
+  boost::optional<std::string> m_globalId;
   boost::optional<int> m_order;
   IWORKColumnSizes_t m_columnSizes;
   IWORKRowSizes_t m_rowSizes;
@@ -137,6 +220,11 @@ private:
   IWORKStylePtr_t m_defaultParaStyles[5];
 
   std::shared_ptr<IWORKTableRecorder> m_recorder;
+  std::shared_ptr<IWORKMediaCache> m_mediaCache;
+
+  StreamSink_t m_streamSink;
+  bool m_streamAsSimpleTable;
+  unsigned m_flushedRows; // the number of rows already drawn by flushRows()
 };
 
 }
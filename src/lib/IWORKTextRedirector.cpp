@@ -16,9 +16,17 @@ namespace libetonyek
 
 IWORKTextRedirector::IWORKTextRedirector(librevenge::RVNGTextInterface *const iface)
   : m_iface(iface)
+  , m_shareStyles(false)
+  , m_paragraphStyles("librevenge:paragraph-id")
+  , m_characterStyles("librevenge:span-id")
 {
 }
 
+void IWORKTextRedirector::setShareStyles(const bool share)
+{
+  m_shareStyles = share;
+}
+
 void IWORKTextRedirector::setDocumentMetaData(const librevenge::RVNGPropertyList &propList)
 {
   m_iface->setDocumentMetaData(propList);
@@ -109,7 +117,16 @@ void IWORKTextRedirector::defineParagraphStyle(const librevenge::RVNGPropertyLis
 
 void IWORKTextRedirector::openParagraph(const librevenge::RVNGPropertyList &propList)
 {
-  m_iface->openParagraph(propList);
+  if (m_shareStyles)
+  {
+    librevenge::RVNGPropertyList definition;
+    const librevenge::RVNGPropertyList ref(m_paragraphStyles.share(propList, definition));
+    if (!definition.empty())
+      m_iface->defineParagraphStyle(definition);
+    m_iface->openParagraph(ref);
+  }
+  else
+    m_iface->openParagraph(propList);
 }
 void IWORKTextRedirector::closeParagraph()
 {
@@ -123,7 +140,16 @@ void IWORKTextRedirector::defineCharacterStyle(const librevenge::RVNGPropertyLis
 
 void IWORKTextRedirector::openSpan(const librevenge::RVNGPropertyList &propList)
 {
-  m_iface->openSpan(propList);
+  if (m_shareStyles)
+  {
+    librevenge::RVNGPropertyList definition;
+    const librevenge::RVNGPropertyList ref(m_characterStyles.share(propList, definition));
+    if (!definition.empty())
+      m_iface->defineCharacterStyle(definition);
+    m_iface->openSpan(ref);
+  }
+  else
+    m_iface->openSpan(propList);
 }
 void IWORKTextRedirector::closeSpan()
 {
@@ -11,6 +11,7 @@
 #define IWORKTEXTREDIRECTOR_H_INCLUDED
 
 #include "IWORKDocumentInterface.h"
+#include "IWORKSharedStyles.h"
 
 namespace libetonyek
 {
@@ -20,6 +21,11 @@ class IWORKTextRedirector : public IWORKDocumentInterface
 public:
   explicit IWORKTextRedirector(librevenge::RVNGTextInterface *iface);
 
+  /** Define each distinct paragraph and character style once and
+    * refer to it by its ID.
+    */
+  void setShareStyles(bool share);
+
   void setDocumentMetaData(const librevenge::RVNGPropertyList &propList) override;
 
   void startDocument(const librevenge::RVNGPropertyList &propList) override;
@@ -160,6 +166,9 @@ private:
   IWORKTextRedirector(const IWORKTextRedirector &);
   IWORKTextRedirector &operator=(const IWORKTextRedirector &);
   librevenge::RVNGTextInterface *const m_iface;
+  bool m_shareStyles;
+  IWORKSharedStyles m_paragraphStyles;
+  IWORKSharedStyles m_characterStyles;
 };
 
 }
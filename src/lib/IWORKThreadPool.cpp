@@ -0,0 +1,189 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "IWORKThreadPool.h"
+
+#include <deque>
+#include <vector>
+
+#ifdef WITH_THREADS
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#endif
+
+namespace libetonyek
+{
+
+namespace
+{
+
+void runTask(const IWORKThreadPool::Task_t &task)
+{
+  try
+  {
+    task();
+  }
+  catch (...)
+  {
+    ETONYEK_DEBUG_MSG(("IWORKThreadPool: a task failed\n"));
+  }
+}
+
+}
+
+#ifdef WITH_THREADS
+
+struct IWORKThreadPool::Impl
+{
+  Impl();
+
+  void run();
+  void stop();
+
+  std::vector<std::thread> m_threads;
+  std::deque<Task_t> m_tasks;
+  std::mutex m_mutex;
+  std::condition_variable m_taskAvailable;
+  std::condition_variable m_tasksDone;
+  unsigned m_running;
+  bool m_stop;
+};
+
+IWORKThreadPool::Impl::Impl()
+  : m_threads()
+  , m_tasks()
+  , m_mutex()
+  , m_taskAvailable()
+  , m_tasksDone()
+  , m_running(0)
+  , m_stop(false)
+{
+}
+
+void IWORKThreadPool::Impl::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (true)
+  {
+    m_taskAvailable.wait(lock, [this]()
+    {
+      return m_stop || !m_tasks.empty();
+    });
+    if (m_tasks.empty())
+      return; // stopping and nothing left to do
+
+    const Task_t task = m_tasks.front();
+    m_tasks.pop_front();
+    ++m_running;
+    lock.unlock();
+    runTask(task);
+    lock.lock();
+    --m_running;
+    if (m_tasks.empty() && (m_running == 0))
+      m_tasksDone.notify_all();
+  }
+}
+
+/// Let the threads finish the queued tasks and join them.
+void IWORKThreadPool::Impl::stop()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_taskAvailable.notify_all();
+  for (auto &thread : m_threads)
+    thread.join();
+}
+
+IWORKThreadPool::IWORKThreadPool(const unsigned threads)
+  : m_impl(new Impl())
+{
+  unsigned count = threads;
+  if (count == 0)
+    count = std::thread::hardware_concurrency();
+  if (count == 0)
+    count = 1;
+  m_impl->m_threads.reserve(count);
+  try
+  {
+    for (unsigned i = 0; i < count; ++i)
+      m_impl->m_threads.push_back(std::thread(&Impl::run, m_impl.get()));
+  }
+  catch (...)
+  {
+    // destroying a joinable thread would terminate the program
+    m_impl->stop();
+    throw;
+  }
+}
+
+IWORKThreadPool::~IWORKThreadPool()
+{
+  m_impl->stop();
+}
+
+void IWORKThreadPool::post(const Task_t &task)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_impl->m_mutex);
+    m_impl->m_tasks.push_back(task);
+  }
+  m_impl->m_taskAvailable.notify_one();
+}
+
+void IWORKThreadPool::wait()
+{
+  std::unique_lock<std::mutex> lock(m_impl->m_mutex);
+  m_impl->m_tasksDone.wait(lock, [this]()
+  {
+    return m_impl->m_tasks.empty() && (m_impl->m_running == 0);
+  });
+}
+
+unsigned IWORKThreadPool::size() const
+{
+  return unsigned(m_impl->m_threads.size());
+}
+
+#else
+
+struct IWORKThreadPool::Impl
+{
+};
+
+IWORKThreadPool::IWORKThreadPool(unsigned)
+  : m_impl()
+{
+}
+
+IWORKThreadPool::~IWORKThreadPool()
+{
+}
+
+void IWORKThreadPool::post(const Task_t &task)
+{
+  runTask(task);
+}
+
+void IWORKThreadPool::wait()
+{
+}
+
+unsigned IWORKThreadPool::size() const
+{
+  return 1;
+}
+
+#endif
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
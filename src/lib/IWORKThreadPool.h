@@ -0,0 +1,67 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef IWORKTHREADPOOL_H_INCLUDED
+#define IWORKTHREADPOOL_H_INCLUDED
+
+#include <functional>
+#include <memory>
+
+#include "libetonyek_utils.h"
+
+namespace libetonyek
+{
+
+/** A pool of worker threads running independent tasks.
+  *
+  * Tasks are started in the order they are posted, so a pool with a
+  * single thread runs them in that order. An exception escaping from a
+  * task is swallowed, so tasks must report failures themselves. If the
+  * library is built without thread support, tasks are run directly by
+  * post().
+  */
+class IWORKThreadPool
+{
+  // disable copying
+  IWORKThreadPool(const IWORKThreadPool &);
+  IWORKThreadPool &operator=(const IWORKThreadPool &);
+
+public:
+  typedef std::function<void()> Task_t;
+
+public:
+  /** Create a pool.
+    *
+    * @arg[in] threads the number of threads to use. If it is 0, the
+    *   number of available processors is used.
+    */
+  explicit IWORKThreadPool(unsigned threads = 0);
+
+  /// Wait for all posted tasks and stop the threads.
+  ~IWORKThreadPool();
+
+  /// Queue a task for execution.
+  void post(const Task_t &task);
+
+  /// Wait until all posted tasks are done.
+  void wait();
+
+  /// Get the number of worker threads.
+  unsigned size() const;
+
+private:
+  struct Impl;
+  std::unique_ptr<Impl> m_impl;
+};
+
+}
+
+#endif // IWORKTHREADPOOL_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,37 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "IWORKTokenCache.h"
+
+#include "IWORKTokenizer.h"
+
+namespace libetonyek
+{
+
+IWORKTokenCache::IWORKTokenCache(const IWORKTokenizer &tokenizer)
+  : m_tokenizer(tokenizer)
+  , m_tokens()
+{
+}
+
+int IWORKTokenCache::getQualifiedId(const char *const name, const char *const ns)
+{
+  const Key_t key(name, ns);
+  const auto it = m_tokens.find(key);
+  if (it != m_tokens.end())
+    return it->second;
+
+  const int id = m_tokenizer.getQualifiedId(name, ns);
+  m_tokens.insert(std::make_pair(key, id));
+  return id;
+}
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,59 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef IWORKTOKENCACHE_H_INCLUDED
+#define IWORKTOKENCACHE_H_INCLUDED
+
+#include <unordered_map>
+#include <utility>
+
+#include <boost/functional/hash.hpp>
+
+namespace libetonyek
+{
+
+class IWORKTokenizer;
+
+/** A cache of tokens of names interned by libxml2.
+  *
+  * The XML reader keeps all element and attribute names and namespace
+  * URIs in its dictionary, so a name has always the same address as
+  * long as the reader exists. That allows to find the token of a name
+  * just by its address, after it has been seen once.
+  *
+  * The cache must not be used for any other strings (e.g., attribute
+  * values) and it must not outlive the reader.
+  */
+class IWORKTokenCache
+{
+  // disable copying
+  IWORKTokenCache(const IWORKTokenCache &);
+  IWORKTokenCache &operator=(const IWORKTokenCache &);
+
+  typedef std::pair<const char *, const char *> Key_t;
+
+public:
+  explicit IWORKTokenCache(const IWORKTokenizer &tokenizer);
+
+  /** Get the token for an interned name and namespace.
+    *
+    * @see IWORKTokenizer::getQualifiedId()
+    */
+  int getQualifiedId(const char *name, const char *ns);
+
+private:
+  const IWORKTokenizer &m_tokenizer;
+  std::unordered_map<Key_t, int, boost::hash<Key_t> > m_tokens;
+};
+
+}
+
+#endif // IWORKTOKENCACHE_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
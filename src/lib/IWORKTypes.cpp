@@ -110,6 +110,7 @@ IWORKLine::IWORKLine()
 
 IWORKData::IWORKData()
   : m_stream()
+  , m_path()
   , m_displayName()
   , m_mimeType()
 {
@@ -139,6 +139,7 @@ struct IWORKLine
 struct IWORKData
 {
   RVNGInputStreamPtr_t m_stream;
+  std::string m_path;
   boost::optional<std::string> m_displayName;
   std::string m_mimeType;
 
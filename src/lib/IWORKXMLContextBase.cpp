@@ -77,6 +77,13 @@ IWORKXMLContextEmpty::IWORKXMLContextEmpty(IWORKXMLParserState &)
 {
 }
 
+void IWORKXMLContextEmpty::startOfElement()
+{
+  // the context might be reused for another element
+  m_id.reset();
+  m_ref.reset();
+}
+
 void IWORKXMLContextEmpty::attribute(const int name, const char *const value)
 {
   switch (name)
@@ -108,6 +108,7 @@ class IWORKXMLContextEmpty : public IWORKXMLContextMinimal
 protected:
   explicit IWORKXMLContextEmpty(IWORKXMLParserState &);
 
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
   IWORKXMLContextPtr_t element(int token) override;
   void text(const char *value) override;
@@ -9,12 +9,18 @@
 
 #include "IWORKZlibStream.h"
 
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <utility>
 #include <vector>
 
 #include <zlib.h>
 
 #include "libetonyek_utils.h"
 #include "IWORKMemoryStream.h"
+#include "IWORKProfiler.h"
 
 using std::vector;
 
@@ -28,9 +34,22 @@ class ZlibStreamException
 {
 };
 
-RVNGInputStreamPtr_t getInflatedStream(const RVNGInputStreamPtr_t &input)
+/// Size of the window of uncompressed data kept by InflatingStream.
+const unsigned long windowSize = 1 << 16;
+
+/// Size of the blocks of compressed data read by InflatingStream.
+const unsigned long inputBlockSize = 1 << 16;
+
+/// The greatest ratio deflate can achieve.
+const unsigned long maxRatio = 1032;
+
+/** Check the signature of the stream.
+  *
+  * @returns true if the stream is stored without compression
+  */
+bool checkSignature(const RVNGInputStreamPtr_t &input, unsigned long &offset)
 {
-  unsigned long offset = 2;
+  offset = 2;
 
   const unsigned char sig1 = readU8(input);
   if (0x78 != sig1) // not a zlib stream
@@ -44,6 +63,44 @@ RVNGInputStreamPtr_t getInflatedStream(const RVNGInputStreamPtr_t &input)
   const bool uncompressed = Z_NO_COMPRESSION == readU8(input);
   if (uncompressed)
     offset = 0;
+  return uncompressed;
+}
+
+void initInflate(z_stream &strm)
+{
+  strm.zalloc = Z_NULL;
+  strm.zfree = Z_NULL;
+  strm.opaque = Z_NULL;
+  strm.avail_in = 0;
+  strm.next_in = Z_NULL;
+  strm.total_in = 0;
+  strm.total_out = 0;
+
+  if (inflateInit2(&strm, 16 + MAX_WBITS) != Z_OK)
+    throw ZlibStreamException();
+}
+
+/** Get the size of the uncompressed data from the gzip trailer.
+  *
+  * The trailer only keeps the size modulo 2^32 and it might be broken,
+  * so the result is only a hint.
+  */
+unsigned long readISize(const unsigned char *const data, const unsigned long length)
+{
+  if (length < 18) // header + trailer
+    return 0;
+  if ((data[0] != 0x1f) || (data[1] != 0x8b))
+    return 0;
+  const unsigned char *const trailer = data + length - 4;
+  return (unsigned long)(trailer[0]) | ((unsigned long)(trailer[1]) << 8)
+         | ((unsigned long)(trailer[2]) << 16) | ((unsigned long)(trailer[3]) << 24);
+}
+
+RVNGInputStreamPtr_t getInflatedStream(const RVNGInputStreamPtr_t &input)
+{
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_DECOMPRESSION);
+  unsigned long offset = 0;
+  const bool uncompressed = checkSignature(input, offset);
 
   auto begin = (unsigned long) input->tell();
   input->seek(0, librevenge::RVNG_SEEK_END);
@@ -62,58 +119,364 @@ RVNGInputStreamPtr_t getInflatedStream(const RVNGInputStreamPtr_t &input)
   }
   else
   {
-    int ret;
     z_stream strm;
-
-    /* allocate inflate state */
-    strm.zalloc = Z_NULL;
-    strm.zfree = Z_NULL;
-    strm.opaque = Z_NULL;
+    initInflate(strm);
     strm.avail_in = (unsigned)numBytesRead;
     strm.next_in = (Bytef *)compressedData;
-    strm.total_in = 0;
-    strm.total_out = 0;
-
-    ret = inflateInit2(&strm, 16 + MAX_WBITS);
-    if (ret != Z_OK)
-      throw ZlibStreamException();
 
-    vector<unsigned char> data(2 * compressedSize);
+    // Start with the size from the trailer, if it is sensible. One byte
+    // more, so inflate does not stop just before reading the trailer.
+    unsigned long size = readISize(compressedData, numBytesRead) + 1;
+    if ((size == 1) || (size > maxRatio * compressedSize))
+      size = 2 * compressedSize;
+    std::unique_ptr<unsigned char[]> data(new unsigned char[size]);
 
     while (true)
     {
-      strm.next_out = reinterpret_cast<Bytef *>(&data[strm.total_out]);
-      strm.avail_out = unsigned(data.size() - strm.total_out);
-      ret = inflate(&strm, Z_SYNC_FLUSH);
+      strm.next_out = reinterpret_cast<Bytef *>(data.get() + strm.total_out);
+      strm.avail_out = unsigned(size - strm.total_out);
+      const int ret = inflate(&strm, Z_SYNC_FLUSH);
 
       if (Z_STREAM_END == ret)
         break;
       if ((Z_OK == ret) && (0 == strm.avail_in) && (0 < strm.avail_out)) // end of stream too
         break;
-      if (Z_OK != ret)
+      if ((Z_OK != ret) && ((Z_BUF_ERROR != ret) || (0 != strm.avail_out)))
       {
         (void)inflateEnd(&strm);
         throw ZlibStreamException();
       }
 
-      data.resize(data.size() + compressedSize);
+      if (0 == strm.avail_out)
+      {
+        // the trailer lied, grow geometrically
+        std::unique_ptr<unsigned char[]> newData(new unsigned char[2 * size]);
+        std::memcpy(newData.get(), data.get(), strm.total_out);
+        data.swap(newData);
+        size *= 2;
+      }
     }
 
     (void)inflateEnd(&strm);
 
-    return RVNGInputStreamPtr_t(new IWORKMemoryStream(&data[0], (unsigned) strm.total_out));
+    return RVNGInputStreamPtr_t(new IWORKMemoryStream(std::move(data), (unsigned) strm.total_out));
   }
 }
 
+/** A stream that inflates the data when they are read.
+  *
+  * Only a window of the uncompressed data is kept in memory. Reading
+  * forward is cheap; seeking back before the window restarts the
+  * inflation from the beginning and seeking relative to the end has to
+  * inflate the whole stream first. This suits the sequential reading
+  * done by the XML parser.
+  */
+class InflatingStream : public librevenge::RVNGInputStream
+{
+  // -Weffc++
+  InflatingStream(const InflatingStream &other);
+  InflatingStream &operator=(const InflatingStream &other);
+
+public:
+  explicit InflatingStream(const RVNGInputStreamPtr_t &input);
+  ~InflatingStream() override;
+
+  bool isStructured() override;
+  unsigned subStreamCount() override;
+  const char *subStreamName(unsigned id) override;
+  bool existsSubStream(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamByName(const char *name) override;
+  librevenge::RVNGInputStream *getSubStreamById(unsigned id) override;
+
+  const unsigned char *read(unsigned long numBytes, unsigned long &numBytesRead) override;
+  int seek(long offset, librevenge::RVNG_SEEK_TYPE seekType) override;
+  long tell() override;
+  bool isEnd() override;
+
+private:
+  void restart();
+  unsigned long fill(unsigned long numBytes);
+  unsigned long inflateBlock(unsigned char *output, unsigned long length);
+  long getLength();
+
+private:
+  const RVNGInputStreamPtr_t m_input;
+  z_stream m_strm;
+  vector<unsigned char> m_window; //! The uncompressed data around the current position.
+  long m_windowBegin; //! Position of the start of m_window in the uncompressed data.
+  long m_pos;
+  bool m_finished; //! All the data have been inflated.
+};
+
+InflatingStream::InflatingStream(const RVNGInputStreamPtr_t &input)
+  : m_input(input)
+  , m_strm()
+  , m_window()
+  , m_windowBegin(0)
+  , m_pos(0)
+  , m_finished(false)
+{
+  initInflate(m_strm);
+  try
+  {
+    restart();
+    // check that the data can be inflated at all
+    if (fill(1) == 0)
+      throw ZlibStreamException();
+  }
+  catch (...)
+  {
+    (void)inflateEnd(&m_strm);
+    throw;
+  }
+}
+
+InflatingStream::~InflatingStream()
+{
+  (void)inflateEnd(&m_strm);
+}
+
+bool InflatingStream::isStructured()
+{
+  return false;
 }
 
-IWORKZlibStream::IWORKZlibStream(const RVNGInputStreamPtr_t &stream)
+unsigned InflatingStream::subStreamCount()
+{
+  return 0;
+}
+
+const char *InflatingStream::subStreamName(unsigned)
+{
+  return nullptr;
+}
+
+bool InflatingStream::existsSubStream(const char *)
+{
+  return false;
+}
+
+librevenge::RVNGInputStream *InflatingStream::getSubStreamByName(const char *)
+{
+  return nullptr;
+}
+
+librevenge::RVNGInputStream *InflatingStream::getSubStreamById(unsigned)
+{
+  return nullptr;
+}
+
+const unsigned char *InflatingStream::read(const unsigned long numBytes, unsigned long &numBytesRead) try
+{
+  numBytesRead = 0;
+
+  if (0 == numBytes)
+    return nullptr;
+
+  numBytesRead = fill(numBytes);
+  if (0 == numBytesRead)
+    return nullptr;
+
+  const unsigned char *const bytes = &m_window[0] + (m_pos - m_windowBegin);
+  m_pos += long(numBytesRead);
+  return bytes;
+}
+catch (...)
+{
+  return nullptr;
+}
+
+int InflatingStream::seek(const long offset, const librevenge::RVNG_SEEK_TYPE seekType) try
+{
+  long pos = 0;
+  switch (seekType)
+  {
+  case librevenge::RVNG_SEEK_SET :
+    pos = offset;
+    break;
+  case librevenge::RVNG_SEEK_CUR :
+    pos = offset + m_pos;
+    break;
+  case librevenge::RVNG_SEEK_END :
+    pos = offset + getLength();
+    break;
+  default :
+    return -1;
+  }
+
+  if (pos < 0)
+    return 1;
+
+  if (pos > m_windowBegin + long(m_window.size()))
+  {
+    // make sure the position exists
+    const long oldPos = m_pos;
+    m_pos = pos;
+    fill(0);
+    if (m_windowBegin < pos)
+    {
+      m_pos = oldPos;
+      return 1;
+    }
+  }
+
+  m_pos = pos;
+  return 0;
+}
+catch (...)
+{
+  return -1;
+}
+
+long InflatingStream::tell()
+{
+  return m_pos;
+}
+
+bool InflatingStream::isEnd() try
+{
+  return fill(1) == 0;
+}
+catch (...)
+{
+  return true;
+}
+
+void InflatingStream::restart()
+{
+  if (inflateReset(&m_strm) != Z_OK)
+    throw ZlibStreamException();
+  if (m_input->seek(0, librevenge::RVNG_SEEK_SET) != 0)
+    throw ZlibStreamException();
+  m_strm.avail_in = 0;
+  m_strm.next_in = Z_NULL;
+  m_window.clear();
+  m_windowBegin = 0;
+  m_finished = false;
+}
+
+/** Make the window contain @c numBytes bytes from the current position.
+  *
+  * @returns the number of bytes available, which is less than @c
+  * numBytes only at the end of the stream
+  */
+unsigned long InflatingStream::fill(const unsigned long numBytes)
+{
+  if (m_pos < m_windowBegin)
+  {
+    const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_DECOMPRESSION);
+    restart();
+  }
+
+  const long windowEnd = m_windowBegin + long(m_window.size());
+  if (m_pos + long(numBytes) <= windowEnd)
+    return numBytes;
+
+  // drop the data before the current position
+  if (m_pos < windowEnd)
+  {
+    m_window.erase(m_window.begin(), m_window.begin() + (m_pos - m_windowBegin));
+    m_windowBegin = m_pos;
+  }
+  else
+  {
+    m_window.clear();
+    m_windowBegin = windowEnd;
+  }
+
+  while (!m_finished && (m_windowBegin + long(m_window.size()) < m_pos + long(numBytes)))
+  {
+    const std::size_t oldSize = m_window.size();
+    const std::size_t room = (std::max)(windowSize, numBytes);
+    m_window.resize(oldSize + room);
+    m_window.resize(oldSize + inflateBlock(&m_window[oldSize], room));
+
+    if (m_windowBegin < m_pos) // still skipping
+    {
+      const auto skip = (std::min)(std::size_t(m_pos - m_windowBegin), m_window.size());
+      m_window.erase(m_window.begin(), m_window.begin() + long(skip));
+      m_windowBegin += long(skip);
+    }
+  }
+
+  const long available = m_windowBegin + long(m_window.size()) - m_pos;
+  return (available <= 0) ? 0 : (std::min)(numBytes, (unsigned long) available);
+}
+
+unsigned long InflatingStream::inflateBlock(unsigned char *const output, const unsigned long length)
+{
+  const IWORKProfiler::Scope scope(IWORKProfiler::PHASE_DECOMPRESSION);
+
+  m_strm.next_out = reinterpret_cast<Bytef *>(output);
+  m_strm.avail_out = unsigned(length);
+  while (!m_finished && (m_strm.avail_out > 0))
+  {
+    if (m_strm.avail_in == 0)
+    {
+      unsigned long numBytesRead = 0;
+      const unsigned char *const data = m_input->isEnd() ? nullptr : m_input->read(inputBlockSize, numBytesRead);
+      if (!data || (numBytesRead == 0))
+      {
+        // a truncated stream: keep what we have got
+        ETONYEK_DEBUG_MSG(("InflatingStream::inflateBlock: unexpected end of the compressed data\n"));
+        m_finished = true;
+        break;
+      }
+      m_strm.next_in = const_cast<Bytef *>(data);
+      m_strm.avail_in = unsigned(numBytesRead);
+    }
+
+    const int ret = inflate(&m_strm, Z_SYNC_FLUSH);
+    if (Z_STREAM_END == ret)
+    {
+      m_finished = true;
+    }
+    else if ((Z_OK != ret) && (Z_BUF_ERROR != ret))
+    {
+      ETONYEK_DEBUG_MSG(("InflatingStream::inflateBlock: broken compressed data, truncating the stream\n"));
+      m_finished = true;
+    }
+  }
+  return length - m_strm.avail_out;
+}
+
+long InflatingStream::getLength()
+{
+  if (!m_finished)
+  {
+    // skip everything
+    const long oldPos = m_pos;
+    m_pos = std::numeric_limits<long>::max();
+    fill(0);
+    m_pos = oldPos;
+  }
+  return m_windowBegin + long(m_window.size());
+}
+
+}
+
+IWORKZlibStream::IWORKZlibStream(const RVNGInputStreamPtr_t &stream, const Mode mode)
   : m_stream()
 {
   if (0 != stream->seek(0, librevenge::RVNG_SEEK_SET))
     throw EndOfStreamException();
 
-  m_stream = getInflatedStream(stream);
+  if (mode == MODE_STREAMING)
+  {
+    unsigned long offset = 0;
+    const bool uncompressed = checkSignature(stream, offset);
+    // the check has read the signature
+    if (0 != stream->seek(0, librevenge::RVNG_SEEK_SET))
+      throw EndOfStreamException();
+    if (uncompressed)
+      m_stream = getInflatedStream(stream);
+    else
+      m_stream = std::make_shared<InflatingStream>(stream);
+  }
+  else
+  {
+    m_stream = getInflatedStream(stream);
+  }
 }
 
 IWORKZlibStream::~IWORKZlibStream()
@@ -18,7 +18,14 @@ namespace libetonyek
 class IWORKZlibStream : public librevenge::RVNGInputStream
 {
 public:
-  explicit IWORKZlibStream(const RVNGInputStreamPtr_t &stream);
+  enum Mode
+  {
+    MODE_WHOLE, //! Inflate the whole stream at once.
+    MODE_STREAMING //! Inflate the data when they are read, keeping only a window of them in memory.
+  };
+
+public:
+  explicit IWORKZlibStream(const RVNGInputStreamPtr_t &stream, Mode mode = MODE_WHOLE);
   ~IWORKZlibStream() override;
 
   bool isStructured() override;
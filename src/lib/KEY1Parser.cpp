@@ -509,7 +509,7 @@ void BasicShapeElement::endOfElement()
   if (!m_style)
     m_style = std::make_shared<IWORKStyle>(IWORKPropertyMap(), boost::none, IWORKStylePtr_t());
   if (m_opacity)
-    m_style->getPropertyMap().put<property::Opacity>(get(m_opacity));
+    m_style->put<property::Opacity>(get(m_opacity));
   if (m_strokeColor || m_strokeWidth)
   {
     IWORKStroke stroke;
@@ -519,7 +519,7 @@ void BasicShapeElement::endOfElement()
       stroke.m_pattern.m_type = IWORK_STROKE_TYPE_SOLID;
     if (m_strokeColor) stroke.m_color=get(m_strokeColor);
     if (m_strokeWidth) stroke.m_width=get(m_strokeWidth);
-    m_style->getPropertyMap().put<property::Stroke>(stroke);
+    m_style->put<property::Stroke>(stroke);
   }
 }
 
@@ -604,6 +604,8 @@ void ImageElement::endOfElement()
     content = std::make_shared<IWORKMediaContent>();
     content->m_data = std::make_shared<IWORKData>();
     content->m_data->m_stream.reset(getState().getParser().getPackage()->getSubStreamByName(get(m_imageName).c_str()));
+    if (content->m_data->m_stream)
+      content->m_data->m_path = get(m_imageName);
     content->m_size=m_naturalSize;
   }
   IWORKGeometryPtr_t geometry;
@@ -1974,6 +1976,12 @@ IWORKXMLContextPtr_t KEY1Parser::createDiscardContext()
   return std::make_shared<DiscardContext>(m_state);
 }
 
+bool KEY1Parser::isDiscardHarvesting() const
+{
+  // the discard context only knows elements of the newer formats
+  return false;
+}
+
 const IWORKTokenizer &KEY1Parser::getTokenizer() const
 {
   return KEY1Token::getTokenizer();
@@ -29,6 +29,7 @@ public:
 private:
   IWORKXMLContextPtr_t createDocumentContext() override;
   IWORKXMLContextPtr_t createDiscardContext() override;
+  bool isDiscardHarvesting() const override;
   const IWORKTokenizer &getTokenizer() const override;
 
 private:
@@ -9,14 +9,20 @@
 #include "KEY6Parser.h"
 
 #include <algorithm>
+#include <exception>
 #include <functional>
 #include <iostream>
 #include <memory>
+#include <vector>
+
+#include <libetonyek/EtonyekDocument.h>
 
 #include "IWAMessage.h"
+#include "IWAObjectIndex.h"
 #include "IWAObjectType.h"
 #include "IWORKProperties.h"
 #include "IWORKText.h"
+#include "IWORKThreadPool.h"
 #include "KEY6ObjectType.h"
 #include "KEYCollector.h"
 
@@ -34,15 +40,77 @@ using std::for_each;
 using std::make_shared;
 using std::string;
 
+namespace
+{
+
+/// Number of slides a worker parses before the slides are sent.
+const std::size_t slidesPerRound = 4;
+
+}
+
+/** A parser of slides running in a worker thread.
+  *
+  * It has its own collector and caches. Only the object index, the
+  * master slides and the table names are shared with the main parser.
+  */
+struct KEY6Parser::Worker
+{
+  explicit Worker(const KEY6Parser &parent);
+  ~Worker();
+
+  KEYSlidePtr_t parseSlide(unsigned id);
+
+  KEYCollector m_collector;
+  KEY6Parser m_parser;
+};
+
+KEY6Parser::Worker::Worker(const KEY6Parser &parent)
+  : m_collector(nullptr)
+  , m_parser(parent, m_collector)
+{
+  // the same pictures are often used on many slides
+  m_collector.setMediaCache(parent.m_collector.getMediaCache());
+  m_collector.numberLayersOnWrite(parent.m_collector);
+  m_collector.startSlides();
+}
+
+KEY6Parser::Worker::~Worker()
+{
+  m_collector.endSlides();
+}
+
+KEYSlidePtr_t KEY6Parser::Worker::parseSlide(const unsigned id)
+{
+  return m_parser.parseSlide(id, false);
+}
+
 KEY6Parser::KEY6Parser(const RVNGInputStreamPtr_t &fragments, const RVNGInputStreamPtr_t &package, KEYCollector &collector)
   : IWAParser(fragments, package, collector)
   , m_collector(collector)
   , m_masterSlides()
-  , m_slides()
   , m_slideStyles()
+  , m_slideIds()
 {
 }
 
+KEY6Parser::KEY6Parser(const KEY6Parser &parent, KEYCollector &collector)
+  : IWAParser(RVNGInputStreamPtr_t(), RVNGInputStreamPtr_t(), collector)
+  , m_collector(collector)
+  , m_masterSlides(parent.m_masterSlides)
+  , m_slideStyles(parent.m_slideStyles)
+  , m_slideIds()
+{
+  // the slides are already parsed in parallel
+  setOptions(parent.getOptions() & ~unsigned(EtonyekDocument::OPTION_PARALLEL_SLIDES | EtonyekDocument::OPTION_PARALLEL_TABLES));
+  setObjectIndex(parent.getObjectIndex());
+  // the styles parsed by the main thread do not change any more
+  shareStyles(parent);
+  // the slides are written by the main thread, in their order, so the
+  // tables are named then
+  m_tableNameMap = parent.m_tableNameMap;
+  m_tableNamesOnWrite = true;
+}
+
 bool KEY6Parser::parseDocument()
 {
   const ObjectMessage msg(*this, 1, KEY6ObjectType::Document);
@@ -80,10 +148,11 @@ bool KEY6Parser::parsePresentation(const unsigned id)
       const deque<unsigned> &slideListRefs = readRefs(get(get(msg).message(3)), 2);
       for_each(slideListRefs.begin(), slideListRefs.end(), bind(&KEY6Parser::parseSlideList, this, _1));
     }
+    parseSlides();
   }
   m_collector.endSlides();
 
-  m_collector.sendSlides(m_slides);
+  // the slides have been sent while they were parsed
   m_collector.endDocument();
   return success;
 }
@@ -97,10 +166,99 @@ bool KEY6Parser::parseSlideList(const unsigned id)
   const deque<unsigned> &slideListRefs = readRefs(get(msg), 1);
   for_each(slideListRefs.begin(), slideListRefs.end(), bind(&KEY6Parser::parseSlideList, this, _1));
   const deque<unsigned> &slideRefs = readRefs(get(msg), 2);
-  for_each(slideRefs.begin(), slideRefs.end(), bind(&KEY6Parser::parseSlide, this, _1, false));
+  if (getOptions() & EtonyekDocument::OPTION_PARALLEL_SLIDES)
+  {
+    m_slideIds.insert(m_slideIds.end(), slideRefs.begin(), slideRefs.end());
+    return true;
+  }
+  for (const auto slideRef : slideRefs)
+  {
+    // a slide is not needed after it has been sent
+    const KEYSlidePtr_t slide = parseSlide(slideRef, false);
+    if (slide)
+      m_collector.sendSlide(slide);
+  }
   return true;
 }
 
+/** Parse the slides collected by parseSlideList() in worker threads.
+  *
+  * The slides are sent in their order, a few at a time. The masters
+  * are parsed first, so the workers can share them. The layers are
+  * numbered when the slides are sent, so they get the same numbers as
+  * if the slides were parsed one by one.
+  */
+void KEY6Parser::parseSlides()
+{
+  if (m_slideIds.empty())
+    return;
+
+  m_collector.numberLayersOnWrite(m_collector);
+  for (const auto id : m_slideIds)
+  {
+    const ObjectMessage msg(*this, id, KEY6ObjectType::Slide);
+    if (msg)
+    {
+      const optional<unsigned> &masterRef = readRef(get(msg), 17);
+      if (masterRef && (m_masterSlides.find(get(masterRef)) == m_masterSlides.end()))
+      {
+        parseSlide(get(masterRef), true);
+        // do not let the workers try a broken master again
+        m_masterSlides.insert(std::make_pair(get(masterRef), KEYSlidePtr_t()));
+      }
+      // parse the slide styles once, for all the workers
+      const optional<unsigned> &styleRef = readRef(get(msg), 1);
+      if (styleRef)
+        querySlideStyle(get(styleRef));
+    }
+  }
+
+  const IWAObjectIndex::SharedScope sharedIndex(*getObjectIndex());
+  IWORKThreadPool pool;
+  std::vector<std::unique_ptr<Worker> > workers;
+  for (unsigned i = 0; i != pool.size(); ++i)
+    workers.push_back(std::unique_ptr<Worker>(new Worker(*this)));
+
+  const std::size_t roundSize = slidesPerRound * workers.size();
+  for (std::size_t begin = 0; begin < m_slideIds.size(); begin += roundSize)
+  {
+    const std::size_t end = std::min(begin + roundSize, m_slideIds.size());
+    std::vector<KEYSlidePtr_t> slides(end - begin);
+    std::vector<std::exception_ptr> errors(end - begin);
+    for (std::size_t w = 0; w != workers.size(); ++w)
+    {
+      pool.post([&, begin, end, w]()
+      {
+        for (std::size_t i = begin + w; i < end; i += workers.size())
+        {
+          try
+          {
+            slides[i - begin] = workers[w]->parseSlide(m_slideIds[i]);
+          }
+          catch (...)
+          {
+            // the worker is in an unknown state now
+            errors[i - begin] = std::current_exception();
+            return;
+          }
+        }
+      });
+    }
+    pool.wait();
+
+    // fail at the same slide as sequential parsing would
+    for (std::size_t i = 0; i != slides.size(); ++i)
+    {
+      if (errors[i])
+        std::rethrow_exception(errors[i]);
+      if (slides[i])
+        m_collector.sendSlide(slides[i]);
+    }
+  }
+
+  m_slideIds.clear();
+}
+
 KEYSlidePtr_t KEY6Parser::parseSlide(const unsigned id, const bool master)
 {
   const ObjectMessage msg(*this, id, KEY6ObjectType::Slide);
@@ -151,9 +309,8 @@ KEYSlidePtr_t KEY6Parser::parseSlide(const unsigned id, const bool master)
   if (slide)
   {
     slide->m_masterSlide=masterSlide;
-    if (!master)
-      m_slides.push_back(slide);
-    else
+    // a master can be used by more slides
+    if (master)
       m_masterSlides[id]=slide;
   }
   return slide;
@@ -10,6 +10,8 @@
 #ifndef KEY6PARSER_H_INCLUDED
 #define KEY6PARSER_H_INCLUDED
 
+#include <deque>
+
 #include "IWAParser.h"
 
 #include "KEYTypes_fwd.h"
@@ -25,10 +27,15 @@ public:
   KEY6Parser(const RVNGInputStreamPtr_t &fragments, const RVNGInputStreamPtr_t &package, KEYCollector &collector);
 
 private:
+  struct Worker;
+
+  KEY6Parser(const KEY6Parser &parent, KEYCollector &collector);
+
   bool parseDocument() override;
 
   bool parsePresentation(unsigned id);
   bool parseSlideList(unsigned id);
+  void parseSlides();
   KEYSlidePtr_t parseSlide(unsigned id, bool master);
   bool parsePlaceholder(unsigned id);
   void parseNotes(unsigned id);
@@ -43,8 +50,9 @@ private:
   KEYCollector &m_collector;
 
   mutable std::unordered_map<unsigned, KEYSlidePtr_t> m_masterSlides;
-  mutable std::deque<KEYSlidePtr_t> m_slides;
   mutable StyleMap_t m_slideStyles;
+
+  std::deque<unsigned> m_slideIds; //!< slides waiting to be parsed in parallel
 };
 
 }
@@ -41,7 +41,12 @@ KEYCollector::KEYCollector(IWORKDocumentInterface *const document)
   , m_stickyNotes()
   , m_pageOpened(false)
   , m_layerOpened(false)
-  , m_layerCount(0)
+  , m_layerCount(std::make_shared<int>(0))
+  , m_layersOnWrite(false)
+  , m_metadataSent(false)
+  , m_masterNames()
+  , m_usedMasterNames()
+  , m_masterNameId(0)
 {
   assert(!m_inSlides);
 }
@@ -80,13 +85,16 @@ void KEYCollector::insertLayer(const KEYLayerPtr_t &layer)
   {
     if (m_currentSlide)
     {
-
-      ++m_layerCount;
-
       librevenge::RVNGPropertyList props;
-      props.insert("svg:id", m_layerCount);
-
-      m_currentSlide->m_content.addStartLayer(props);
+      if (m_layersOnWrite)
+      {
+        m_currentSlide->m_content.addStartLayer(props, m_layerCount);
+      }
+      else
+      {
+        props.insert("svg:id", ++*m_layerCount);
+        m_currentSlide->m_content.addStartLayer(props);
+      }
       if (layer->m_outputId)
         m_currentSlide->m_content.append(getOutputManager().get(get(layer->m_outputId)));
       m_currentSlide->m_content.addEndLayer();
@@ -98,6 +106,12 @@ void KEYCollector::insertLayer(const KEYLayerPtr_t &layer)
   }
 }
 
+void KEYCollector::numberLayersOnWrite(const KEYCollector &other)
+{
+  m_layerCount = other.m_layerCount;
+  m_layersOnWrite = true;
+}
+
 KEYSlidePtr_t KEYCollector::collectSlide()
 {
   assert(m_pageOpened);
@@ -117,6 +131,16 @@ KEYSlidePtr_t KEYCollector::collectSlide()
   return KEYSlidePtr_t();
 }
 
+void KEYCollector::sendMetadata()
+{
+  if (m_metadataSent)
+    return;
+  RVNGPropertyList metadata;
+  fillMetadata(metadata);
+  m_document->setDocumentMetaData(metadata);
+  m_metadataSent = true;
+}
+
 void KEYCollector::insertSlide(const KEYSlidePtr_t &slide, bool isMaster, const boost::optional<std::string> &pageName)
 {
   if (!slide)
@@ -238,51 +262,50 @@ void KEYCollector::startDocument()
 
 void KEYCollector::sendSlides(const std::deque<KEYSlidePtr_t> &slides)
 {
-  RVNGPropertyList metadata;
-  fillMetadata(metadata);
-  m_document->setDocumentMetaData(metadata);
-
-  std::map<KEYSlide const *, std::string> masterToNameMap;
-  std::set<std::string> nameSet;
-  unsigned nameId=0;
+  sendMetadata();
   for (auto slide : slides)
+    sendSlide(slide);
+}
+
+void KEYCollector::sendSlide(const KEYSlidePtr_t &slide)
+{
+  sendMetadata();
+  if (!slide) return;
+  boost::optional<std::string> name;
+  if (slide->m_masterSlide)
   {
-    if (!slide) continue;
-    boost::optional<std::string> name;
-    if (slide->m_masterSlide)
+    if (m_masterNames.find(slide->m_masterSlide.get())==m_masterNames.end())
     {
-      if (masterToNameMap.find(slide->m_masterSlide.get())==masterToNameMap.end())
+      if (slide->m_masterSlide->m_name && m_usedMasterNames.find(get(slide->m_masterSlide->m_name))==m_usedMasterNames.end())
+        name=get(slide->m_masterSlide->m_name);
+      else
       {
-        if (slide->m_masterSlide->m_name && nameSet.find(get(slide->m_masterSlide->m_name))==nameSet.end())
-          name=get(slide->m_masterSlide->m_name);
-        else
+        // ok try to find an unused name
+        do
         {
-          // ok try to find an unused name
-          do
-          {
-            std::stringstream s;
-            if (slide->m_masterSlide->m_name)
-              s << get(slide->m_masterSlide->m_name) << nameId++;
-            else
-              s << "MasterSlide" << nameId++;
-            name=s.str();
-          }
-          while (nameSet.find(get(name))!=nameSet.end());
+          std::stringstream s;
+          if (slide->m_masterSlide->m_name)
+            s << get(slide->m_masterSlide->m_name) << m_masterNameId++;
+          else
+            s << "MasterSlide" << m_masterNameId++;
+          name=s.str();
         }
-        nameSet.insert(get(name));
-        masterToNameMap[slide->m_masterSlide.get()]=get(name);
-        insertSlide(slide->m_masterSlide, true, name);
+        while (m_usedMasterNames.find(get(name))!=m_usedMasterNames.end());
       }
-      else
-        name=masterToNameMap.find(slide->m_masterSlide.get())->second;
+      m_usedMasterNames.insert(get(name));
+      m_masterNames[slide->m_masterSlide.get()]=get(name);
+      insertSlide(slide->m_masterSlide, true, name);
     }
-    insertSlide(slide, false, name);
+    else
+      name=m_masterNames.find(slide->m_masterSlide.get())->second;
   }
-
+  insertSlide(slide, false, name);
 }
 
 void KEYCollector::endDocument()
 {
+  // there might have been no slide
+  sendMetadata();
   IWORKCollector::endDocument();
 }
 
@@ -382,6 +405,8 @@ void KEYCollector::drawTable()
   if (bool(m_currentTable->getStyle()))
     fillWrapProps(m_currentTable->getStyle(), tableProps, m_currentTable->getOrder());
 
+  // simple tables have no formulas, so it does not matter that the
+  // slides are sent before the tables of later slides are named
   m_currentTable->draw(tableProps, m_outputManager.getCurrent(), true);
 }
 
@@ -392,6 +417,10 @@ void KEYCollector::drawMedia(
   librevenge::RVNGPropertyList style(data);
   if (style["office:binary-data"])
     style.remove("office:binary-data");
+  if (style["librevenge:media-id"])
+    style.remove("librevenge:media-id");
+  if (style["xlink:href"])
+    style.remove("xlink:href");
   getOutputManager().getCurrent().addSetStyle(style);
 
   librevenge::RVNGPropertyList props(data);
@@ -11,6 +11,10 @@
 #define KEYCOLLECTOR_H_INCLUDED
 
 #include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
 
 #include "IWORKCollector.h"
 #include "IWORKPath_fwd.h"
@@ -33,6 +37,17 @@ public:
 
   KEYLayerPtr_t collectLayer();
   void insertLayer(const KEYLayerPtr_t &layer);
+
+
+  /** Number the layers when they are written, not when they are inserted.
+    *
+    * Slides collected by more collectors, in any order, then get the
+    * numbers they would get from one collector, as long as they are
+    * written in order.
+    *
+    * @arg[in] other the collector to share the count of layers with
+    */
+  void numberLayersOnWrite(const KEYCollector &other);
   KEYSlidePtr_t collectSlide();
 
   KEYPlaceholderPtr_t collectTextPlaceholder(const IWORKStylePtr_t &style, bool title, const boost::optional<unsigned> &resizeFlags=boost::none);
@@ -48,6 +63,14 @@ public:
 
   void startDocument();
   void sendSlides(const std::deque<KEYSlidePtr_t> &slides);
+
+  /** Send a slide to the document.
+    *
+    * Its master slide is sent before it, unless it has already been
+    * sent. So the slides can be sent one by one while they are parsed,
+    * instead of keeping them all until the end.
+    */
+  void sendSlide(const KEYSlidePtr_t &slide);
   void endDocument();
 
   void startSlides();
@@ -64,6 +87,7 @@ protected:
   bool m_inSlides;
 
 private:
+  void sendMetadata();
   void insertSlide(const KEYSlidePtr_t &slide, bool isMaster, const boost::optional<std::string> &pageName=boost::none);
   void drawTable() override;
   void drawMedia(double x, double y, const librevenge::RVNGPropertyList &data) override;
@@ -83,7 +107,13 @@ private:
 
   bool m_pageOpened;
   bool m_layerOpened;
-  int m_layerCount;
+  std::shared_ptr<int> m_layerCount; //!< the number of layers inserted, or written if m_layersOnWrite
+  bool m_layersOnWrite;
+
+  bool m_metadataSent;
+  std::map<const KEYSlide *, std::string> m_masterNames; //!< names of the master slides already sent
+  std::set<std::string> m_usedMasterNames;
+  unsigned m_masterNameId;
 };
 
 } // namespace libetonyek
@@ -23,10 +23,17 @@ NUMCollector::NUMCollector(IWORKDocumentInterface *const document)
   , m_workSpaceOpened(false)
   , m_workSpaceName()
   , m_workSpaceCreateGraphic(false)
+  , m_workSpaceStreamed(false)
   , m_tableElementLists()
+  , m_streamTables(false)
 {
 }
 
+void NUMCollector::setStreamTables(const bool stream)
+{
+  m_streamTables = stream;
+}
+
 void NUMCollector::startDocument()
 {
   librevenge::RVNGPropertyList calcSettings;
@@ -56,6 +63,12 @@ void NUMCollector::startWorkSpace(boost::optional<std::string> const &name)
     ETONYEK_DEBUG_MSG(("NUMCollector::startWorkSpace: oops a workSpace is already open\n"));
     endWorkSpace(nullptr);
   }
+  if (m_streamTables)
+  {
+    // send the previous sheets, so that a table of this sheet can be streamed
+    getOutputManager().getCurrent().write(m_document);
+    getOutputManager().getCurrent().clear();
+  }
   getOutputManager().push();
   m_workSpaceOpened = true;
   m_workSpaceName = name;
@@ -75,7 +88,8 @@ void NUMCollector::endWorkSpace(IWORKTableNameMapPtr_t tableNameMap)
   auto shapeElements=getOutputManager().getCurrent();
   getOutputManager().pop();
 
-  if (m_tableElementLists.size()>=2)
+  // a streamed table is already drawn, so the shapes need their own sheet
+  if (m_tableElementLists.size()>=2 || m_workSpaceStreamed)
     m_workSpaceCreateGraphic=true;
   for (auto const &tableElt : m_tableElementLists)
   {
@@ -127,11 +141,39 @@ void NUMCollector::endWorkSpace(IWORKTableNameMapPtr_t tableNameMap)
   m_workSpaceOpened = false;
   m_workSpaceName = boost::none;
   m_workSpaceCreateGraphic = false;
+  m_workSpaceStreamed = false;
+}
+
+bool NUMCollector::streamTable(const std::shared_ptr<IWORKTable> &table)
+{
+  // only the first table of a sheet can be streamed, and only if
+  // nothing must be inserted before its rows
+  if (!m_streamTables || bool(m_recorder) || !m_workSpaceOpened || m_workSpaceStreamed || m_workSpaceCreateGraphic)
+    return false;
+  if (!m_tableElementLists.empty() || !getOutputManager().getCurrent().empty() || m_levelStack.empty())
+    return false;
+  // check if the table can be the main sheet
+  glm::dvec3 vec = m_levelStack.top().m_trafo * glm::dvec3(0, 0, 1);
+  if (vec[0]>5 || vec[1]>5)
+    return false;
+
+  m_workSpaceStreamed = true;
+  IWORKDocumentInterface *const document = m_document;
+  table->startStreaming(librevenge::RVNGPropertyList(), false, [document](const IWORKOutputElements &elements)
+  {
+    elements.write(document);
+  });
+  return true;
 }
 
 void NUMCollector::drawTable()
 {
   assert(bool(m_currentTable));
+  if (m_currentTable->isStreaming())
+  {
+    m_currentTable->endStreaming();
+    return;
+  }
   if (!m_workSpaceCreateGraphic && !m_levelStack.empty())
   {
     // check if the table can be the main sheet
@@ -148,7 +190,7 @@ void NUMCollector::drawMedia(
   const double x, const double y,
   const librevenge::RVNGPropertyList &data)
 {
-  if (!data["office:binary-data"] || !data["librevenge:mime-type"])
+  if ((!data["office:binary-data"] && !data["xlink:href"]) || !data["librevenge:mime-type"])
   {
     ETONYEK_DEBUG_MSG(("NUMCollector::drawMedia: oops can not find the picture\n"));
     return;
@@ -159,10 +201,17 @@ void NUMCollector::drawMedia(
   frameProps.insert("svg:y", pt2in(y));
   frameProps.remove("librevenge:mime-type");
   frameProps.remove("office:binary-data");
+  frameProps.remove("librevenge:media-id");
+  frameProps.remove("xlink:href");
 
   librevenge::RVNGPropertyList binaryObjectProps;
   binaryObjectProps.insert("librevenge:mime-type", data["librevenge:mime-type"]->clone());
-  binaryObjectProps.insert("office:binary-data", data["office:binary-data"]->clone());
+  if (data["office:binary-data"])
+    binaryObjectProps.insert("office:binary-data", data["office:binary-data"]->clone());
+  if (data["librevenge:media-id"])
+    binaryObjectProps.insert("librevenge:media-id", data["librevenge:media-id"]->clone());
+  if (data["xlink:href"])
+    binaryObjectProps.insert("xlink:href", data["xlink:href"]->clone());
 
   getOutputManager().getCurrent().addOpenFrame(frameProps);
   getOutputManager().getCurrent().addInsertBinaryObject(binaryObjectProps);
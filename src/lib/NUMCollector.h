@@ -35,6 +35,14 @@ public:
     return m_workSpaceName;
   }
 
+  bool streamTable(const std::shared_ptr<IWORKTable> &table) final;
+
+  /** Send each sheet to the document as soon as it is finished.
+    *
+    * This also allows to stream tables, see streamTable().
+    */
+  void setStreamTables(bool stream);
+
   void collectStickyNote() final;
 private:
   void drawTable() final;
@@ -49,7 +57,9 @@ private:
   bool m_workSpaceOpened;
   boost::optional<std::string> m_workSpaceName;
   bool m_workSpaceCreateGraphic;
+  bool m_workSpaceStreamed;
   std::vector<IWORKOutputElements> m_tableElementLists;
+  bool m_streamTables;
 };
 
 } // namespace libetonyek
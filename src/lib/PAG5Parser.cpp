@@ -54,7 +54,7 @@ bool PAG5Parser::parseGroupRef(unsigned id)
     }
     m_collector.openPageGroup(int(get(pIt.uint32(1)))+1);
     std::deque<unsigned> shapeRefs;
-    const std::deque<IWAMessage> &objs = pIt.message(4).repeated();
+    const auto &objs = pIt.message(4).repeated();
     for (const auto &obj : objs)
     {
       auto ref=readRef(obj, 1);
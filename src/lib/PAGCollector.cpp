@@ -282,7 +282,7 @@ void PAGCollector::drawTable()
 
 void PAGCollector::drawMedia(const double x, const double y, const librevenge::RVNGPropertyList &data)
 {
-  if (!data["office:binary-data"] || !data["librevenge:mime-type"])
+  if ((!data["office:binary-data"] && !data["xlink:href"]) || !data["librevenge:mime-type"])
   {
     ETONYEK_DEBUG_MSG(("PAGCollector::drawMedia: oops can not find the picture\n"));
     return;
@@ -301,10 +301,17 @@ void PAGCollector::drawMedia(const double x, const double y, const librevenge::R
   }
   frameProps.remove("librevenge:mime-type");
   frameProps.remove("office:binary-data");
+  frameProps.remove("librevenge:media-id");
+  frameProps.remove("xlink:href");
 
   RVNGPropertyList binaryObjectProps;
   binaryObjectProps.insert("librevenge:mime-type", data["librevenge:mime-type"]->clone());
-  binaryObjectProps.insert("office:binary-data", data["office:binary-data"]->clone());
+  if (data["office:binary-data"])
+    binaryObjectProps.insert("office:binary-data", data["office:binary-data"]->clone());
+  if (data["librevenge:media-id"])
+    binaryObjectProps.insert("librevenge:media-id", data["librevenge:media-id"]->clone());
+  if (data["xlink:href"])
+    binaryObjectProps.insert("xlink:href", data["xlink:href"]->clone());
 
   getOutputManager().getCurrent().addOpenFrame(frameProps);
   getOutputManager().getCurrent().addInsertBinaryObject(binaryObjectProps);
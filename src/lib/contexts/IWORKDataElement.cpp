@@ -11,7 +11,9 @@
 
 #include <memory>
 
+#include "IWORKCollector.h"
 #include "IWORKDictionary.h"
+#include "IWORKMediaCache.h"
 #include "IWORKParser.h"
 #include "IWORKToken.h"
 #include "IWORKTokenizer.h"
@@ -27,6 +29,7 @@ IWORKDataElement::IWORKDataElement(IWORKXMLParserState &state, IWORKDataPtr_t &d
   , m_fillColor(fillColor)
   , m_displayName()
   , m_stream()
+  , m_path()
   , m_mimeType()
 {
 }
@@ -63,8 +66,16 @@ void IWORKDataElement::attribute(const int name, const char *const value)
     break;
   }
   case +IWORKToken::NS_URI_SF | IWORKToken::path :
+    if (getState().getCollector().getMediaCache()->getReferences() && getState().getParser().getPackage()->existsSubStream(value))
+    {
+      // the content is not needed
+      m_path = value;
+      break;
+    }
     m_stream.reset(getState().getParser().getPackage()->getSubStreamByName(value));
-    if (!m_stream)
+    if (m_stream)
+      m_path = value;
+    else
     {
       // basic theme files can be absent, try to recover some
       std::string val(value);
@@ -106,10 +117,12 @@ void IWORKDataElement::attribute(const int name, const char *const value)
 
 void IWORKDataElement::endOfElement()
 {
-  if (bool(m_stream))
+  if (bool(m_stream) || bool(m_path))
   {
     m_data = std::make_shared<IWORKData>();
     m_data->m_stream = m_stream;
+    if (m_path)
+      m_data->m_path = get(m_path);
     m_data->m_displayName = m_displayName;
     if (m_mimeType)
       m_data->m_mimeType = get(m_mimeType);
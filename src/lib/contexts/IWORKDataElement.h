@@ -35,6 +35,7 @@ private:
   boost::optional<IWORKColor> &m_fillColor;
   boost::optional<std::string> m_displayName;
   RVNGInputStreamPtr_t m_stream;
+  boost::optional<std::string> m_path;
   boost::optional<std::string> m_mimeType;
 };
 
@@ -11,6 +11,7 @@
 
 #include <cassert>
 #include <ctime>
+#include <map>
 #include <memory>
 #include <sstream>
 
@@ -246,6 +247,7 @@ class CellContextBase : public IWORKXMLEmptyContextBase
 protected:
   explicit CellContextBase(IWORKXMLParserState &state, bool isResult=false);
 
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
   IWORKXMLContextPtr_t element(int name) override;
   void endOfElement() override;
@@ -263,6 +265,12 @@ CellContextBase::CellContextBase(IWORKXMLParserState &state, bool isResult)
 {
 }
 
+void CellContextBase::startOfElement()
+{
+  IWORKXMLEmptyContextBase::startOfElement();
+  m_ref.reset();
+}
+
 void CellContextBase::attribute(const int name, const char *const value)
 {
   switch (name)
@@ -478,12 +486,18 @@ class CbElement : public CellContextBase
 public:
   explicit CbElement(IWORKXMLParserState &state);
 private:
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
 };
 
 CbElement::CbElement(IWORKXMLParserState &state)
   : CellContextBase(state)
 {
+}
+
+void CbElement::startOfElement()
+{
+  CellContextBase::startOfElement();
   getState().m_tableData->m_type = IWORK_CELL_TYPE_BOOL;
 }
 
@@ -510,12 +524,18 @@ public:
   explicit DElement(IWORKXMLParserState &state, bool isResult=false);
 
 private:
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
 };
 
 DElement::DElement(IWORKXMLParserState &state, bool isResult)
   : CellContextBase(state, isResult)
 {
+}
+
+void DElement::startOfElement()
+{
+  CellContextBase::startOfElement();
   getState().m_tableData->m_type = IWORK_CELL_TYPE_DATE_TIME;
 }
 
@@ -628,12 +648,18 @@ public:
   explicit NElement(IWORKXMLParserState &state, bool isResult=false);
 
 private:
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
 };
 
 NElement::NElement(IWORKXMLParserState &state, bool isResult)
   : CellContextBase(state, isResult)
 {
+}
+
+void NElement::startOfElement()
+{
+  CellContextBase::startOfElement();
   getState().m_tableData->m_type = IWORK_CELL_TYPE_NUMBER;
 }
 
@@ -705,6 +731,7 @@ TElement::TElement(IWORKXMLParserState &state, bool isResult)
 
 void TElement::startOfElement()
 {
+  CellContextBase::startOfElement();
   if (isCollector() && !m_isResult)
   {
     // CHECKME: can we move this code in the constructor ?
@@ -1128,12 +1155,18 @@ public:
   explicit SlElement(IWORKXMLParserState &state);
 
 private:
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
 };
 
 SlElement::SlElement(IWORKXMLParserState &state)
   : CellContextBase(state)
 {
+}
+
+void SlElement::startOfElement()
+{
+  CellContextBase::startOfElement();
   getState().m_tableData->m_type = IWORK_CELL_TYPE_NUMBER;
 }
 
@@ -1166,12 +1199,18 @@ public:
   explicit StElement(IWORKXMLParserState &state);
 
 private:
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
 };
 
 StElement::StElement(IWORKXMLParserState &state)
   : CellContextBase(state)
 {
+}
+
+void StElement::startOfElement()
+{
+  CellContextBase::startOfElement();
   getState().m_tableData->m_type = IWORK_CELL_TYPE_NUMBER;
 }
 
@@ -1244,6 +1283,7 @@ public:
 protected:
   void emitCell(const bool covered);
 
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
   IWORKXMLContextPtr_t element(int name) override;
   void endOfElement() override;
@@ -1263,6 +1303,13 @@ GenericCellElement::GenericCellElement(IWORKXMLParserState &state, bool isResult
 {
 }
 
+void GenericCellElement::startOfElement()
+{
+  IWORKXMLEmptyContextBase::startOfElement();
+  m_id.reset();
+  m_styleRef.reset();
+}
+
 void GenericCellElement::attribute(const int name, const char *const value)
 {
   switch (name)
@@ -1369,12 +1416,18 @@ class BoolCellElement : public GenericCellElement
 public:
   explicit BoolCellElement(IWORKXMLParserState &state, bool isResult=false);
 private:
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
 };
 
 BoolCellElement::BoolCellElement(IWORKXMLParserState &state, bool isResult)
   : GenericCellElement(state, isResult)
 {
+}
+
+void BoolCellElement::startOfElement()
+{
+  GenericCellElement::startOfElement();
   if (!m_isResult)
     getState().m_tableData->m_type = IWORK_CELL_TYPE_BOOL;
 }
@@ -1402,12 +1455,18 @@ public:
   explicit DateCellElement(IWORKXMLParserState &state, bool isResult=false);
 
 private:
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
 };
 
 DateCellElement::DateCellElement(IWORKXMLParserState &state, bool isResult)
   : GenericCellElement(state, isResult)
 {
+}
+
+void DateCellElement::startOfElement()
+{
+  GenericCellElement::startOfElement();
   if (!m_isResult)
     getState().m_tableData->m_type = IWORK_CELL_TYPE_DATE_TIME;
 }
@@ -1444,12 +1503,18 @@ public:
   explicit NumberCellElement(IWORKXMLParserState &state, bool isResult=false);
 
 private:
+  void startOfElement() override;
   void attribute(int name, const char *value) override;
 };
 
 NumberCellElement::NumberCellElement(IWORKXMLParserState &state, bool isResult)
   : GenericCellElement(state, isResult)
 {
+}
+
+void NumberCellElement::startOfElement()
+{
+  GenericCellElement::startOfElement();
   if (!m_isResult)
     getState().m_tableData->m_type = IWORK_CELL_TYPE_NUMBER;
 }
@@ -1522,6 +1587,7 @@ TextCellElement::TextCellElement(IWORKXMLParserState &state, bool isResult)
 
 void TextCellElement::startOfElement()
 {
+  GenericCellElement::startOfElement();
   if (isCollector())
   {
     // CHECKME: can we move this code in the constructor ?
@@ -1628,10 +1694,17 @@ public:
 private:
   void startOfElement() override;
   IWORKXMLContextPtr_t element(int name) override;
+
+  template<class T>
+  IWORKXMLContextPtr_t getCellContext(int name);
+
+private:
+  std::map<int, IWORKXMLContextPtr_t> m_cellContexts;
 };
 
 DatasourceElement::DatasourceElement(IWORKXMLParserState &state)
   : IWORKXMLElementContextBase(state)
+  , m_cellContexts()
 {
   // these must be defined before datasource, otherwise we have a problem
   assert(!getState().m_tableData->m_columnSizes.empty());
@@ -1652,43 +1725,43 @@ IWORKXMLContextPtr_t DatasourceElement::element(const int name)
   switch (name)
   {
   case +IWORKToken::cb | IWORKToken::NS_URI_SF :
-    return std::make_shared<CbElement>(getState());
+    return getCellContext<CbElement>(name);
   case +IWORKToken::d | IWORKToken::NS_URI_SF :
-    return std::make_shared<DElement>(getState());
+    return getCellContext<DElement>(name);
   case +IWORKToken::du | IWORKToken::NS_URI_SF :
-    return std::make_shared<DuElement>(getState());
+    return getCellContext<DuElement>(name);
   case +IWORKToken::f | IWORKToken::NS_URI_SF :
-    return std::make_shared<FElement>(getState());
+    return getCellContext<FElement>(name);
   case +IWORKToken::g | IWORKToken::NS_URI_SF :
-    return std::make_shared<GElement>(getState());
+    return getCellContext<GElement>(name);
   case +IWORKToken::grouping | IWORKToken::NS_URI_SF :
-    return std::make_shared<GroupingElement>(getState());
+    return getCellContext<GroupingElement>(name);
   case +IWORKToken::n | IWORKToken::NS_URI_SF :
-    return std::make_shared<NElement>(getState());
+    return getCellContext<NElement>(name);
   case +IWORKToken::o | IWORKToken::NS_URI_SF :
-    return std::make_shared<OElement>(getState());
+    return getCellContext<OElement>(name);
   case +IWORKToken::pm | IWORKToken::NS_URI_SF :
     return std::make_shared<PmElement>(getState());
   case +IWORKToken::s | IWORKToken::NS_URI_SF :
-    return std::make_shared<SElement>(getState());
+    return getCellContext<SElement>(name);
   case +IWORKToken::sl | IWORKToken::NS_URI_SF :
-    return std::make_shared<SlElement>(getState());
+    return getCellContext<SlElement>(name);
   case +IWORKToken::st | IWORKToken::NS_URI_SF :
-    return std::make_shared<StElement>(getState());
+    return getCellContext<StElement>(name);
   case +IWORKToken::t | IWORKToken::NS_URI_SF :
-    return std::make_shared<TElement>(getState());
+    return getCellContext<TElement>(name);
   case +IWORKToken::date_cell | IWORKToken::NS_URI_SF :
-    return std::make_shared<DateCellElement>(getState());
+    return getCellContext<DateCellElement>(name);
   case +IWORKToken::generic_cell | IWORKToken::NS_URI_SF :
-    return std::make_shared<GenericCellElement>(getState());
+    return getCellContext<GenericCellElement>(name);
   case +IWORKToken::formula_cell | IWORKToken::NS_URI_SF :
-    return std::make_shared<FormulaCellElement>(getState());
+    return getCellContext<FormulaCellElement>(name);
   case +IWORKToken::number_cell | IWORKToken::NS_URI_SF :
-    return std::make_shared<NumberCellElement>(getState());
+    return getCellContext<NumberCellElement>(name);
   case +IWORKToken::span_cell | IWORKToken::NS_URI_SF :
-    return std::make_shared<SpanCellElement>(getState());
+    return getCellContext<SpanCellElement>(name);
   case +IWORKToken::text_cell | IWORKToken::NS_URI_SF :
-    return std::make_shared<TextCellElement>(getState());
+    return getCellContext<TextCellElement>(name);
   default:
     break;
   }
@@ -1697,6 +1770,20 @@ IWORKXMLContextPtr_t DatasourceElement::element(const int name)
   return IWORKXMLContextPtr_t();
 }
 
+/** Get a context for a cell.
+  *
+  * There can be a lot of cells, so the context of the previous cell of
+  * the same type is reused, unless something still holds it.
+  */
+template<class T>
+IWORKXMLContextPtr_t DatasourceElement::getCellContext(const int name)
+{
+  IWORKXMLContextPtr_t &context = m_cellContexts[name];
+  if (!context || !context.unique())
+    context = std::make_shared<T>(getState());
+  return context;
+}
+
 }
 
 namespace
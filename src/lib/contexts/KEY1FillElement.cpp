@@ -121,6 +121,8 @@ void KEY1FillElement::endOfElement()
     IWORKMediaContent image;
     image.m_data = std::make_shared<IWORKData>();
     image.m_data->m_stream.reset(getState().getParser().getPackage()->getSubStreamByName(get(m_imageName).c_str()));
+    if (image.m_data->m_stream)
+      image.m_data->m_path = get(m_imageName);
     if (m_imageType) image.m_type=get(m_imageType);
     image.m_fillColor=m_color;
     m_fill=image;
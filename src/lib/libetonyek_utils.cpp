@@ -384,6 +384,48 @@ catch (...)
   return std::string();
 }
 
+std::string detectMimetypeFromName(const std::string &name)
+{
+  struct Extension
+  {
+    const char *m_extension;
+    const char *m_mimetype;
+  };
+  static const Extension extensions[] =
+  {
+    { "bmp", "image/bmp" },
+    { "gif", "image/gif" },
+    { "jp2", "image/jpx" },
+    { "jpeg", "image/jpeg" },
+    { "jpg", "image/jpeg" },
+    { "m4a", "audio/mp4" },
+    { "m4v", "video/mp4" },
+    { "mov", "video/quicktime" },
+    { "mp3", "audio/mpeg" },
+    { "mp4", "video/mp4" },
+    { "pdf", "application/pdf" },
+    { "png", "image/png" },
+    { "tif", "image/tiff" },
+    { "tiff", "image/tiff" }
+  };
+
+  const std::string::size_type dot = name.find_last_of('.');
+  if ((dot == std::string::npos) || (name.find('/', dot) != std::string::npos))
+    return std::string();
+  std::string extension(name, dot + 1);
+  for (auto &c : extension)
+  {
+    if ((c >= 'A') && (c <= 'Z'))
+      c = char(c - 'A' + 'a');
+  }
+  for (const auto &ext : extensions)
+  {
+    if (extension == ext.m_extension)
+      return std::string(ext.m_mimetype);
+  }
+  return std::string();
+}
+
 
 bool detectImageDimension(const RVNGInputStreamPtr_t &stream, double &width, double &height)
 try
@@ -145,6 +145,9 @@ librevenge::RVNGString makeColor(const IWORKGradient &gradient);
 void writeBorder(const IWORKStroke &stroke, const char *name, librevenge::RVNGPropertyList &props);
 
 std::string detectMimetype(const RVNGInputStreamPtr_t &stream);
+/** Guess the mimetype of a file from the extension of its name.
+  */
+std::string detectMimetypeFromName(const std::string &name);
 bool detectImageDimension(const RVNGInputStreamPtr_t &stream, double &width, double &height);
 
 class EndOfStreamException
@@ -7,6 +7,7 @@
  * file, You can obtain one at http://mozilla.org/MPL/2.0/.
  */
 
+#include <memory>
 #include <string>
 
 #include <cppunit/TestFixture.h>
@@ -39,6 +40,21 @@ void assertDetection(const string &name, const EtonyekDocument::Confidence expec
   CPPUNIT_ASSERT_EQUAL_MESSAGE(name + ": confidence", expectedConfidence, confidence);
   if (expectedType)
     CPPUNIT_ASSERT_EQUAL_MESSAGE(name + ": type", *expectedType, type);
+
+  // opening must find the same
+  Stream openInput((string(ETONYEK_DETECTION_TEST_DIR) + "/" + name).c_str());
+  const std::unique_ptr<EtonyekDocument::Handle> handle(EtonyekDocument::open(&openInput));
+  if (expectedConfidence == EtonyekDocument::CONFIDENCE_NONE)
+  {
+    CPPUNIT_ASSERT_MESSAGE(name + ": opened", !handle);
+  }
+  else
+  {
+    CPPUNIT_ASSERT_MESSAGE(name + ": not opened", bool(handle));
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(name + ": opened confidence", expectedConfidence, handle->getConfidence());
+    if (expectedType)
+      CPPUNIT_ASSERT_EQUAL_MESSAGE(name + ": opened type", *expectedType, handle->getType());
+  }
 }
 
 void assertSupportedFile(const string &name, const EtonyekDocument::Confidence confidence, const EtonyekDocument::Type type)
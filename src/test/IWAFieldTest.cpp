@@ -12,12 +12,12 @@
 #include <stdexcept>
 
 #include <memory>
+#include <vector>
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "IWAField.h"
-#include "IWORKMemoryStream.h"
 
 using namespace libetonyek;
 
@@ -27,9 +27,15 @@ namespace test
 namespace
 {
 
-RVNGInputStreamPtr_t makeStream(const unsigned char *const bytes, const unsigned long length)
+IWABufferPtr_t makeBuffer(const unsigned char *const bytes, const unsigned long length)
 {
-  return std::make_shared<IWORKMemoryStream>(bytes, length);
+  return std::make_shared<const std::vector<unsigned char>>(bytes, bytes + length);
+}
+
+void parse(IWAField &field, const IWABufferPtr_t &buffer, const unsigned long length, const bool allowEmpty)
+{
+  IWAReader::Input input(buffer, 0, buffer->size());
+  field.parse(input, length, allowEmpty);
 }
 
 }
@@ -87,7 +93,7 @@ void IWAFieldTest::testEmpty()
 void IWAFieldTest::testParse()
 {
   IWAUInt64Field field;
-  CPPUNIT_ASSERT_NO_THROW(field.parse(makeStream(BYTES("\x1")), 1, false));
+  CPPUNIT_ASSERT_NO_THROW(parse(field, makeBuffer(BYTES("\x1")), 1, false));
 
   // repeated
   CPPUNIT_ASSERT(!field.empty());
@@ -100,7 +106,7 @@ void IWAFieldTest::testParse()
   CPPUNIT_ASSERT_EQUAL(uint64_t(1), field.get());
 
   // parse another value
-  CPPUNIT_ASSERT_NO_THROW(field.parse(makeStream(BYTES("\xac\x2")), 1, false));
+  CPPUNIT_ASSERT_NO_THROW(parse(field, makeBuffer(BYTES("\xac\x2")), 1, false));
 
   CPPUNIT_ASSERT_EQUAL(size_t(2), field.size());
   CPPUNIT_ASSERT_EQUAL(uint64_t(1), field[0]);
@@ -112,7 +118,7 @@ void IWAFieldTest::testParse()
 void IWAFieldTest::testParsePacked()
 {
   IWAUInt64Field field;
-  CPPUNIT_ASSERT_NO_THROW(field.parse(makeStream(BYTES("\x1\x4\x8\x10")), 3, false));
+  CPPUNIT_ASSERT_NO_THROW(parse(field, makeBuffer(BYTES("\x1\x4\x8\x10")), 3, false));
 
   // repeated
   CPPUNIT_ASSERT_EQUAL(size_t(3), field.size());
@@ -130,7 +136,7 @@ void IWAFieldTest::testOptional()
   {
     IWAUInt64Field field;
     CPPUNIT_ASSERT_EQUAL(uint64_t(4), get_optional_value_or(field, 4));
-    CPPUNIT_ASSERT_NO_THROW(field.parse(makeStream(BYTES("\x1\x4")), 2, false));
+    CPPUNIT_ASSERT_NO_THROW(parse(field, makeBuffer(BYTES("\x1\x4")), 2, false));
     const boost::optional<uint64_t> &value = field.optional();
     CPPUNIT_ASSERT(value);
     CPPUNIT_ASSERT_EQUAL(uint64_t(1), get(value));
@@ -140,7 +146,7 @@ void IWAFieldTest::testOptional()
 
   {
     IWASInt32Field field;
-    CPPUNIT_ASSERT_NO_THROW(field.parse(makeStream(BYTES("\x3")), 1, false));
+    CPPUNIT_ASSERT_NO_THROW(parse(field, makeBuffer(BYTES("\x3")), 1, false));
     CPPUNIT_ASSERT(field);
     CPPUNIT_ASSERT_EQUAL(int32_t(-2), field.get());
     const boost::optional<int64_t> value(field.optional());
@@ -152,9 +158,9 @@ void IWAFieldTest::testOptional()
 void IWAFieldTest::testRepeated()
 {
   IWAUInt64Field field;
-  CPPUNIT_ASSERT_NO_THROW(field.parse(makeStream(BYTES("\x1\x4\x8")), 3, false));
+  CPPUNIT_ASSERT_NO_THROW(parse(field, makeBuffer(BYTES("\x1\x4\x8")), 3, false));
   const uint64_t expected[] = {1, 4, 8};
-  const std::deque<uint64_t> &values = field.repeated();
+  const IWAUInt64Field::container_type &values = field.repeated();
   CPPUNIT_ASSERT_EQUAL(ETONYEK_NUM_ELEMENTS(expected), values.size());
   CPPUNIT_ASSERT(std::equal(values.begin(), values.end(), expected));
   CPPUNIT_ASSERT_EQUAL(ETONYEK_NUM_ELEMENTS(expected), std::size_t(std::distance(field.begin(), field.end())));
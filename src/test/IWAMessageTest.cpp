@@ -8,6 +8,10 @@
  */
 
 #include <memory>
+#ifdef WITH_THREADS
+#include <thread>
+#include <vector>
+#endif
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
@@ -51,6 +55,8 @@ private:
   CPPUNIT_TEST(testNestedMessageWithTrailingData);
   CPPUNIT_TEST(testEmptyMessage);
   CPPUNIT_TEST(testEmptyString);
+  CPPUNIT_TEST(testCopy);
+  CPPUNIT_TEST(testConcurrentAccess);
   CPPUNIT_TEST_SUITE_END();
 
 private:
@@ -64,6 +70,8 @@ private:
   void testNestedMessageWithTrailingData();
   void testEmptyMessage();
   void testEmptyString();
+  void testCopy();
+  void testConcurrentAccess();
 };
 
 void IWAMessageTest::setUp()
@@ -213,6 +221,47 @@ void IWAMessageTest::testEmptyString()
   CPPUNIT_ASSERT_EQUAL(string(), get(msg.string(2)));
 }
 
+void IWAMessageTest::testCopy()
+{
+  IWAMessage msg(makeStream(BYTES("\x8\x4\x12\x2\x10\x5")), 6); // {1: uint32, 2: {2: uint32}}
+  CPPUNIT_ASSERT_EQUAL(uint32_t(4), msg.uint32(1).get());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(5), msg.message(2).uint32(2).get());
+
+  // parsed fields are not shared by copies
+  const IWAMessage copy(msg);
+  CPPUNIT_ASSERT(&copy.uint32(1) != &msg.uint32(1));
+  CPPUNIT_ASSERT_EQUAL(uint32_t(4), copy.uint32(1).get());
+  CPPUNIT_ASSERT_EQUAL(uint32_t(5), copy.message(2).uint32(2).get());
+
+  msg = IWAMessage(makeStream(BYTES("\x8\x6")), 2);
+  CPPUNIT_ASSERT_EQUAL(uint32_t(6), msg.uint32(1).get());
+  CPPUNIT_ASSERT(!msg.message(2));
+  CPPUNIT_ASSERT_EQUAL(uint32_t(4), copy.uint32(1).get());
+}
+
+void IWAMessageTest::testConcurrentAccess()
+{
+  const IWAMessage msg(makeStream(BYTES("\x8\x4\x12\x2\x10\x5")), 6); // {1: uint32, 2: {2: uint32}}
+#ifdef WITH_THREADS
+  // all threads see the same parsed fields
+  std::vector<const IWAUInt32Field *> fields(8, nullptr);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i != fields.size(); ++i)
+  {
+    threads.push_back(std::thread([&msg, &fields, i]()
+    {
+      if (msg.uint32(1).get() == 4)
+        fields[i] = &msg.message(2).uint32(2);
+    }));
+  }
+  for (auto &thread : threads)
+    thread.join();
+  for (const auto field : fields)
+    CPPUNIT_ASSERT_EQUAL(&msg.message(2).uint32(2), field);
+#endif
+  CPPUNIT_ASSERT_EQUAL(uint32_t(5), msg.message(2).uint32(2).get());
+}
+
 #undef BYTES
 
 CPPUNIT_TEST_SUITE_REGISTRATION(IWAMessageTest);
@@ -0,0 +1,363 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef WITH_THREADS
+#include <thread>
+#endif
+
+#include <boost/optional.hpp>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWAMessage.h"
+#include "IWAObjectIndex.h"
+#include "IWORKMemoryStream.h"
+
+using namespace libetonyek;
+
+using std::string;
+
+namespace test
+{
+
+namespace
+{
+
+typedef std::vector<unsigned char> Bytes_t;
+
+void append(Bytes_t &out, const Bytes_t &bytes)
+{
+  out.insert(out.end(), bytes.begin(), bytes.end());
+}
+
+Bytes_t varint(uint64_t value)
+{
+  Bytes_t out;
+  while (value >= 0x80)
+  {
+    out.push_back((unsigned char)(value | 0x80));
+    value >>= 7;
+  }
+  out.push_back((unsigned char) value);
+  return out;
+}
+
+Bytes_t field(const unsigned num, const uint64_t value)
+{
+  Bytes_t out = varint(num << 3);
+  append(out, varint(value));
+  return out;
+}
+
+Bytes_t field(const unsigned num, const Bytes_t &message)
+{
+  Bytes_t out = varint((num << 3) | 2);
+  append(out, varint(message.size()));
+  append(out, message);
+  return out;
+}
+
+Bytes_t field(const unsigned num, const string &value)
+{
+  return field(num, Bytes_t(value.begin(), value.end()));
+}
+
+/// Make an object of a fragment, with its id as the only field of the data.
+Bytes_t object(const unsigned id)
+{
+  const Bytes_t data = field(1, id);
+  Bytes_t info = field(1, id + 1000);
+  append(info, field(3, data.size()));
+  Bytes_t header = field(1, id);
+  append(header, field(2, info));
+  Bytes_t out = varint(header.size());
+  append(out, header);
+  append(out, data);
+  return out;
+}
+
+/// Wrap the data in a single snappy chunk, as a single literal run.
+Bytes_t compress(const Bytes_t &data)
+{
+  Bytes_t block = varint(data.size());
+  block.push_back(0xf4);
+  block.push_back((unsigned char)((data.size() - 1) & 0xff));
+  block.push_back((unsigned char)((data.size() - 1) >> 8));
+  append(block, data);
+  Bytes_t out;
+  out.push_back(0);
+  out.push_back((unsigned char)(block.size() & 0xff));
+  out.push_back((unsigned char)((block.size() >> 8) & 0xff));
+  out.push_back((unsigned char)(block.size() >> 16));
+  append(out, block);
+  return out;
+}
+
+/** A package directory in memory.
+  *
+  * A file can have different content the first time it is opened, to
+  * simulate a failure.
+  */
+class PackageStream : public librevenge::RVNGInputStream
+{
+public:
+  explicit PackageStream(const std::map<string, Bytes_t> &files, const std::map<string, Bytes_t> &firstFiles = std::map<string, Bytes_t>())
+    : m_files(files)
+    , m_firstFiles(firstFiles)
+  {
+  }
+
+  bool isStructured() override
+  {
+    return true;
+  }
+  unsigned subStreamCount() override
+  {
+    return unsigned(m_files.size());
+  }
+  const char *subStreamName(const unsigned id) override
+  {
+    if (id >= m_files.size())
+      return nullptr;
+    auto it = m_files.begin();
+    std::advance(it, id);
+    return it->first.c_str();
+  }
+  bool existsSubStream(const char *const name) override
+  {
+    return m_files.find(name) != m_files.end();
+  }
+  librevenge::RVNGInputStream *getSubStreamByName(const char *const name) override
+  {
+    const auto firstIt = m_firstFiles.find(name);
+    if (firstIt != m_firstFiles.end())
+    {
+      librevenge::RVNGInputStream *const stream = new IWORKMemoryStream(firstIt->second);
+      m_firstFiles.erase(firstIt);
+      return stream;
+    }
+    const auto it = m_files.find(name);
+    if (it == m_files.end())
+      return nullptr;
+    return new IWORKMemoryStream(it->second);
+  }
+  librevenge::RVNGInputStream *getSubStreamById(const unsigned id) override
+  {
+    const char *const name = subStreamName(id);
+    return name ? getSubStreamByName(name) : nullptr;
+  }
+
+  const unsigned char *read(unsigned long, unsigned long &numBytesRead) override
+  {
+    numBytesRead = 0;
+    return nullptr;
+  }
+  int seek(long, librevenge::RVNG_SEEK_TYPE) override
+  {
+    return -1;
+  }
+  long tell() override
+  {
+    return 0;
+  }
+  bool isEnd() override
+  {
+    return true;
+  }
+
+private:
+  const std::map<string, Bytes_t> m_files;
+  std::map<string, Bytes_t> m_firstFiles;
+};
+
+/** Make a document with two fragments, whose objects interleave.
+  *
+  * Fragment A contains the even objects 12-60, B the odd objects
+  * 13-61. The object index only knows about a few of them.
+  *
+  * @arg[in] brokenB if true, B is broken the first time it is opened
+  */
+RVNGInputStreamPtr_t makeInterleavedDocument(const bool brokenB = false)
+{
+  Bytes_t refsA = field(1, 10);
+  append(refsA, field(2, 20));
+  Bytes_t refsA2 = field(1, 10);
+  append(refsA2, field(2, 40));
+  Bytes_t fragmentA = field(1, 10);
+  append(fragmentA, field(2, string("A")));
+  append(fragmentA, field(6, refsA));
+  append(fragmentA, field(6, refsA2));
+
+  Bytes_t refsB = field(1, 11);
+  append(refsB, field(2, 31));
+  Bytes_t refsB2 = field(1, 11);
+  append(refsB2, field(2, 51));
+  Bytes_t fragmentB = field(1, 11);
+  append(fragmentB, field(2, string("B")));
+  append(fragmentB, field(6, refsB));
+  append(fragmentB, field(6, refsB2));
+
+  Bytes_t index = field(3, fragmentA);
+  append(index, field(3, fragmentB));
+
+  Bytes_t info = field(1, 11006);
+  append(info, field(3, index.size()));
+  Bytes_t header = field(1, 2);
+  append(header, field(2, info));
+  Bytes_t metadata = varint(header.size());
+  append(metadata, header);
+  append(metadata, index);
+
+  Bytes_t a;
+  for (unsigned id = 12; id <= 60; id += 2)
+    append(a, object(id));
+  Bytes_t b;
+  for (unsigned id = 13; id <= 61; id += 2)
+    append(b, object(id));
+
+  std::map<string, Bytes_t> files;
+  files["Index/Metadata.iwa"] = compress(metadata);
+  files["Index/A.iwa"] = compress(a);
+  files["Index/B.iwa"] = compress(b);
+  std::map<string, Bytes_t> firstFiles;
+  if (brokenB)
+    firstFiles["Index/B.iwa"] = Bytes_t(2, 0); // too short for a chunk header
+  return std::make_shared<PackageStream>(files, firstFiles);
+}
+
+void assertObjects(const IWAObjectIndex &index, const unsigned first, const unsigned last)
+{
+  for (unsigned id = first; id <= last; ++id)
+  {
+    unsigned type = 0;
+    boost::optional<IWAMessage> msg;
+    index.queryObject(id, type, msg);
+    CPPUNIT_ASSERT_MESSAGE("object " + std::to_string(id), bool(msg));
+    CPPUNIT_ASSERT_EQUAL(id + 1000, type);
+    CPPUNIT_ASSERT_EQUAL(id, get(msg->uint32(1)));
+  }
+}
+
+}
+
+class IWAObjectIndexTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWAObjectIndexTest);
+  CPPUNIT_TEST(testInterleavedFragments);
+  CPPUNIT_TEST(testPrefetch);
+  CPPUNIT_TEST(testPrefetchFailure);
+  CPPUNIT_TEST(testShared);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testInterleavedFragments();
+  void testPrefetch();
+  void testPrefetchFailure();
+  void testShared();
+};
+
+void IWAObjectIndexTest::setUp()
+{
+}
+
+void IWAObjectIndexTest::tearDown()
+{
+}
+
+void IWAObjectIndexTest::testInterleavedFragments()
+{
+  IWAObjectIndex index(makeInterleavedDocument(), RVNGInputStreamPtr_t());
+  index.parse();
+
+  // scan A, then B, whose objects fall between the objects of A
+  CPPUNIT_ASSERT_EQUAL(1020u, get(index.getObjectType(20)));
+  CPPUNIT_ASSERT_EQUAL(1031u, get(index.getObjectType(31)));
+
+  assertObjects(index, 12, 61);
+  CPPUNIT_ASSERT(!index.getObjectType(62));
+}
+
+void IWAObjectIndexTest::testPrefetch()
+{
+  IWAObjectIndex index(makeInterleavedDocument(), RVNGInputStreamPtr_t());
+  index.parse();
+  index.prefetch(2);
+
+  assertObjects(index, 12, 61);
+  CPPUNIT_ASSERT(!index.getObjectType(62));
+}
+
+void IWAObjectIndexTest::testPrefetchFailure()
+{
+  IWAObjectIndex index(makeInterleavedDocument(true), RVNGInputStreamPtr_t());
+  index.parse();
+  index.prefetch(2);
+
+  // B is scanned again when one of its known objects is needed
+  CPPUNIT_ASSERT_EQUAL(1031u, get(index.getObjectType(31)));
+  assertObjects(index, 12, 61);
+}
+
+void IWAObjectIndexTest::testShared()
+{
+  IWAObjectIndex index(makeInterleavedDocument(true), RVNGInputStreamPtr_t());
+  index.parse();
+  index.prefetch(2);
+
+  {
+    // the fragment that failed is scanned when the index is shared, so
+    // the lookups do not change the index
+    const IWAObjectIndex::SharedScope shared(index);
+#ifdef WITH_THREADS
+    std::vector<unsigned> found(4, 0);
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i != found.size(); ++i)
+    {
+      threads.push_back(std::thread([&index, &found, i]()
+      {
+        for (unsigned id = 12; id <= 61; ++id)
+        {
+          unsigned type = 0;
+          boost::optional<IWAMessage> msg;
+          index.queryObject(id, type, msg);
+          if (msg && (type == id + 1000) && (get(msg->uint32(1)) == id))
+            ++found[i];
+        }
+      }));
+    }
+    for (auto &thread : threads)
+      thread.join();
+    for (const auto count : found)
+      CPPUNIT_ASSERT_EQUAL(50u, count);
+#endif
+    assertObjects(index, 12, 61);
+  }
+
+  // the index is not shared anymore, but it is still complete
+  assertObjects(index, 12, 61);
+  CPPUNIT_ASSERT(!index.getObjectType(62));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWAObjectIndexTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -8,12 +8,14 @@
  */
 
 #include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
 
 #include "IWAReader.h"
-#include "IWORKMemoryStream.h"
 #include "libetonyek_utils.h"
 
 using namespace libetonyek;
@@ -26,9 +28,16 @@ namespace test
 namespace
 {
 
-RVNGInputStreamPtr_t makeStream(const unsigned char *const bytes, const unsigned long length)
+IWABufferPtr_t makeBuffer(const unsigned char *const bytes, const unsigned long length)
 {
-  return std::make_shared<IWORKMemoryStream>(bytes, length);
+  return std::make_shared<const std::vector<unsigned char>>(bytes, bytes + length);
+}
+
+template<typename ReaderT>
+auto read(const IWABufferPtr_t &buffer, const unsigned long length) -> decltype(ReaderT::read(std::declval<IWAReader::Input &>(), length))
+{
+  IWAReader::Input input(buffer, 0, buffer->size());
+  return ReaderT::read(input, length);
 }
 
 }
@@ -43,11 +52,13 @@ private:
   CPPUNIT_TEST_SUITE(IWAReaderTest);
   CPPUNIT_TEST(testString);
   CPPUNIT_TEST(testBytes);
+  CPPUNIT_TEST(testVarint);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testString();
   void testBytes();
+  void testVarint();
 };
 
 void IWAReaderTest::setUp()
@@ -64,18 +75,32 @@ void IWAReaderTest::testString()
 {
   using namespace IWAReader;
 
-  CPPUNIT_ASSERT_EQUAL(string("hello"), String::read(makeStream(BYTES("hello")), 5));
-  CPPUNIT_ASSERT_EQUAL(string("hello"), String::read(makeStream(BYTES("hello world")), 5));
+  CPPUNIT_ASSERT_EQUAL(string("hello"), read<String>(makeBuffer(BYTES("hello")), 5));
+  CPPUNIT_ASSERT_EQUAL(string("hello"), read<String>(makeBuffer(BYTES("hello world")), 5));
 }
 
 void IWAReaderTest::testBytes()
 {
-  const RVNGInputStreamPtr_t input(IWAReader::Bytes::read(makeStream(BYTES("\x78\x56\x34\x12")), 4));
+  const RVNGInputStreamPtr_t input(read<IWAReader::Bytes>(makeBuffer(BYTES("\x78\x56\x34\x12")), 4));
   CPPUNIT_ASSERT(!input->isEnd());
   CPPUNIT_ASSERT_EQUAL(4ul, getLength(input));
   CPPUNIT_ASSERT_EQUAL(0x12345678u, readU32(input));
 }
 
+void IWAReaderTest::testVarint()
+{
+  using namespace IWAReader;
+
+  CPPUNIT_ASSERT_EQUAL(uint64_t(1), read<UInt64>(makeBuffer(BYTES("\x1")), 1));
+  CPPUNIT_ASSERT_EQUAL(uint64_t(300), read<UInt64>(makeBuffer(BYTES("\xac\x2")), 2));
+  CPPUNIT_ASSERT_EQUAL(uint64_t(0xffffffffffffffffull), read<UInt64>(makeBuffer(BYTES("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x1")), 10));
+  CPPUNIT_ASSERT_EQUAL(int64_t(-2), read<SInt64>(makeBuffer(BYTES("\x3")), 1));
+  CPPUNIT_ASSERT_EQUAL(int64_t(2), read<SInt64>(makeBuffer(BYTES("\x4")), 1));
+
+  CPPUNIT_ASSERT_THROW(read<UInt64>(makeBuffer(BYTES("\xac")), 1), EndOfStreamException);
+  CPPUNIT_ASSERT_THROW(read<UInt64>(makeBuffer(BYTES("\xff\xff\xff\xff\xff\xff\xff\xff\xff\x2")), 10), std::range_error);
+}
+
 #undef BYTES
 
 CPPUNIT_TEST_SUITE_REGISTRATION(IWAReaderTest);
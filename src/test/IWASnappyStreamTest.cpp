@@ -51,15 +51,42 @@ void assertCompressedFull(const string &message, const unsigned char *const expe
   CPPUNIT_ASSERT_EQUAL_MESSAGE(message + ": size", expectedSize, size_t(uncompressedSize));
   CPPUNIT_ASSERT_MESSAGE(message + ": input exhausted", uncompressedStream.isEnd());
   CPPUNIT_ASSERT_MESSAGE(message + ": content", std::equal(expected, expected + expectedSize, uncompressed));
+
+  // the data are shared
+  const libetonyek::IWABufferPtr_t &buffer = uncompressedStream.getBuffer();
+  CPPUNIT_ASSERT_MESSAGE(message + ": buffer", bool(buffer));
+  CPPUNIT_ASSERT_MESSAGE(message + ": buffer content", buffer->data() == uncompressed);
 }
 
-void assertAnyException(const string &message, const unsigned char *const compressed, const size_t compressedSize)
+void assertCompressedOnDemand(const string &message, const unsigned char *const expected, const size_t expectedSize, const unsigned char *const compressed, const size_t compressedSize)
+{
+  const RVNGInputStreamPtr_t stream(new IWORKMemoryStream(compressed, compressedSize));
+  IWASnappyStream uncompressedStream(stream, IWASnappyStream::MODE_ON_DEMAND);
+  CPPUNIT_ASSERT_MESSAGE(message + ": no buffer", !uncompressedStream.getBuffer());
+  // read byte by byte first, then everything at once, to cross chunk boundaries both ways
+  for (size_t i = 0; i < expectedSize; ++i)
+  {
+    unsigned long readBytes = 0;
+    const unsigned char *const byte = uncompressedStream.read(1, readBytes);
+    CPPUNIT_ASSERT_EQUAL_MESSAGE(message + ": single byte", 1ul, readBytes);
+    CPPUNIT_ASSERT_MESSAGE(message + ": single byte content", expected[i] == *byte);
+  }
+  CPPUNIT_ASSERT_MESSAGE(message + ": input exhausted", uncompressedStream.isEnd());
+  CPPUNIT_ASSERT_EQUAL(0, uncompressedStream.seek(0, librevenge::RVNG_SEEK_SET));
+  unsigned long uncompressedSize = 0;
+  const unsigned char *const uncompressed = uncompressedStream.read(expectedSize + 1, uncompressedSize);
+  assert(uncompressed);
+  CPPUNIT_ASSERT_EQUAL_MESSAGE(message + ": size", expectedSize, size_t(uncompressedSize));
+  CPPUNIT_ASSERT_MESSAGE(message + ": content", std::equal(expected, expected + expectedSize, uncompressed));
+}
+
+void assertAnyException(const string &message, const unsigned char *const compressed, const size_t compressedSize, const IWASnappyStream::Mode mode = IWASnappyStream::MODE_WHOLE)
 {
   const RVNGInputStreamPtr_t stream(new IWORKMemoryStream(compressed, compressedSize));
   bool exception = false;
   try
   {
-    IWASnappyStream uncompressedStream(stream);
+    IWASnappyStream uncompressedStream(stream, mode);
   }
   catch (...)
   {
@@ -81,12 +108,14 @@ private:
   CPPUNIT_TEST(testBlock);
   CPPUNIT_TEST(testInvalid);
   CPPUNIT_TEST(testFull);
+  CPPUNIT_TEST(testOnDemand);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testBlock();
   void testInvalid();
   void testFull();
+  void testOnDemand();
 };
 
 void IWASnappyStreamTest::setUp()
@@ -118,6 +147,16 @@ void IWASnappyStreamTest::testBlock()
   assertCompressed("far reference", BYTES("aa"), BYTES("\x2\x0\x61\x2\x1\x0"));
   assertCompressed("far reference of length 2",
                    BYTES("abab"), BYTES("\x4\x4\x61\x62\x6\x2\x0"));
+  assertCompressed("literal run longer than 16 bytes",
+                   BYTES("abcdefghijklmnopqrst"), BYTES("\x14\x4c" "abcdefghijklmnopqrst"));
+  assertCompressed("far reference of length 16",
+                   BYTES("abcdefghijklmnopqrstabcdefghijklmnop"), BYTES("\x24\x4c" "abcdefghijklmnopqrst" "\x3e\x14\x0"));
+  assertCompressed("repeated far reference with offset 1",
+                   BYTES("aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"), BYTES("\x28\x0\x61\x9a\x1\x0"));
+  assertCompressed("repeated near reference with offset 3",
+                   BYTES("abcabcabcabcab"), BYTES("\xe\x8\x61\x62\x63\x1d\x3"));
+  assertCompressed("repeated far reference with offset 10",
+                   BYTES("0123456789012345678901234567890123456789"), BYTES("\x28\x24" "0123456789" "\x76\xa\x0"));
 }
 
 void IWASnappyStreamTest::testInvalid()
@@ -136,6 +175,31 @@ void IWASnappyStreamTest::testFull()
                        ));
 }
 
+void IWASnappyStreamTest::testOnDemand()
+{
+  assertCompressedOnDemand("a single block", BYTES("a"), BYTES("\x0\x3\x0\x0\x1\x0\x61"));
+  assertCompressedOnDemand("three blocks", BYTES("abcdabcdefghij"), BYTES(
+                             "\x0\x8\x0\x0\x8\xc\x61\x62\x63\x64\x1\x4" // block 1
+                             "\x0\x3\x0\x0\x1\x0\x65" // block 2
+                             "\x0\x7\x0\x0\x5\x10\x66\x67\x68\x69\x6a" // block 3
+                           ));
+
+  const RVNGInputStreamPtr_t stream(new IWORKMemoryStream(BYTES(
+                                                            "\x0\x3\x0\x0\x1\x0\x61" // block 1
+                                                            "\x0\x5\x0\x0\x3\x8\x62\x63\x64" // block 2
+                                                          )));
+  IWASnappyStream uncompressedStream(stream, IWASnappyStream::MODE_ON_DEMAND);
+  CPPUNIT_ASSERT_EQUAL(0, uncompressedStream.seek(0, librevenge::RVNG_SEEK_END));
+  CPPUNIT_ASSERT_EQUAL(4l, uncompressedStream.tell());
+  CPPUNIT_ASSERT_EQUAL(0, uncompressedStream.seek(2, librevenge::RVNG_SEEK_SET));
+  unsigned long readBytes = 0;
+  const unsigned char *const bytes = uncompressedStream.read(1, readBytes);
+  CPPUNIT_ASSERT_EQUAL(1ul, readBytes);
+  CPPUNIT_ASSERT_EQUAL('c', char(*bytes));
+
+  assertAnyException("Truncated block header", BYTES("\x0\x3\x0\x0\x1\x0\x61\x0\x3"), IWASnappyStream::MODE_ON_DEMAND);
+}
+
 #undef BYTES
 
 CPPUNIT_TEST_SUITE_REGISTRATION(IWASnappyStreamTest);
@@ -0,0 +1,146 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWORKCollector.h"
+#include "IWORKMediaCache.h"
+#include "IWORKMemoryStream.h"
+#include "IWORKTypes.h"
+
+using namespace libetonyek;
+
+using std::string;
+
+namespace test
+{
+
+namespace
+{
+
+/// A collector that only records the inserted media.
+class MediaCollector : public IWORKCollector
+{
+public:
+  MediaCollector()
+    : IWORKCollector(nullptr)
+    , m_media()
+  {
+  }
+
+  std::vector<librevenge::RVNGPropertyList> m_media;
+
+private:
+  void drawTable() override
+  {
+  }
+  void drawMedia(double, double, const librevenge::RVNGPropertyList &data) override
+  {
+    m_media.push_back(data);
+  }
+  void fillShapeProperties(librevenge::RVNGPropertyList &) override
+  {
+  }
+  bool createFrameStylesForTextBox() const override
+  {
+    return false;
+  }
+  void drawTextBox(const IWORKTextPtr_t &, const glm::dmat3 &, const IWORKGeometryPtr_t &, const librevenge::RVNGPropertyList &) override
+  {
+  }
+};
+
+IWORKMediaContentPtr_t makeImage(const RVNGInputStreamPtr_t &stream, const string &path)
+{
+  const IWORKMediaContentPtr_t content = std::make_shared<IWORKMediaContent>();
+  content->m_data = std::make_shared<IWORKData>();
+  content->m_data->m_stream = stream;
+  content->m_data->m_path = path;
+  content->m_data->m_mimeType = "image/png";
+  return content;
+}
+
+void collectImage(MediaCollector &collector, const IWORKMediaContentPtr_t &content)
+{
+  const IWORKGeometryPtr_t geometry = std::make_shared<IWORKGeometry>();
+  geometry->m_size = IWORKSize(10, 10);
+  collector.startLevel();
+  collector.collectGeometry(geometry);
+  collector.collectMedia(content);
+  collector.endLevel();
+}
+
+}
+
+class IWORKCollectorTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWORKCollectorTest);
+  CPPUNIT_TEST(testMedia);
+  CPPUNIT_TEST(testMissingMedia);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testMedia();
+  void testMissingMedia();
+};
+
+void IWORKCollectorTest::setUp()
+{
+}
+
+void IWORKCollectorTest::tearDown()
+{
+}
+
+void IWORKCollectorTest::testMedia()
+{
+  const unsigned char bytes[] = "picture";
+  const RVNGInputStreamPtr_t stream(new IWORKMemoryStream(bytes, 7));
+
+  MediaCollector collector;
+  collectImage(collector, makeImage(stream, "Data/picture.png"));
+  CPPUNIT_ASSERT_EQUAL(std::size_t(1), collector.m_media.size());
+  CPPUNIT_ASSERT(collector.m_media[0]["office:binary-data"]);
+
+  collector.getMediaCache()->setReferences(true);
+  collectImage(collector, makeImage(stream, "Data/picture.png"));
+  CPPUNIT_ASSERT_EQUAL(std::size_t(2), collector.m_media.size());
+  CPPUNIT_ASSERT(!collector.m_media[1]["office:binary-data"]);
+  CPPUNIT_ASSERT(collector.m_media[1]["xlink:href"]);
+}
+
+void IWORKCollectorTest::testMissingMedia()
+{
+  MediaCollector collector;
+
+  // a path is not enough without references: the media is skipped
+  collectImage(collector, makeImage(RVNGInputStreamPtr_t(), "Data/missing.png"));
+  CPPUNIT_ASSERT(collector.m_media.empty());
+
+  // the next media are still drawn
+  const unsigned char bytes[] = "picture";
+  collectImage(collector, makeImage(RVNGInputStreamPtr_t(new IWORKMemoryStream(bytes, 7)), string()));
+  CPPUNIT_ASSERT_EQUAL(std::size_t(1), collector.m_media.size());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWORKCollectorTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
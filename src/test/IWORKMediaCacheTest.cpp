@@ -0,0 +1,203 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <string>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWORKMediaCache.h"
+#include "IWORKMemoryStream.h"
+#include "IWORKTypes.h"
+
+using librevenge::RVNGBinaryData;
+using librevenge::RVNGPropertyList;
+
+using libetonyek::IWORKData;
+using libetonyek::IWORKMediaCache;
+using libetonyek::IWORKMemoryStream;
+using libetonyek::RVNGInputStreamPtr_t;
+
+using std::string;
+
+namespace test
+{
+
+namespace
+{
+
+RVNGInputStreamPtr_t makeStream(const char *const data)
+{
+  return RVNGInputStreamPtr_t(new IWORKMemoryStream(reinterpret_cast<const unsigned char *>(data), unsigned(string(data).size())));
+}
+
+}
+
+class IWORKMediaCacheTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWORKMediaCacheTest);
+  CPPUNIT_TEST(testContent);
+  CPPUNIT_TEST(testSharing);
+  CPPUNIT_TEST(testReferences);
+  CPPUNIT_TEST(testRelease);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testContent();
+  void testSharing();
+  void testReferences();
+  void testRelease();
+};
+
+void IWORKMediaCacheTest::setUp()
+{
+}
+
+void IWORKMediaCacheTest::tearDown()
+{
+}
+
+void IWORKMediaCacheTest::testContent()
+{
+  IWORKMediaCache cache;
+  RVNGBinaryData data;
+  string id;
+
+  CPPUNIT_ASSERT(!cache.get(RVNGInputStreamPtr_t(), data, id));
+
+  CPPUNIT_ASSERT(cache.get(makeStream("picture"), data, id));
+  CPPUNIT_ASSERT_EQUAL(7ul, data.size());
+  CPPUNIT_ASSERT(string(reinterpret_cast<const char *>(data.getDataBuffer()), data.size()) == "picture");
+  CPPUNIT_ASSERT(!id.empty());
+
+  // the ID only depends on the content
+  IWORKMediaCache other;
+  RVNGBinaryData otherData;
+  string otherId;
+  CPPUNIT_ASSERT(other.get(makeStream("picture"), otherData, otherId));
+  CPPUNIT_ASSERT_EQUAL(id, otherId);
+}
+
+void IWORKMediaCacheTest::testSharing()
+{
+  IWORKMediaCache cache;
+  const RVNGInputStreamPtr_t stream = makeStream("picture");
+
+  RVNGBinaryData data1;
+  string id1;
+  CPPUNIT_ASSERT(cache.get(stream, data1, id1));
+
+  // the same stream again
+  RVNGBinaryData data2;
+  string id2;
+  CPPUNIT_ASSERT(cache.get(stream, data2, id2));
+  CPPUNIT_ASSERT_EQUAL(id1, id2);
+  CPPUNIT_ASSERT(data1.getDataBuffer() == data2.getDataBuffer());
+
+  // another stream with the same content
+  RVNGBinaryData data3;
+  string id3;
+  CPPUNIT_ASSERT(cache.get(makeStream("picture"), data3, id3));
+  CPPUNIT_ASSERT_EQUAL(id1, id3);
+  CPPUNIT_ASSERT(data1.getDataBuffer() == data3.getDataBuffer());
+  CPPUNIT_ASSERT_EQUAL(std::size_t(1), cache.size());
+
+  // a different content
+  RVNGBinaryData data4;
+  string id4;
+  CPPUNIT_ASSERT(cache.get(makeStream("drawing"), data4, id4));
+  CPPUNIT_ASSERT(id1 != id4);
+  CPPUNIT_ASSERT(data1.getDataBuffer() != data4.getDataBuffer());
+  CPPUNIT_ASSERT_EQUAL(std::size_t(2), cache.size());
+}
+
+void IWORKMediaCacheTest::testReferences()
+{
+  IWORKMediaCache cache;
+  IWORKData data;
+  data.m_stream = makeStream("picture");
+  data.m_path = "Data/picture.png";
+
+  RVNGPropertyList props;
+  CPPUNIT_ASSERT(cache.insert(data, "office:binary-data", props));
+  CPPUNIT_ASSERT(props["office:binary-data"]);
+  CPPUNIT_ASSERT(props["librevenge:media-id"]);
+  CPPUNIT_ASSERT(!props["xlink:href"]);
+
+  cache.setReferences(true);
+  RVNGPropertyList refProps;
+  CPPUNIT_ASSERT(cache.insert(data, "office:binary-data", refProps));
+  CPPUNIT_ASSERT(!refProps["office:binary-data"]);
+  CPPUNIT_ASSERT(refProps["xlink:href"]);
+  CPPUNIT_ASSERT_EQUAL(string("Data/picture.png"), string(refProps["xlink:href"]->getStr().cstr()));
+
+  // without a path, the content is still needed
+  data.m_path.clear();
+  RVNGPropertyList dataProps;
+  CPPUNIT_ASSERT(cache.insert(data, "office:binary-data", dataProps));
+  CPPUNIT_ASSERT(dataProps["office:binary-data"]);
+
+  data.m_stream.reset();
+  RVNGPropertyList noProps;
+  CPPUNIT_ASSERT(!cache.insert(data, "office:binary-data", noProps));
+}
+
+void IWORKMediaCacheTest::testRelease()
+{
+  IWORKMediaCache cache;
+  cache.setMaxRetainedSize(10);
+  const RVNGInputStreamPtr_t stream = makeStream("picture");
+
+  RVNGBinaryData data1;
+  string id1;
+  CPPUNIT_ASSERT(cache.get(stream, data1, id1));
+  CPPUNIT_ASSERT_EQUAL(std::size_t(7), cache.getRetainedSize());
+
+  // the least recently used content is released
+  RVNGBinaryData data2;
+  string id2;
+  CPPUNIT_ASSERT(cache.get(makeStream("drawing"), data2, id2));
+  CPPUNIT_ASSERT_EQUAL(std::size_t(7), cache.getRetainedSize());
+  CPPUNIT_ASSERT_EQUAL(std::size_t(2), cache.size());
+
+  // the copy outside of the cache is still valid
+  CPPUNIT_ASSERT(string(reinterpret_cast<const char *>(data1.getDataBuffer()), data1.size()) == "picture");
+
+  // the released content is read again and keeps its ID
+  RVNGBinaryData data3;
+  string id3;
+  CPPUNIT_ASSERT(cache.get(stream, data3, id3));
+  CPPUNIT_ASSERT_EQUAL(id1, id3);
+  CPPUNIT_ASSERT(string(reinterpret_cast<const char *>(data3.getDataBuffer()), data3.size()) == "picture");
+  CPPUNIT_ASSERT_EQUAL(std::size_t(7), cache.getRetainedSize());
+
+  RVNGBinaryData data4;
+  string id4;
+  CPPUNIT_ASSERT(cache.get(makeStream("drawing"), data4, id4));
+  CPPUNIT_ASSERT_EQUAL(id2, id4);
+  CPPUNIT_ASSERT_EQUAL(std::size_t(2), cache.size());
+
+  // a content bigger than the limit is retained until the next one
+  RVNGBinaryData data5;
+  string id5;
+  CPPUNIT_ASSERT(cache.get(makeStream("a big picture"), data5, id5));
+  CPPUNIT_ASSERT_EQUAL(std::size_t(13), cache.getRetainedSize());
+  CPPUNIT_ASSERT_EQUAL(std::size_t(3), cache.size());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWORKMediaCacheTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,227 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cstring>
+#include <memory>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWORKCollector.h"
+#include "IWORKDictionary.h"
+#include "IWORKDiscardContext.h"
+#include "IWORKMemoryStream.h"
+#include "IWORKParser.h"
+#include "IWORKStyle.h"
+#include "IWORKToken.h"
+#include "IWORKXMLContextBase.h"
+#include "IWORKXMLParserState.h"
+
+using namespace libetonyek;
+
+namespace test
+{
+
+namespace
+{
+
+/// A collector that ignores everything.
+class NullCollector : public IWORKCollector
+{
+public:
+  NullCollector()
+    : IWORKCollector(nullptr)
+  {
+  }
+
+private:
+  void drawTable() override
+  {
+  }
+  void drawMedia(double, double, const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void fillShapeProperties(librevenge::RVNGPropertyList &) override
+  {
+  }
+  bool createFrameStylesForTextBox() const override
+  {
+    return false;
+  }
+  void drawTextBox(const IWORKTextPtr_t &, const glm::dmat3 &, const IWORKGeometryPtr_t &, const librevenge::RVNGPropertyList &) override
+  {
+  }
+};
+
+/// Resolve a reference to a paragraph style.
+class StyleRefElement : public IWORKXMLEmptyContextBase
+{
+public:
+  StyleRefElement(IWORKXMLParserState &state, IWORKStylePtr_t &style)
+    : IWORKXMLEmptyContextBase(state)
+    , m_style(style)
+  {
+  }
+
+private:
+  void endOfElement() override
+  {
+    if (!getRef())
+      return;
+    const IWORKStyleMap_t::const_iterator it = getState().getDictionary().m_paragraphStyles.find(get(getRef()));
+    if (it != getState().getDictionary().m_paragraphStyles.end())
+      m_style = it->second;
+  }
+
+private:
+  IWORKStylePtr_t &m_style;
+};
+
+/// The only handled content of sf:section is sf:paragraphstyle-ref; everything else is discarded.
+class SectionElement : public IWORKXMLElementContextBase
+{
+public:
+  SectionElement(IWORKXMLParserState &state, IWORKStylePtr_t &style)
+    : IWORKXMLElementContextBase(state)
+    , m_style(style)
+  {
+  }
+
+private:
+  IWORKXMLContextPtr_t element(const int name) override
+  {
+    if (name == (IWORKToken::NS_URI_SF | IWORKToken::paragraphstyle_ref))
+      return std::make_shared<StyleRefElement>(getState(), m_style);
+    return IWORKXMLContextPtr_t();
+  }
+
+private:
+  IWORKStylePtr_t &m_style;
+};
+
+class XMLDocument : public IWORKXMLElementContextBase
+{
+public:
+  XMLDocument(IWORKXMLParserState &state, IWORKStylePtr_t &style)
+    : IWORKXMLElementContextBase(state)
+    , m_style(style)
+  {
+  }
+
+private:
+  IWORKXMLContextPtr_t element(const int name) override
+  {
+    if (name == (IWORKToken::NS_URI_SF | IWORKToken::section))
+      return std::make_shared<SectionElement>(getState(), m_style);
+    return IWORKXMLContextPtr_t();
+  }
+
+private:
+  IWORKStylePtr_t &m_style;
+};
+
+class TestParser : public IWORKParser
+{
+public:
+  TestParser(const RVNGInputStreamPtr_t &input, IWORKCollector &collector, IWORKDictionary &dict)
+    : IWORKParser(input, RVNGInputStreamPtr_t())
+    , m_style()
+    , m_state(*this, collector, dict)
+  {
+  }
+
+  const IWORKTokenizer &getTokenizer() const override
+  {
+    return IWORKToken::getTokenizer();
+  }
+
+  IWORKStylePtr_t m_style; //!< the style resolved by sf:paragraphstyle-ref
+
+private:
+  IWORKXMLContextPtr_t createDocumentContext() override
+  {
+    return std::make_shared<XMLDocument>(m_state, m_style);
+  }
+  IWORKXMLContextPtr_t createDiscardContext() override
+  {
+    return std::make_shared<IWORKDiscardContext>(m_state);
+  }
+
+private:
+  IWORKXMLParserState m_state;
+};
+
+RVNGInputStreamPtr_t makeStream(const char *const xml)
+{
+  return std::make_shared<IWORKMemoryStream>(reinterpret_cast<const unsigned char *>(xml), unsigned(std::strlen(xml)));
+}
+
+}
+
+class IWORKParserTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWORKParserTest);
+  CPPUNIT_TEST(testDiscardedDefinitions);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testDiscardedDefinitions();
+};
+
+void IWORKParserTest::setUp()
+{
+}
+
+void IWORKParserTest::tearDown()
+{
+}
+
+void IWORKParserTest::testDiscardedDefinitions()
+{
+  // sf:drawables is discarded. The elements on the way to the
+  // definitions have no ID, and sf:listLabelIndents registers the
+  // array inside it, although it has no ID itself.
+  const char xml[] =
+    "<sf:section xmlns:sf=\"http://developer.apple.com/namespaces/sf\" xmlns:sfa=\"http://developer.apple.com/namespaces/sfa\">"
+    "<sf:drawables>"
+    "<sf:stylesheet><sf:styles>"
+    "<sf:paragraphstyle sfa:ID=\"paragraphstyle-1\" sf:ident=\"body\"><sf:property-map/></sf:paragraphstyle>"
+    "</sf:styles></sf:stylesheet>"
+    "<sf:text>ignored</sf:text>"
+    "<sf:property-map><sf:listLabelIndents>"
+    "<sf:mutable-array sfa:ID=\"indents-1\"><sf:number sfa:number=\"18\" sfa:type=\"f\"/></sf:mutable-array>"
+    "</sf:listLabelIndents></sf:property-map>"
+    "</sf:drawables>"
+    "<sf:paragraphstyle-ref sfa:IDREF=\"paragraphstyle-1\"/>"
+    "</sf:section>";
+
+  NullCollector collector;
+  IWORKDictionary dict;
+  TestParser parser(makeStream(xml), collector, dict);
+  CPPUNIT_ASSERT(parser.parse());
+
+  CPPUNIT_ASSERT(bool(parser.m_style));
+  CPPUNIT_ASSERT(dict.m_paragraphStyles["paragraphstyle-1"] == parser.m_style);
+
+  const auto it = dict.m_doubleArrays.find("indents-1");
+  CPPUNIT_ASSERT(it != dict.m_doubleArrays.end());
+  CPPUNIT_ASSERT_EQUAL(std::size_t(1), it->second.size());
+  CPPUNIT_ASSERT_EQUAL(18.0, it->second[0]);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWORKParserTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,138 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "IWORKPipeStream.h"
+#include "IWORKZlibStream.h"
+#include "libetonyek_utils.h"
+
+#if !defined ETONYEK_STREAMS_TEST_DIR
+#error ETONYEK_STREAMS_TEST_DIR not defined, cannot test
+#endif
+
+namespace test
+{
+
+using libetonyek::IWORKPipeStream;
+using libetonyek::IWORKZlibStream;
+using libetonyek::RVNGInputStreamPtr_t;
+
+using std::string;
+using std::vector;
+
+namespace
+{
+
+RVNGInputStreamPtr_t openFile(const string &name)
+{
+  return RVNGInputStreamPtr_t(new librevenge::RVNGFileStream((string(ETONYEK_STREAMS_TEST_DIR) + "/" + name).c_str()));
+}
+
+vector<unsigned char> readAll(librevenge::RVNGInputStream &stream, const unsigned long blockSize)
+{
+  vector<unsigned char> data;
+  while (!stream.isEnd())
+  {
+    unsigned long numBytesRead = 0;
+    const unsigned char *const bytes = stream.read(blockSize, numBytesRead);
+    if (numBytesRead == 0)
+      break;
+    data.insert(data.end(), bytes, bytes + numBytesRead);
+  }
+  return data;
+}
+
+void assertSame(const string &name)
+{
+  IWORKZlibStream whole(openFile(name), IWORKZlibStream::MODE_WHOLE);
+  const vector<unsigned char> expected(readAll(whole, 1 << 20));
+  CPPUNIT_ASSERT_MESSAGE(name + ": not empty", !expected.empty());
+
+  IWORKPipeStream pipe(std::make_shared<IWORKZlibStream>(openFile(name), IWORKZlibStream::MODE_STREAMING));
+
+  // small reads, like the XML parser does
+  CPPUNIT_ASSERT_MESSAGE(name + ": content", expected == readAll(pipe, 4000));
+  CPPUNIT_ASSERT_EQUAL_MESSAGE(name + ": length", long(expected.size()), pipe.tell());
+
+  // reads spanning more buffers
+  CPPUNIT_ASSERT_EQUAL(0, pipe.seek(0, librevenge::RVNG_SEEK_SET));
+  CPPUNIT_ASSERT_EQUAL(0l, pipe.tell());
+  CPPUNIT_ASSERT_MESSAGE(name + ": big reads", expected == readAll(pipe, 200000));
+
+  // jump around
+  const long middle = long(expected.size() / 2);
+  CPPUNIT_ASSERT_EQUAL(0, pipe.seek(middle, librevenge::RVNG_SEEK_SET));
+  unsigned long numBytesRead = 0;
+  const unsigned char *bytes = pipe.read(10, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(10ul, numBytesRead);
+  CPPUNIT_ASSERT_MESSAGE(name + ": middle", std::equal(bytes, bytes + 10, expected.begin() + middle));
+
+  // back in the same buffer
+  CPPUNIT_ASSERT_EQUAL(0, pipe.seek(-5, librevenge::RVNG_SEEK_CUR));
+  CPPUNIT_ASSERT_EQUAL(middle + 5, pipe.tell());
+  bytes = pipe.read(1, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(1ul, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(expected[std::size_t(middle + 5)], *bytes);
+
+  CPPUNIT_ASSERT_EQUAL(0, pipe.seek(-1, librevenge::RVNG_SEEK_END));
+  CPPUNIT_ASSERT_EQUAL(long(expected.size()) - 1, pipe.tell());
+  bytes = pipe.read(10, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(1ul, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(expected.back(), *bytes);
+  CPPUNIT_ASSERT(pipe.isEnd());
+  bytes = pipe.read(10, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(0ul, numBytesRead);
+}
+
+}
+
+class IWORKPipeStreamTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWORKPipeStreamTest);
+  CPPUNIT_TEST(testRead);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testRead();
+};
+
+void IWORKPipeStreamTest::setUp()
+{
+}
+
+void IWORKPipeStreamTest::tearDown()
+{
+}
+
+void IWORKPipeStreamTest::testRead()
+{
+  assertSame("keynote4.apxl.gz");
+  assertSame("numbers2.xml.gz");
+  assertSame("pages4.xml.gz");
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWORKPipeStreamTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
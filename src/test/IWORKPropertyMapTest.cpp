@@ -10,6 +10,9 @@
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
 
+#include <string>
+
+#include "IWORKProperties.h"
 #include "IWORKPropertyInfo.h"
 #include "IWORKPropertyMap.h"
 
@@ -20,6 +23,9 @@ namespace test
 
 using libetonyek::property::Answer;
 using libetonyek::property::Antwort;
+using libetonyek::property::Bold;
+using libetonyek::property::FontName;
+using libetonyek::property::FontSize;
 using libetonyek::IWORKPropertyInfo;
 using libetonyek::IWORKPropertyMap;
 
@@ -33,11 +39,15 @@ private:
   CPPUNIT_TEST_SUITE(IWORKPropertyMapTest);
   CPPUNIT_TEST(testLookup);
   CPPUNIT_TEST(testLookupWithParent);
+  CPPUNIT_TEST(testCopy);
+  CPPUNIT_TEST(testManyProperties);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testLookup();
   void testLookupWithParent();
+  void testCopy();
+  void testManyProperties();
 };
 
 void IWORKPropertyMapTest::setUp()
@@ -135,6 +145,82 @@ void IWORKPropertyMapTest::testLookupWithParent()
   }
 }
 
+void IWORKPropertyMapTest::testCopy()
+{
+  IWORKPropertyMap parent;
+  parent.put<Antwort>(17);
+
+  IWORKPropertyMap props(&parent);
+  props.put<Answer>(42);
+
+  // a copy sees the same values and the same parent
+  IWORKPropertyMap copy(props);
+  CPPUNIT_ASSERT_EQUAL(42, copy.get<Answer>());
+  CPPUNIT_ASSERT_EQUAL(17, copy.get<Antwort>(true));
+
+  // changing the copy does not change the original
+  copy.put<Answer>(3);
+  copy.put<Antwort>(4);
+  CPPUNIT_ASSERT_EQUAL(3, copy.get<Answer>());
+  CPPUNIT_ASSERT_EQUAL(4, copy.get<Antwort>());
+  CPPUNIT_ASSERT_EQUAL(42, props.get<Answer>());
+  CPPUNIT_ASSERT(!props.has<Antwort>());
+
+  // neither does clearing a value in the copy
+  copy = props;
+  copy.clear<Answer>();
+  CPPUNIT_ASSERT(copy.clears<Answer>());
+  CPPUNIT_ASSERT(!copy.has<Answer>());
+  CPPUNIT_ASSERT(!props.clears<Answer>());
+  CPPUNIT_ASSERT_EQUAL(42, props.get<Answer>());
+
+  // and changing the original does not change the copy
+  props.put<Antwort>(5);
+  CPPUNIT_ASSERT(!copy.has<Antwort>());
+  CPPUNIT_ASSERT_EQUAL(17, copy.get<Antwort>(true));
+
+  // a value cleared in the map hides the value of the parent
+  props.clear<Antwort>();
+  CPPUNIT_ASSERT(props.clears<Antwort>(true));
+  CPPUNIT_ASSERT(!props.has<Antwort>(true));
+  CPPUNIT_ASSERT_THROW(props.get<Antwort>(true), IWORKPropertyMap::NotFoundException);
+
+  // a value put again is not cleared anymore
+  props.put<Antwort>(6);
+  CPPUNIT_ASSERT(!props.clears<Antwort>());
+  CPPUNIT_ASSERT_EQUAL(6, props.get<Antwort>());
+}
+
+void IWORKPropertyMapTest::testManyProperties()
+{
+  // the IDs are dense and fixed at compile time
+  static_assert(IWORKPropertyInfo<FontName>::id < libetonyek::IWORK_PROPERTY_COUNT, "not a listed property");
+  static_assert(IWORKPropertyInfo<FontSize>::id != IWORKPropertyInfo<FontName>::id, "duplicate ID");
+
+  // values of properties put in any order are kept apart
+  IWORKPropertyMap props;
+  props.put<Antwort>(2);
+  props.put<FontSize>(12.0);
+  props.put<Answer>(1);
+  props.put<FontName>("Helvetica");
+  props.put<Bold>(true);
+  CPPUNIT_ASSERT_EQUAL(1, props.get<Answer>());
+  CPPUNIT_ASSERT_EQUAL(2, props.get<Antwort>());
+  CPPUNIT_ASSERT_EQUAL(12.0, props.get<FontSize>());
+  CPPUNIT_ASSERT_EQUAL(std::string("Helvetica"), props.get<FontName>());
+  CPPUNIT_ASSERT(props.get<Bold>());
+
+  // and so are they after some are removed or replaced
+  props.clear<FontSize>();
+  props.put<Answer>(3);
+  props.clear<Bold>();
+  CPPUNIT_ASSERT_EQUAL(3, props.get<Answer>());
+  CPPUNIT_ASSERT_EQUAL(2, props.get<Antwort>());
+  CPPUNIT_ASSERT(!props.has<FontSize>());
+  CPPUNIT_ASSERT(props.clears<Bold>());
+  CPPUNIT_ASSERT_EQUAL(std::string("Helvetica"), props.get<FontName>());
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(IWORKPropertyMapTest);
 
 }
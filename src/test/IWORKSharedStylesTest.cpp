@@ -0,0 +1,103 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWORKSharedStyles.h"
+
+using librevenge::RVNGPropertyList;
+
+using libetonyek::IWORKSharedStyles;
+
+namespace test
+{
+
+namespace
+{
+
+int getID(const RVNGPropertyList &propList)
+{
+  CPPUNIT_ASSERT(propList["librevenge:span-id"]);
+  return propList["librevenge:span-id"]->getInt();
+}
+
+}
+
+class IWORKSharedStylesTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWORKSharedStylesTest);
+  CPPUNIT_TEST(testShare);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testShare();
+};
+
+void IWORKSharedStylesTest::setUp()
+{
+}
+
+void IWORKSharedStylesTest::tearDown()
+{
+}
+
+void IWORKSharedStylesTest::testShare()
+{
+  IWORKSharedStyles styles("librevenge:span-id");
+
+  RVNGPropertyList bold;
+  bold.insert("fo:font-weight", "bold");
+  RVNGPropertyList italic;
+  italic.insert("fo:font-style", "italic");
+
+  // a new style must be defined
+  RVNGPropertyList definition;
+  const RVNGPropertyList boldRef = styles.share(bold, definition);
+  CPPUNIT_ASSERT(!definition.empty());
+  CPPUNIT_ASSERT(definition["fo:font-weight"]);
+  CPPUNIT_ASSERT_EQUAL(getID(boldRef), getID(definition));
+  CPPUNIT_ASSERT(!boldRef["fo:font-weight"]);
+
+  // a different style gets a different ID
+  definition.clear();
+  const RVNGPropertyList italicRef = styles.share(italic, definition);
+  CPPUNIT_ASSERT(!definition.empty());
+  CPPUNIT_ASSERT(getID(boldRef) != getID(italicRef));
+
+  // a known style is just referred to
+  definition.clear();
+  RVNGPropertyList bold2;
+  bold2.insert("fo:font-weight", "bold");
+  CPPUNIT_ASSERT_EQUAL(getID(boldRef), getID(styles.share(bold2, definition)));
+  CPPUNIT_ASSERT(definition.empty());
+
+  // a style with more properties is different
+  bold2.insert("fo:font-style", "italic");
+  const RVNGPropertyList bothRef = styles.share(bold2, definition);
+  CPPUNIT_ASSERT(!definition.empty());
+  CPPUNIT_ASSERT(getID(boldRef) != getID(bothRef));
+  CPPUNIT_ASSERT(getID(italicRef) != getID(bothRef));
+
+  // an empty style is not shared
+  definition.clear();
+  CPPUNIT_ASSERT(styles.share(RVNGPropertyList(), definition).empty());
+  CPPUNIT_ASSERT(definition.empty());
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWORKSharedStylesTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
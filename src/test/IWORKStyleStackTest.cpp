@@ -18,7 +18,6 @@
 namespace test
 {
 
-using boost::any_cast;
 using boost::optional;
 
 using libetonyek::property::Answer;
@@ -51,10 +50,12 @@ public:
 private:
   CPPUNIT_TEST_SUITE(IWORKStyleStackTest);
   CPPUNIT_TEST(testLookup);
+  CPPUNIT_TEST(testLookupAfterChange);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testLookup();
+  void testLookupAfterChange();
 };
 
 void IWORKStyleStackTest::setUp()
@@ -122,6 +123,36 @@ void IWORKStyleStackTest::testLookup()
   CPPUNIT_ASSERT(!context.has<Answer>());
 }
 
+void IWORKStyleStackTest::testLookupAfterChange()
+{
+  IWORKStyleStack context;
+
+  IWORKPropertyMap props;
+  props.put<Answer>(42);
+  const IWORKStylePtr_t style = makeStyle(props);
+  const IWORKStylePtr_t top = makeStyle(IWORKPropertyMap());
+
+  context.push();
+  context.set(style);
+  context.push();
+  context.set(top);
+  CPPUNIT_ASSERT_EQUAL(42, context.get<Answer>());
+
+  // a change of a style in the stack is visible
+  style->put<Answer>(3);
+  CPPUNIT_ASSERT_EQUAL(3, context.get<Answer>());
+
+  top->put<Answer>(1);
+  CPPUNIT_ASSERT_EQUAL(1, context.get<Answer>());
+
+  top->clear<Answer>();
+  CPPUNIT_ASSERT(!context.has<Answer>());
+
+  // and so is a change of the top of the stack
+  context.set(makeStyle(IWORKPropertyMap()));
+  CPPUNIT_ASSERT_EQUAL(3, context.get<Answer>());
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(IWORKStyleStackTest);
 
 }
@@ -71,12 +71,16 @@ private:
   CPPUNIT_TEST(testLink);
   CPPUNIT_TEST(testFlatten);
   CPPUNIT_TEST(testLookup);
+  CPPUNIT_TEST(testLookupAfterChange);
+  CPPUNIT_TEST(testChangeOfAncestor);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testLink();
   void testFlatten();
   void testLookup();
+  void testLookupAfterChange();
+  void testChangeOfAncestor();
 };
 
 void IWORKStyleTest::setUp()
@@ -183,6 +187,72 @@ void IWORKStyleTest::testLookup()
   CPPUNIT_ASSERT_EQUAL(42, style.get<Answer>());
 }
 
+void IWORKStyleTest::testLookupAfterChange()
+{
+  optional<ID_t> dummyIdent;
+
+  IWORKPropertyMap props;
+  props.put<Answer>(42);
+  const IWORKStylePtr_t parent = makeStyle(props);
+
+  IWORKStyle style(IWORKPropertyMap(), dummyIdent, parent);
+  CPPUNIT_ASSERT_EQUAL(42, style.get<Answer>());
+  CPPUNIT_ASSERT(!style.has<Antwort>());
+
+  // a change of the parent is visible in the child
+  parent->put<Answer>(3);
+  parent->put<Antwort>(17);
+  CPPUNIT_ASSERT_EQUAL(3, style.get<Answer>());
+  CPPUNIT_ASSERT(style.has<Antwort>());
+  CPPUNIT_ASSERT_EQUAL(17, style.get<Antwort>());
+
+  // a cleared value hides the parent's value
+  style.clear<Answer>();
+  CPPUNIT_ASSERT(!style.has<Answer>());
+  CPPUNIT_ASSERT_THROW(style.get<Answer>(), IWORKPropertyMap::NotFoundException);
+
+  // so does a change of the parent
+  style.setParent(makeStyle(IWORKPropertyMap()));
+  CPPUNIT_ASSERT(!style.has<Antwort>());
+}
+
+void IWORKStyleTest::testChangeOfAncestor()
+{
+  optional<ID_t> dummyIdent;
+
+  IWORKPropertyMap props;
+  props.put<Answer>(42);
+  const IWORKStylePtr_t grandparent = makeStyle(props);
+  const IWORKStylePtr_t other = makeStyle(props);
+  const IWORKStylePtr_t parent(new IWORKStyle(IWORKPropertyMap(), dummyIdent, grandparent));
+
+  IWORKStyle style(IWORKPropertyMap(), dummyIdent, parent);
+  CPPUNIT_ASSERT_EQUAL(42, style.get<Answer>());
+
+  // a change of an unrelated style is not seen
+  other->put<Answer>(3);
+  CPPUNIT_ASSERT_EQUAL(42, style.get<Answer>());
+
+  // a change of any ancestor is
+  grandparent->put<Answer>(3);
+  CPPUNIT_ASSERT_EQUAL(3, style.get<Answer>());
+
+  {
+    // the styles gone from the parent do not get changes
+    IWORKStyle sibling(IWORKPropertyMap(), dummyIdent, parent);
+    CPPUNIT_ASSERT_EQUAL(3, sibling.get<Answer>());
+  }
+  grandparent->clear<Answer>();
+  CPPUNIT_ASSERT(!style.has<Answer>());
+
+  // nor do the styles moved to another parent
+  style.setParent(other);
+  grandparent->put<Answer>(1);
+  CPPUNIT_ASSERT_EQUAL(3, style.get<Answer>());
+  other->put<Answer>(2);
+  CPPUNIT_ASSERT_EQUAL(2, style.get<Answer>());
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(IWORKStyleTest);
 
 }
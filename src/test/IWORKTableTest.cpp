@@ -0,0 +1,233 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWORKFormula.h"
+#include "IWORKLanguageManager.h"
+#include "IWORKOutputElements.h"
+#include "IWORKTable.h"
+#include "TestDocument.h"
+
+using namespace libetonyek;
+
+using std::string;
+using std::vector;
+
+namespace test
+{
+
+class IWORKTableTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  IWORKTableTest();
+
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWORKTableTest);
+  CPPUNIT_TEST(testNames);
+  CPPUNIT_TEST(testNamesOnWrite);
+  CPPUNIT_TEST(testForwardReference);
+  CPPUNIT_TEST(testReinsertCell);
+  CPPUNIT_TEST(testStreamedValues);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testNames();
+  void testNamesOnWrite();
+  void testForwardReference();
+  void testReinsertCell();
+  void testStreamedValues();
+
+  void drawSlide(unsigned slide, const IWORKTableNameMapPtr_t &names, bool nameOnWrite, IWORKOutputElements &elements);
+
+private:
+  IWORKFormatNameMap m_formatNameMap;
+  IWORKLanguageManager m_langManager;
+};
+
+IWORKTableTest::IWORKTableTest()
+  : m_formatNameMap()
+  , m_langManager()
+{
+}
+
+void IWORKTableTest::setUp()
+{
+  m_formatNameMap.clear();
+}
+
+void IWORKTableTest::tearDown()
+{
+}
+
+void IWORKTableTest::testNames()
+{
+  IWORKTableNameMap_t names;
+  CPPUNIT_ASSERT_EQUAL(string("Table 1"), IWORKTable::registerName(names, "Table 1", string("a")));
+  CPPUNIT_ASSERT_EQUAL(string("Table 1_1"), IWORKTable::registerName(names, "Table 1", string("b")));
+  CPPUNIT_ASSERT_EQUAL(string("Table 1_2"), IWORKTable::registerName(names, "Table 1", boost::none));
+  CPPUNIT_ASSERT_EQUAL(string("Table 1"), names["SFTGlobalID_a"]);
+  CPPUNIT_ASSERT_EQUAL(string("Table 1_1"), names["SFTGlobalID_b"]);
+}
+
+void IWORKTableTest::testNamesOnWrite()
+{
+  // the names given when the tables are parsed one by one
+  IWORKTableNameMap_t sequentialNames;
+  IWORKTable::registerName(sequentialNames, "Table 1", string("first"));
+  IWORKTable::registerName(sequentialNames, "Table 1", string("second"));
+  IWORKTable::registerName(sequentialNames, "Table 2", string("third"));
+
+  // the tables of three slides, parsed in another order
+  const IWORKTableNameMapPtr_t names = std::make_shared<IWORKTableNameMap_t>();
+  const librevenge::RVNGPropertyList props;
+  IWORKOutputElements slides[3];
+  const char *const tableNames[] = { "Table 1", "Table 1", "Table 2" };
+  const char *const globalIds[] = { "first", "second", "third" };
+  for (int slide = 2; slide >= 0; --slide)
+  {
+    IWORKTable table(names, m_formatNameMap, m_langManager);
+    table.setNameOnWrite(tableNames[slide], string(globalIds[slide]));
+    table.setSize(1, 1);
+    table.draw(props, slides[slide], true);
+  }
+  CPPUNIT_ASSERT(names->empty());
+
+  // the slides are written in their order
+  for (const auto &slide : slides)
+    slide.write(nullptr);
+  CPPUNIT_ASSERT(sequentialNames == *names);
+
+  // writing again does not rename the tables
+  slides[0].write(nullptr);
+  CPPUNIT_ASSERT(sequentialNames == *names);
+}
+
+void IWORKTableTest::testForwardReference()
+{
+  // the slides are written as soon as they are parsed, before the
+  // table the formula on the first slide refers to is named
+  const IWORKTableNameMapPtr_t streamedNames = std::make_shared<IWORKTableNameMap_t>();
+  TableDocument streamed;
+  for (unsigned slide = 0; slide != 2; ++slide)
+  {
+    IWORKOutputElements elements;
+    drawSlide(slide, streamedNames, true, elements);
+    elements.write(&streamed);
+  }
+
+  // all the tables are named before any slide is written
+  const IWORKTableNameMapPtr_t bufferedNames = std::make_shared<IWORKTableNameMap_t>();
+  TableDocument buffered;
+  IWORKOutputElements slides[2];
+  for (unsigned slide = 0; slide != 2; ++slide)
+    drawSlide(slide, bufferedNames, false, slides[slide]);
+  for (const auto &slide : slides)
+    slide.write(&buffered);
+
+  CPPUNIT_ASSERT(buffered.m_calls == streamed.m_calls);
+  // Keynote tables are simple tables, which keep the computed value
+  // of a formula instead of the reference
+  vector<string> calls;
+  calls.push_back("table Table 1");
+  calls.push_back("cell 0");
+  calls.push_back("/table");
+  calls.push_back("table Table 2");
+  calls.push_back("cell 0");
+  calls.push_back("/table");
+  CPPUNIT_ASSERT(calls == streamed.m_calls);
+}
+
+/// Draw the table of a slide like Keynote does. The table on the first slide refers to the one on the second.
+void IWORKTableTest::drawSlide(const unsigned slide, const IWORKTableNameMapPtr_t &names, const bool nameOnWrite, IWORKOutputElements &elements)
+{
+  const char *const tableNames[] = { "Table 1", "Table 2" };
+  const char *const globalIds[] = { "ABCD", "CDEF" };
+
+  IWORKTable table(names, m_formatNameMap, m_langManager);
+  if (nameOnWrite)
+    table.setNameOnWrite(tableNames[slide], string(globalIds[slide]));
+  else
+    table.setName(IWORKTable::registerName(*names, tableNames[slide], string(globalIds[slide])));
+  table.setSize(1, 1);
+  table.setSizes(IWORKColumnSizes_t(1), IWORKRowSizes_t(1));
+  IWORKFormulaPtr_t formula;
+  if (slide == 0)
+  {
+    formula = std::make_shared<IWORKFormula>(boost::none);
+    CPPUNIT_ASSERT(formula->parse("=SFTGlobalID_CDEF::A1"));
+  }
+  table.insertCell(0, 0, string("7"), std::shared_ptr<IWORKText>(), boost::none, 1, 1, formula);
+  table.draw(librevenge::RVNGPropertyList(), elements, true);
+}
+
+void IWORKTableTest::testReinsertCell()
+{
+  IWORKTable table(std::make_shared<IWORKTableNameMap_t>(), m_formatNameMap, m_langManager);
+  table.setSizes(IWORKColumnSizes_t(2), IWORKRowSizes_t(1));
+
+  IWORKFormulaPtr_t formula = std::make_shared<IWORKFormula>(boost::none);
+  const std::weak_ptr<IWORKFormula> weakFormula(formula);
+  table.insertCell(0, 0, string("1"), std::shared_ptr<IWORKText>(), boost::none, 1, 1, formula);
+  table.insertCell(1, 0, string("2"), std::shared_ptr<IWORKText>(), boost::none, 2, 1);
+  formula.reset();
+  CPPUNIT_ASSERT(!weakFormula.expired());
+
+  // the extra data of a cell go with the cell's formula
+  table.insertCell(0, 0, string("1"));
+  CPPUNIT_ASSERT(weakFormula.expired());
+
+  formula = std::make_shared<IWORKFormula>(boost::none);
+  const std::weak_ptr<IWORKFormula> weakFormula2(formula);
+  table.insertCell(1, 0, string("2"), std::shared_ptr<IWORKText>(), boost::none, 1, 1, formula);
+  formula.reset();
+  CPPUNIT_ASSERT(!weakFormula2.expired());
+  table.insertCoveredCell(1, 0);
+  CPPUNIT_ASSERT(weakFormula2.expired());
+}
+
+void IWORKTableTest::testStreamedValues()
+{
+  IWORKTable table(std::make_shared<IWORKTableNameMap_t>(), m_formatNameMap, m_langManager);
+  table.setSizes(IWORKColumnSizes_t(1), IWORKRowSizes_t(4));
+
+  unsigned blocks = 0;
+  table.startStreaming(librevenge::RVNGPropertyList(), false, [&blocks](const IWORKOutputElements &)
+  {
+    ++blocks;
+  });
+  table.insertCell(0, 0, string("1"));
+  table.insertCell(0, 1, string("2"));
+  table.insertCell(0, 3, string("1"));
+  CPPUNIT_ASSERT_EQUAL(std::size_t(2), table.getValueCount());
+
+  // only the values of the rows which are not drawn yet are kept
+  table.flushRows(2);
+  CPPUNIT_ASSERT_EQUAL(std::size_t(1), table.getValueCount());
+
+  table.insertCell(0, 2, string("3"));
+  CPPUNIT_ASSERT_EQUAL(std::size_t(2), table.getValueCount());
+  table.endStreaming();
+  CPPUNIT_ASSERT_EQUAL(std::size_t(0), table.getValueCount());
+  CPPUNIT_ASSERT_EQUAL(4u, blocks);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWORKTableTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,125 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <atomic>
+#include <stdexcept>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWORKThreadPool.h"
+
+using libetonyek::IWORKThreadPool;
+
+namespace test
+{
+
+class IWORKThreadPoolTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWORKThreadPoolTest);
+  CPPUNIT_TEST(testRun);
+  CPPUNIT_TEST(testOrder);
+  CPPUNIT_TEST(testException);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testRun();
+  void testOrder();
+  void testException();
+};
+
+void IWORKThreadPoolTest::setUp()
+{
+}
+
+void IWORKThreadPoolTest::tearDown()
+{
+}
+
+void IWORKThreadPoolTest::testRun()
+{
+  std::atomic<unsigned> done(0);
+  {
+    IWORKThreadPool pool(4);
+#ifdef WITH_THREADS
+    CPPUNIT_ASSERT_EQUAL(4u, pool.size());
+#else
+    // the tasks are run by post()
+    CPPUNIT_ASSERT_EQUAL(1u, pool.size());
+#endif
+    for (unsigned i = 0; i != 100; ++i)
+    {
+      pool.post([&done]()
+      {
+        ++done;
+      });
+    }
+    pool.wait();
+    CPPUNIT_ASSERT_EQUAL(100u, unsigned(done));
+
+    // the pool can be used again
+    pool.post([&done]()
+    {
+      ++done;
+    });
+  }
+  // and it finishes its tasks when it is destroyed
+  CPPUNIT_ASSERT_EQUAL(101u, unsigned(done));
+
+  IWORKThreadPool defaultPool;
+  CPPUNIT_ASSERT(defaultPool.size() > 0);
+}
+
+void IWORKThreadPoolTest::testOrder()
+{
+  std::vector<unsigned> order;
+  IWORKThreadPool pool(1);
+  for (unsigned i = 0; i != 10; ++i)
+  {
+    pool.post([&order, i]()
+    {
+      order.push_back(i);
+    });
+  }
+  pool.wait();
+
+  CPPUNIT_ASSERT_EQUAL(std::size_t(10), order.size());
+  for (unsigned i = 0; i != 10; ++i)
+    CPPUNIT_ASSERT_EQUAL(i, order[i]);
+}
+
+void IWORKThreadPoolTest::testException()
+{
+  std::atomic<unsigned> done(0);
+  IWORKThreadPool pool(2);
+  for (unsigned i = 0; i != 10; ++i)
+  {
+    pool.post([&done, i]()
+    {
+      if (i % 2)
+        throw std::runtime_error("failed");
+      ++done;
+    });
+  }
+  // a failed task neither stops the others nor the waiting
+  pool.wait();
+  CPPUNIT_ASSERT_EQUAL(5u, unsigned(done));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWORKThreadPoolTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,143 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <cassert>
+#include <string>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWORKTokenCache.h"
+#include "IWORKTokenizerBase.h"
+
+using namespace libetonyek;
+
+namespace test
+{
+
+namespace
+{
+
+const int TOKEN_A = 1;
+const int TOKEN_B = 2;
+const int TOKEN_NS = 1 << 8;
+
+class Tokenizer : public IWORKTokenizerBase
+{
+public:
+  Tokenizer();
+
+  mutable unsigned m_queries;
+
+private:
+  virtual int queryId(const char *name) const;
+};
+
+Tokenizer::Tokenizer()
+  : m_queries(0)
+{
+}
+
+int Tokenizer::queryId(const char *const name) const
+{
+  assert(name);
+
+  ++m_queries;
+
+  const std::string nameStr(name);
+
+  assert(!nameStr.empty());
+
+  if ("a" == nameStr)
+    return TOKEN_A;
+  else if ("b" == nameStr)
+    return TOKEN_B;
+  else if ("ns" == nameStr)
+    return TOKEN_NS;
+
+  return 0;
+}
+
+}
+
+class IWORKTokenCacheTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWORKTokenCacheTest);
+  CPPUNIT_TEST(testLookup);
+  CPPUNIT_TEST(testCaching);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testLookup();
+  void testCaching();
+};
+
+void IWORKTokenCacheTest::setUp()
+{
+}
+
+void IWORKTokenCacheTest::tearDown()
+{
+}
+
+void IWORKTokenCacheTest::testLookup()
+{
+  const Tokenizer tokenizer;
+  IWORKTokenCache tokens(tokenizer);
+
+  CPPUNIT_ASSERT_EQUAL(TOKEN_A | TOKEN_NS, tokens.getQualifiedId("a", "ns"));
+  CPPUNIT_ASSERT_EQUAL(TOKEN_B | TOKEN_NS, tokens.getQualifiedId("b", "ns"));
+  CPPUNIT_ASSERT_EQUAL(TOKEN_A, tokens.getQualifiedId("a", 0));
+  CPPUNIT_ASSERT_EQUAL(0, tokens.getQualifiedId("a", "foo"));
+  CPPUNIT_ASSERT_EQUAL(0, tokens.getQualifiedId("foo", "ns"));
+  CPPUNIT_ASSERT_EQUAL(0, tokens.getQualifiedId(0, "ns"));
+  CPPUNIT_ASSERT_EQUAL(0, tokens.getQualifiedId(0, 0));
+}
+
+void IWORKTokenCacheTest::testCaching()
+{
+  const Tokenizer tokenizer;
+  IWORKTokenCache tokens(tokenizer);
+
+  const char a[] = "a";
+  const char b[] = "b";
+  const char ns[] = "ns";
+
+  CPPUNIT_ASSERT_EQUAL(TOKEN_A | TOKEN_NS, tokens.getQualifiedId(a, ns));
+  const unsigned queries = tokenizer.m_queries;
+  CPPUNIT_ASSERT(queries > 0);
+
+  // the same strings are only looked up in the cache
+  CPPUNIT_ASSERT_EQUAL(TOKEN_A | TOKEN_NS, tokens.getQualifiedId(a, ns));
+  CPPUNIT_ASSERT_EQUAL(queries, tokenizer.m_queries);
+
+  // a different pair is not found in the cache
+  CPPUNIT_ASSERT_EQUAL(TOKEN_B | TOKEN_NS, tokens.getQualifiedId(b, ns));
+  CPPUNIT_ASSERT(tokenizer.m_queries > queries);
+  CPPUNIT_ASSERT_EQUAL(TOKEN_A, tokens.getQualifiedId(a, 0));
+
+  // unknown names are cached too
+  const char foo[] = "foo";
+  CPPUNIT_ASSERT_EQUAL(0, tokens.getQualifiedId(foo, ns));
+  const unsigned allQueries = tokenizer.m_queries;
+  CPPUNIT_ASSERT_EQUAL(0, tokens.getQualifiedId(foo, ns));
+  CPPUNIT_ASSERT_EQUAL(TOKEN_B | TOKEN_NS, tokens.getQualifiedId(b, ns));
+  CPPUNIT_ASSERT_EQUAL(allQueries, tokenizer.m_queries);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWORKTokenCacheTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,171 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include <librevenge-stream/librevenge-stream.h>
+
+#include "IWORKMemoryStream.h"
+#include "IWORKZlibStream.h"
+#include "libetonyek_utils.h"
+
+#if !defined ETONYEK_STREAMS_TEST_DIR
+#error ETONYEK_STREAMS_TEST_DIR not defined, cannot test
+#endif
+
+namespace test
+{
+
+using libetonyek::IWORKMemoryStream;
+using libetonyek::IWORKZlibStream;
+using libetonyek::RVNGInputStreamPtr_t;
+
+using std::string;
+using std::vector;
+
+namespace
+{
+
+RVNGInputStreamPtr_t openFile(const string &name)
+{
+  return RVNGInputStreamPtr_t(new librevenge::RVNGFileStream((string(ETONYEK_STREAMS_TEST_DIR) + "/" + name).c_str()));
+}
+
+vector<unsigned char> readAll(librevenge::RVNGInputStream &stream, const unsigned long blockSize)
+{
+  vector<unsigned char> data;
+  while (!stream.isEnd())
+  {
+    unsigned long numBytesRead = 0;
+    const unsigned char *const bytes = stream.read(blockSize, numBytesRead);
+    if (numBytesRead == 0)
+      break;
+    data.insert(data.end(), bytes, bytes + numBytesRead);
+  }
+  return data;
+}
+
+void assertSame(const string &name)
+{
+  IWORKZlibStream whole(openFile(name), IWORKZlibStream::MODE_WHOLE);
+  const vector<unsigned char> expected(readAll(whole, 1 << 20));
+  CPPUNIT_ASSERT_MESSAGE(name + ": not empty", !expected.empty());
+
+  IWORKZlibStream streaming(openFile(name), IWORKZlibStream::MODE_STREAMING);
+
+  // small reads, like the XML parser does
+  CPPUNIT_ASSERT_MESSAGE(name + ": streaming content", expected == readAll(streaming, 4000));
+  CPPUNIT_ASSERT_EQUAL_MESSAGE(name + ": streaming length", long(expected.size()), streaming.tell());
+
+  // a read longer than the window
+  CPPUNIT_ASSERT_EQUAL(0, streaming.seek(0, librevenge::RVNG_SEEK_SET));
+  CPPUNIT_ASSERT_MESSAGE(name + ": big reads", expected == readAll(streaming, 200000));
+
+  // jump around
+  const long middle = long(expected.size() / 2);
+  CPPUNIT_ASSERT_EQUAL(0, streaming.seek(middle, librevenge::RVNG_SEEK_SET));
+  unsigned long numBytesRead = 0;
+  const unsigned char *bytes = streaming.read(10, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(10ul, numBytesRead);
+  CPPUNIT_ASSERT_MESSAGE(name + ": middle", std::equal(bytes, bytes + 10, expected.begin() + middle));
+
+  CPPUNIT_ASSERT_EQUAL(0, streaming.seek(-20, librevenge::RVNG_SEEK_CUR));
+  bytes = streaming.read(1, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(1ul, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(expected[std::size_t(middle - 10)], *bytes);
+
+  CPPUNIT_ASSERT_EQUAL(0, streaming.seek(-1, librevenge::RVNG_SEEK_END));
+  CPPUNIT_ASSERT_EQUAL(long(expected.size()) - 1, streaming.tell());
+  bytes = streaming.read(10, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(1ul, numBytesRead);
+  CPPUNIT_ASSERT_EQUAL(expected.back(), *bytes);
+  CPPUNIT_ASSERT(streaming.isEnd());
+
+  // positions past the end are refused
+  CPPUNIT_ASSERT(0 != streaming.seek(long(expected.size()) + 1, librevenge::RVNG_SEEK_SET));
+  CPPUNIT_ASSERT_EQUAL(long(expected.size()), streaming.tell());
+  CPPUNIT_ASSERT_EQUAL(0, streaming.seek(1, librevenge::RVNG_SEEK_SET));
+  CPPUNIT_ASSERT(0 != streaming.seek(long(expected.size()) + 1, librevenge::RVNG_SEEK_SET));
+  CPPUNIT_ASSERT_EQUAL(1l, streaming.tell());
+}
+
+}
+
+class IWORKZlibStreamTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(IWORKZlibStreamTest);
+  CPPUNIT_TEST(testStreaming);
+  CPPUNIT_TEST(testStored);
+  CPPUNIT_TEST(testInvalid);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testStreaming();
+  void testStored();
+  void testInvalid();
+};
+
+void IWORKZlibStreamTest::setUp()
+{
+}
+
+void IWORKZlibStreamTest::tearDown()
+{
+}
+
+void IWORKZlibStreamTest::testStreaming()
+{
+  assertSame("keynote4.apxl.gz");
+  assertSame("numbers2.xml.gz");
+  assertSame("pages4.xml.gz");
+}
+
+void IWORKZlibStreamTest::testStored()
+{
+  const unsigned char data[] = "\x1f\x8b\x00helloworld";
+  const string expected("helloworld");
+
+  IWORKZlibStream whole(RVNGInputStreamPtr_t(new IWORKMemoryStream(data, 13)), IWORKZlibStream::MODE_WHOLE);
+  const vector<unsigned char> wholeData(readAll(whole, 1 << 20));
+  CPPUNIT_ASSERT(expected == string(wholeData.begin(), wholeData.end()));
+
+  IWORKZlibStream streaming(RVNGInputStreamPtr_t(new IWORKMemoryStream(data, 13)), IWORKZlibStream::MODE_STREAMING);
+  const vector<unsigned char> streamingData(readAll(streaming, 4));
+  CPPUNIT_ASSERT(expected == string(streamingData.begin(), streamingData.end()));
+}
+
+void IWORKZlibStreamTest::testInvalid()
+{
+  bool exception = false;
+  try
+  {
+    IWORKZlibStream stream(openFile("pages4.xml"), IWORKZlibStream::MODE_STREAMING);
+  }
+  catch (...)
+  {
+    exception = true;
+  }
+  CPPUNIT_ASSERT_MESSAGE("not compressed", exception);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(IWORKZlibStreamTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
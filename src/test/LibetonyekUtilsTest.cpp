@@ -10,6 +10,7 @@
 #include <limits>
 #include <memory>
 #include <stdexcept>
+#include <string>
 
 #include <cppunit/TestFixture.h>
 #include <cppunit/extensions/HelperMacros.h>
@@ -18,6 +19,7 @@
 #include "libetonyek_utils.h"
 
 using libetonyek::EndOfStreamException;
+using libetonyek::detectMimetypeFromName;
 using libetonyek::IWORKMemoryStream;
 using libetonyek::RVNGInputStreamPtr_t;
 using libetonyek::readSVar;
@@ -55,11 +57,13 @@ private:
   CPPUNIT_TEST_SUITE(LibetonyekUtilsTest);
   CPPUNIT_TEST(testReadSVar);
   CPPUNIT_TEST(testReadUVar);
+  CPPUNIT_TEST(testDetectMimetypeFromName);
   CPPUNIT_TEST_SUITE_END();
 
 private:
   void testReadSVar();
   void testReadUVar();
+  void testDetectMimetypeFromName();
 };
 
 void LibetonyekUtilsTest::setUp()
@@ -102,6 +106,16 @@ void LibetonyekUtilsTest::testReadUVar()
   CPPUNIT_ASSERT_THROW(readUVar(makeStream("\xff\xff", 2)), EndOfStreamException);
 }
 
+void LibetonyekUtilsTest::testDetectMimetypeFromName()
+{
+  CPPUNIT_ASSERT_EQUAL(std::string("image/jpeg"), detectMimetypeFromName("Data/image.jpg"));
+  CPPUNIT_ASSERT_EQUAL(std::string("image/png"), detectMimetypeFromName("theme-files/Image.PNG"));
+  CPPUNIT_ASSERT_EQUAL(std::string("video/quicktime"), detectMimetypeFromName("Data/movie-1.mov"));
+  CPPUNIT_ASSERT_EQUAL(std::string(), detectMimetypeFromName("Data/image"));
+  CPPUNIT_ASSERT_EQUAL(std::string(), detectMimetypeFromName("Data.jpg/image"));
+  CPPUNIT_ASSERT_EQUAL(std::string(), detectMimetypeFromName("Data/image.xyz"));
+}
+
 CPPUNIT_TEST_SUITE_REGISTRATION(LibetonyekUtilsTest);
 
 }
@@ -0,0 +1,202 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+
+#include "IWORKLanguageManager.h"
+#include "IWORKRecorder.h"
+#include "IWORKTable.h"
+#include "NUMCollector.h"
+#include "TestDocument.h"
+
+using namespace libetonyek;
+
+using std::string;
+using std::vector;
+
+namespace test
+{
+
+namespace
+{
+
+/// Make a table with one column and the given number of rows.
+std::shared_ptr<IWORKTable> makeTable(NUMCollector &collector, const unsigned rows, IWORKFormatNameMap &formatNameMap, const IWORKLanguageManager &langManager)
+{
+  const std::shared_ptr<IWORKTable> table = collector.createTable(std::make_shared<IWORKTableNameMap_t>(), formatNameMap, langManager);
+  table->setSize(1, rows);
+  table->setSizes(IWORKColumnSizes_t(1), IWORKRowSizes_t(rows));
+  return table;
+}
+
+/// Insert the cells of rows [begin, end), like a tile of a Numbers 3 table.
+void insertTile(IWORKTable &table, const unsigned begin, const unsigned end)
+{
+  for (unsigned row = begin; row != end; ++row)
+    table.insertCell(0, row, std::to_string(row));
+}
+
+vector<string> makeCalls(const unsigned begin, const unsigned end)
+{
+  vector<string> calls;
+  calls.push_back("table");
+  for (unsigned row = begin; row != end; ++row)
+    calls.push_back("cell " + std::to_string(row));
+  calls.push_back("/table");
+  return calls;
+}
+
+}
+
+class NUMCollectorTest : public CPPUNIT_NS::TestFixture
+{
+public:
+  NUMCollectorTest();
+
+  virtual void setUp();
+  virtual void tearDown();
+
+private:
+  CPPUNIT_TEST_SUITE(NUMCollectorTest);
+  CPPUNIT_TEST(testStreamTable);
+  CPPUNIT_TEST(testStreamSecondTable);
+  CPPUNIT_TEST(testStreamWithRecorder);
+  CPPUNIT_TEST_SUITE_END();
+
+private:
+  void testStreamTable();
+  void testStreamSecondTable();
+  void testStreamWithRecorder();
+
+private:
+  IWORKFormatNameMap m_formatNameMap;
+  IWORKLanguageManager m_langManager;
+};
+
+NUMCollectorTest::NUMCollectorTest()
+  : m_formatNameMap()
+  , m_langManager()
+{
+}
+
+void NUMCollectorTest::setUp()
+{
+  m_formatNameMap.clear();
+}
+
+void NUMCollectorTest::tearDown()
+{
+}
+
+void NUMCollectorTest::testStreamTable()
+{
+  TableDocument document;
+  NUMCollector collector(&document);
+  collector.setStreamTables(true);
+  collector.startDocument();
+  collector.startWorkSpace(string("Sheet 1"));
+  collector.startLevel();
+
+  const std::shared_ptr<IWORKTable> table = makeTable(collector, 6, m_formatNameMap, m_langManager);
+  CPPUNIT_ASSERT(collector.streamTable(table));
+  CPPUNIT_ASSERT(table->isStreaming());
+
+  // the rows of each tile are sent as soon as the tile is done
+  insertTile(*table, 0, 2);
+  table->flushRows(2);
+  vector<string> expected = makeCalls(0, 2);
+  expected.pop_back();
+  CPPUNIT_ASSERT(expected == document.m_calls);
+
+  insertTile(*table, 2, 4);
+  table->flushRows(4);
+  insertTile(*table, 4, 6);
+  table->flushRows(6);
+  collector.collectTable(table);
+  CPPUNIT_ASSERT(!table->isStreaming());
+  CPPUNIT_ASSERT(makeCalls(0, 6) == document.m_calls);
+
+  collector.endLevel();
+  collector.endWorkSpace(std::make_shared<IWORKTableNameMap_t>());
+  collector.endDocument();
+  CPPUNIT_ASSERT(makeCalls(0, 6) == document.m_calls);
+}
+
+void NUMCollectorTest::testStreamSecondTable()
+{
+  TableDocument document;
+  NUMCollector collector(&document);
+  collector.setStreamTables(true);
+  collector.startDocument();
+  collector.startWorkSpace(string("Sheet 1"));
+  collector.startLevel();
+
+  const std::shared_ptr<IWORKTable> first = makeTable(collector, 4, m_formatNameMap, m_langManager);
+  CPPUNIT_ASSERT(collector.streamTable(first));
+  insertTile(*first, 0, 2);
+  first->flushRows(2);
+  insertTile(*first, 2, 4);
+  first->flushRows(4);
+  collector.collectTable(first);
+
+  // the second table of the sheet is drawn as usual, after the first
+  const std::shared_ptr<IWORKTable> second = makeTable(collector, 3, m_formatNameMap, m_langManager);
+  CPPUNIT_ASSERT(!collector.streamTable(second));
+  CPPUNIT_ASSERT(!second->isStreaming());
+  insertTile(*second, 0, 3);
+  collector.collectTable(second);
+  CPPUNIT_ASSERT(makeCalls(0, 4) == document.m_calls);
+
+  collector.endLevel();
+  collector.endWorkSpace(std::make_shared<IWORKTableNameMap_t>());
+  collector.endDocument();
+  vector<string> expected = makeCalls(0, 4);
+  const vector<string> secondCalls = makeCalls(0, 3);
+  expected.insert(expected.end(), secondCalls.begin(), secondCalls.end());
+  CPPUNIT_ASSERT(expected == document.m_calls);
+}
+
+void NUMCollectorTest::testStreamWithRecorder()
+{
+  TableDocument document;
+  NUMCollector collector(&document);
+  collector.setStreamTables(true);
+  collector.startDocument();
+  collector.startWorkSpace(string("Sheet 1"));
+
+  // a recorded table is drawn when it is replayed, so it can not be streamed
+  const std::shared_ptr<IWORKRecorder> recorder = std::make_shared<IWORKRecorder>();
+  collector.setRecorder(recorder);
+  collector.startLevel();
+  const std::shared_ptr<IWORKTable> table = makeTable(collector, 2, m_formatNameMap, m_langManager);
+  CPPUNIT_ASSERT(!collector.streamTable(table));
+  CPPUNIT_ASSERT(!table->isStreaming());
+  insertTile(*table, 0, 2);
+  collector.collectTable(table);
+  collector.endLevel();
+  collector.setRecorder(std::shared_ptr<IWORKRecorder>());
+
+  recorder->replay(collector);
+  CPPUNIT_ASSERT(document.m_calls.empty());
+
+  collector.endWorkSpace(std::make_shared<IWORKTableNameMap_t>());
+  collector.endDocument();
+  CPPUNIT_ASSERT(makeCalls(0, 2) == document.m_calls);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(NUMCollectorTest);
+
+}
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -0,0 +1,342 @@
+/* -*- Mode: C++; tab-width: 2; indent-tabs-mode: nil; c-basic-offset: 2 -*- */
+/*
+ * This file is part of the libetonyek project.
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef TESTDOCUMENT_H_INCLUDED
+#define TESTDOCUMENT_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+#include "IWORKDocumentInterface.h"
+
+namespace test
+{
+
+using libetonyek::IWORKDocumentInterface;
+
+/** A document that only records the tables and their cells.
+  *
+  * A table is recorded with its name, if it has one, a cell with its
+  * row and the sheets its formula refers to, if it has one.
+  */
+class TableDocument : public IWORKDocumentInterface
+{
+public:
+  TableDocument()
+    : m_calls()
+  {
+  }
+
+  std::vector<std::string> m_calls;
+
+  void setDocumentMetaData(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void startDocument(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void endDocument() override
+  {
+  }
+  void definePageStyle(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void defineEmbeddedFont(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openPageSpan(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closePageSpan() override
+  {
+  }
+  void startSlide(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void endSlide() override
+  {
+  }
+  void startMasterSlide(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void endMasterSlide() override
+  {
+  }
+  void setStyle(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void startLayer(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void endLayer() override
+  {
+  }
+  void openHeader(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeHeader() override
+  {
+  }
+  void openFooter(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeFooter() override
+  {
+  }
+  void defineParagraphStyle(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openParagraph(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeParagraph() override
+  {
+  }
+  void defineCharacterStyle(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openSpan(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeSpan() override
+  {
+  }
+  void openLink(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeLink() override
+  {
+  }
+  void defineSectionStyle(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openSection(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeSection() override
+  {
+  }
+  void insertTab() override
+  {
+  }
+  void insertSpace() override
+  {
+  }
+  void insertText(const librevenge::RVNGString &) override
+  {
+  }
+  void insertLineBreak() override
+  {
+  }
+  void insertField(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openOrderedListLevel(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openUnorderedListLevel(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeOrderedListLevel() override
+  {
+  }
+  void closeUnorderedListLevel() override
+  {
+  }
+  void openListElement(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeListElement() override
+  {
+  }
+  void openFootnote(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeFootnote() override
+  {
+  }
+  void openEndnote(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeEndnote() override
+  {
+  }
+  void openComment(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeComment() override
+  {
+  }
+  void openTextBox(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeTextBox() override
+  {
+  }
+  void defineSheetNumberingStyle(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openTable(const librevenge::RVNGPropertyList &propList) override
+  {
+    std::string call("table");
+    if (propList["librevenge:sheet-name"])
+      call += std::string(" ") + propList["librevenge:sheet-name"]->getStr().cstr();
+    m_calls.push_back(call);
+  }
+  void openTableRow(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeTableRow() override
+  {
+  }
+  void openTableCell(const librevenge::RVNGPropertyList &propList) override
+  {
+    std::string call("cell " + std::to_string(propList["librevenge:row"]->getInt()));
+    if (const librevenge::RVNGPropertyListVector *const formula = propList.child("librevenge:formula"))
+    {
+      call += " =";
+      for (unsigned long i = 0; i != formula->count(); ++i)
+      {
+        if ((*formula)[i]["librevenge:sheet-name"])
+          call += std::string(" ") + (*formula)[i]["librevenge:sheet-name"]->getStr().cstr();
+      }
+    }
+    m_calls.push_back(call);
+  }
+  void closeTableCell() override
+  {
+  }
+  void insertCoveredTableCell(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeTable() override
+  {
+    m_calls.push_back("/table");
+  }
+  void openFrame(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeFrame() override
+  {
+  }
+  void insertBinaryObject(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void insertEquation(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openGroup(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeGroup() override
+  {
+  }
+  void defineGraphicStyle(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void drawRectangle(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void drawEllipse(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void drawPolygon(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void drawPolyline(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void drawPath(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void drawGraphicObject(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void drawConnector(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void startTextObject(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void endTextObject() override
+  {
+  }
+  void startNotes(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void endNotes() override
+  {
+  }
+  void defineChartStyle(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openChart(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeChart() override
+  {
+  }
+  void openChartTextObject(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeChartTextObject() override
+  {
+  }
+  void openChartPlotArea(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeChartPlotArea() override
+  {
+  }
+  void insertChartAxis(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void openChartSeries(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeChartSeries() override
+  {
+  }
+  void openAnimationSequence(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeAnimationSequence() override
+  {
+  }
+  void openAnimationGroup(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeAnimationGroup() override
+  {
+  }
+  void openAnimationIteration(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void closeAnimationIteration() override
+  {
+  }
+  void insertMotionAnimation(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void insertColorAnimation(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void insertAnimation(const librevenge::RVNGPropertyList &) override
+  {
+  }
+  void insertEffect(const librevenge::RVNGPropertyList &) override
+  {
+  }
+};
+
+}
+
+#endif // TESTDOCUMENT_H_INCLUDED
+
+/* vim:set shiftwidth=2 softtabstop=2 expandtab: */
@@ -24,16 +24,18 @@ template<>
 struct IWORKPropertyInfo<property::Answer>
 {
   typedef int ValueType;
-  static const IWORKPropertyID_t id;
+  static const IWORKPropertyID_t id = IWORK_PROPERTY_COUNT;
 };
 
 template<>
 struct IWORKPropertyInfo<property::Antwort>
 {
   typedef int ValueType;
-  static const IWORKPropertyID_t id;
+  static const IWORKPropertyID_t id = IWORK_PROPERTY_COUNT + 1;
 };
 
+static_assert(IWORK_PROPERTY_COUNT + 2 <= IWORK_PROPERTY_MAX, "no free IDs for test properties");
+
 }
 
 /* vim:set shiftwidth=2 softtabstop=2 expandtab: */